@@ -75,6 +75,8 @@ FFTReal::~FFTReal (void)
 /*      Description: Compute the FFT of the array.                          */
 /*      Input parameters:                                                   */
 /*        - x: pointer on the source array (time).                          */
+/*        - work: scratch array of length(x) values, or 0 to use our own.   */
+/*          (RTcmix modification)                                           */
 /*      Output parameters:                                                  */
 /*        - f: pointer on the destination array (frequencies).              */
 /*             f [0...length(x)/2] = real values,                           */
@@ -83,8 +85,9 @@ FFTReal::~FFTReal (void)
 /*      Throws: Nothing                                                     */
 /*==========================================================================*/
 
-void	FFTReal::do_fft (flt_t f [], const flt_t x []) const
+void	FFTReal::do_fft (flt_t f [], const flt_t x [], flt_t work []) const
 {
+	flt_t * const	buffer_ptr = (work != 0) ? work : _buffer_ptr;
 
 /*______________________________________________
  *
@@ -99,13 +102,13 @@ void	FFTReal::do_fft (flt_t f [], const flt_t x []) const
 
 		if (_nbr_bits & 1)
 		{
-			df = _buffer_ptr;
+			df = buffer_ptr;
 			sf = f;
 		}
 		else
 		{
 			df = f;
-			sf = _buffer_ptr;
+			sf = buffer_ptr;
 		}
 
 		/* Do the transformation in several pass */
@@ -267,13 +270,16 @@ void	FFTReal::do_fft (flt_t f [], const flt_t x []) const
 /*             f [0...length(x)/2] = real values,                           */
 /*             f [length(x)/2+1...length(x)] = imaginary values of          */
 /*               coefficents 1...length(x)-1.                               */
+/*        - work: scratch array of length(x) values, or 0 to use our own.   */
+/*          (RTcmix modification)                                           */
 /*      Output parameters:                                                  */
 /*        - x: pointer on the destination array (time).                     */
 /*      Throws: Nothing                                                     */
 /*==========================================================================*/
 
-void	FFTReal::do_ifft (const flt_t f [], flt_t x []) const
+void	FFTReal::do_ifft (const flt_t f [], flt_t x [], flt_t work []) const
 {
+	flt_t * const	buffer_ptr = (work != 0) ? work : _buffer_ptr;
 
 /*______________________________________________
  *
@@ -289,13 +295,13 @@ void	FFTReal::do_ifft (const flt_t f [], flt_t x []) const
 
 		if (_nbr_bits & 1)
 		{
-			df = _buffer_ptr;
+			df = buffer_ptr;
 			df_temp = x;
 		}
 		else
 		{
 			df = x;
-			df_temp = _buffer_ptr;
+			df_temp = buffer_ptr;
 		}
 
 		/* Do the transformation in several pass */
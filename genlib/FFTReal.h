@@ -42,8 +42,11 @@ public:
 
 	explicit			FFTReal (const long length);
 						~FFTReal ();
-	void				do_fft (flt_t f [], const flt_t x []) const;
-	void				do_ifft (const flt_t f [], flt_t x []) const;
+	/* RTcmix modification:  optional <work> array of <length> values to use
+		as scratch instead of the object's own, so that one FFTReal (and its
+		look-up tables) can be shared by several threads. */
+	void				do_fft (flt_t f [], const flt_t x [], flt_t work [] = 0) const;
+	void				do_ifft (const flt_t f [], flt_t x [], flt_t work [] = 0) const;
 	void				rescale (flt_t x []) const;
 
 
@@ -0,0 +1,139 @@
+// RTcmix - Copyright (C) 2005  The RTcmix Development Team
+// See ``AUTHORS'' for a list of contributors. See ``LICENSE'' for
+// the license to this software and for a DISCLAIMER OF ALL WARRANTIES.
+
+#include <Oconvolve.h>
+#include <Offt.h>
+#include <string.h>
+
+Oconvolve::Oconvolve(const float *impulse, int impframes, int blocklen)
+	: _blocklen(blocklen), _fftlen(blocklen * 2), _current(0)
+{
+	_partitions = (impframes + blocklen - 1) / blocklen;
+	if (_partitions < 1)
+		_partitions = 1;
+	_fft = new Offt(_fftlen);
+	_fftbuf = _fft->getbuf();
+	_prevIn = new float [_blocklen];
+	const int speclen = _partitions * _blocklen;
+	_impRe = new float [speclen];
+	_impIm = new float [speclen];
+	_fdlRe = new float [speclen];
+	_fdlIm = new float [speclen];
+	_accRe = new float [_blocklen];
+	_accIm = new float [_blocklen];
+
+	// Offt::r2c scales by 1 / fftlen, and c2r doesn't undo that.  Scaling the
+	// impulse spectra by fftlen here makes process() an exact convolution.
+	const float scale = float(_fftlen);
+	for (int p = 0; p < _partitions; p++) {
+		const int start = p * _blocklen;
+		const int len = (impframes - start < _blocklen) ? impframes - start : _blocklen;
+		for (int i = 0; i < len; i++)
+			_fftbuf[i] = impulse[start + i] * scale;
+		for (int i = len; i < _fftlen; i++)
+			_fftbuf[i] = 0.0f;
+		_fft->r2c();
+		loadSpectrum(&_impRe[start], &_impIm[start]);
+	}
+	clear();
+}
+
+Oconvolve::~Oconvolve()
+{
+	delete [] _accIm;
+	delete [] _accRe;
+	delete [] _fdlIm;
+	delete [] _fdlRe;
+	delete [] _impIm;
+	delete [] _impRe;
+	delete [] _prevIn;
+	delete _fft;
+}
+
+void Oconvolve::clear()
+{
+	const int speclen = _partitions * _blocklen;
+	memset(_prevIn, 0, sizeof(float) * _blocklen);
+	memset(_fdlRe, 0, sizeof(float) * speclen);
+	memset(_fdlIm, 0, sizeof(float) * speclen);
+	_current = 0;
+}
+
+// acc += x * h for split-form spectra of <len> bins, treating every bin as
+// complex; the caller fixes up bin 0.  <len> is a multiple of 4.  The pointers
+// never overlap, and the 4-bin body lets the compiler use SIMD at -O2.
+
+static void multiplyAccumulate(float * __restrict accRe, float * __restrict accIm,
+	const float * __restrict xr, const float * __restrict xi,
+	const float * __restrict hr, const float * __restrict hi, int len)
+{
+	for (int k = 0; k < len; k += 4) {
+		accRe[k] += (xr[k] * hr[k]) - (xi[k] * hi[k]);
+		accRe[k + 1] += (xr[k + 1] * hr[k + 1]) - (xi[k + 1] * hi[k + 1]);
+		accRe[k + 2] += (xr[k + 2] * hr[k + 2]) - (xi[k + 2] * hi[k + 2]);
+		accRe[k + 3] += (xr[k + 3] * hr[k + 3]) - (xi[k + 3] * hi[k + 3]);
+		accIm[k] += (xr[k] * hi[k]) + (xi[k] * hr[k]);
+		accIm[k + 1] += (xr[k + 1] * hi[k + 1]) + (xi[k + 1] * hr[k + 1]);
+		accIm[k + 2] += (xr[k + 2] * hi[k + 2]) + (xi[k + 2] * hr[k + 2]);
+		accIm[k + 3] += (xr[k + 3] * hi[k + 3]) + (xi[k + 3] * hr[k + 3]);
+	}
+}
+
+// Copy Offt's packed complex format into split form.
+
+void Oconvolve::loadSpectrum(float *re, float *im)
+{
+	re[0] = _fftbuf[0];
+	im[0] = _fftbuf[1];
+	for (int k = 1; k < _blocklen; k++) {
+		re[k] = _fftbuf[k + k];
+		im[k] = _fftbuf[k + k + 1];
+	}
+}
+
+void Oconvolve::process(const float *in, float *out)
+{
+	const int n = _blocklen;
+
+	// Overlap-save:  transform the previous block and this one together.
+	memcpy(_fftbuf, _prevIn, sizeof(float) * n);
+	memcpy(&_fftbuf[n], in, sizeof(float) * n);
+	memcpy(_prevIn, in, sizeof(float) * n);
+	_fft->r2c();
+	loadSpectrum(&_fdlRe[_current * n], &_fdlIm[_current * n]);
+
+	// Sum input spectra against impulse spectra, newest input with the
+	// first partition.  DC and Nyquist are real; do those separately.
+	memset(_accRe, 0, sizeof(float) * n);
+	memset(_accIm, 0, sizeof(float) * n);
+	float *accRe = _accRe;
+	float *accIm = _accIm;
+	int slot = _current;
+	for (int p = 0; p < _partitions; p++) {
+		const float *xr = &_fdlRe[slot * n];
+		const float *xi = &_fdlIm[slot * n];
+		const float *hr = &_impRe[p * n];
+		const float *hi = &_impIm[p * n];
+		const float dc = accRe[0] + (xr[0] * hr[0]);
+		const float nyquist = accIm[0] + (xi[0] * hi[0]);
+		multiplyAccumulate(accRe, accIm, xr, xi, hr, hi, n);
+		accRe[0] = dc;
+		accIm[0] = nyquist;
+		if (--slot < 0)
+			slot = _partitions - 1;
+	}
+	if (++_current == _partitions)
+		_current = 0;
+
+	_fftbuf[0] = accRe[0];
+	_fftbuf[1] = accIm[0];
+	for (int k = 1; k < n; k++) {
+		_fftbuf[k + k] = accRe[k];
+		_fftbuf[k + k + 1] = accIm[k];
+	}
+	_fft->c2r();
+
+	// The second half is the part that circular convolution didn't wrap.
+	memcpy(out, &_fftbuf[n], sizeof(float) * n);
+}
@@ -0,0 +1,41 @@
+// RTcmix - Copyright (C) 2005  The RTcmix Development Team
+// See ``AUTHORS'' for a list of contributors. See ``LICENSE'' for
+// the license to this software and for a DISCLAIMER OF ALL WARRANTIES.
+
+// Oconvolve does uniformly partitioned overlap-save convolution, using Offt.
+// The impulse response is cut into partitions of <blocklen> frames, and the
+// spectrum of each is computed once, by the constructor.  Each call to
+// process() takes one FFT of the last two blocks of input, stores it in a
+// frequency-domain delay line, multiplies every stored input spectrum by the
+// matching partition spectrum, and takes one inverse FFT.  So the cost per
+// block is the same from block to block, and the output for a block is ready
+// as soon as that block of input is -- the latency is <blocklen>, no matter
+// how long the impulse response.
+//
+// <blocklen> must be a power of 2, at least 4.  process() computes the exact (unscaled)
+// convolution of the input with the impulse response.
+
+class Offt;
+
+class Oconvolve {
+public:
+	Oconvolve(const float *impulse, int impframes, int blocklen);
+	~Oconvolve();
+	void process(const float *in, float *out);	// <blocklen> frames of each
+	void clear();
+	int blocklen() const { return _blocklen; }
+	int partitions() const { return _partitions; }
+
+private:
+	void loadSpectrum(float *re, float *im);
+
+	int _blocklen, _fftlen, _partitions, _current;
+	Offt *_fft;
+	float *_fftbuf;
+	float *_prevIn;				// previous block of input
+	// Spectra in split form:  for bins 1 to blocklen-1, re[k] and im[k];
+	// DC is in re[0] and Nyquist (also real) in im[0].
+	float *_impRe, *_impIm;		// <_partitions> impulse response spectra
+	float *_fdlRe, *_fdlIm;		// the last <_partitions> input spectra
+	float *_accRe, *_accIm;
+};
@@ -4,9 +4,64 @@
 */
 
 #include <Offt.h>
+#include <ugens.h>
 #ifndef FFTW
 #include <FFTReal.h>
 #endif
+#include <pthread.h>
+#include <string.h>
+#include <map>
+#include <utility>
+
+// The shared plan cache.  Making a plan (or FFTReal's tables) is slow and not
+// thread-safe, so it's done once per size and direction, under a lock.
+// Running one is thread-safe, as long as each caller brings its own arrays:
+// FFTW's new-array execute functions and FFTReal's <work> argument allow that.
+
+static pthread_mutex_t sPlanLock = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef FFTW
+
+typedef std::map<std::pair<int, unsigned int>, fftwf_plan> PlanMap;
+static PlanMap sPlans;
+
+static fftwf_plan sharedPlan(int len, unsigned int direction)
+{
+	pthread_mutex_lock(&sPlanLock);
+	fftwf_plan &plan = sPlans[std::make_pair(len, direction)];
+	if (plan == NULL) {
+		// FFTW_ESTIMATE doesn't touch these arrays; they only show FFTW the
+		// layout and (fftwf_malloc) alignment that every Offt's arrays share.
+		float *buf = (float *) fftwf_malloc(sizeof(float) * len);
+		fftwf_complex *cbuf = (fftwf_complex *)
+								fftwf_malloc(sizeof(fftwf_complex) * ((len / 2) + 1));
+		if (direction == Offt::kRealToComplex)
+			plan = fftwf_plan_dft_r2c_1d(len, buf, cbuf, FFTW_ESTIMATE);
+		else
+			plan = fftwf_plan_dft_c2r_1d(len, cbuf, buf, FFTW_ESTIMATE);
+		fftwf_free(buf);
+		fftwf_free(cbuf);
+	}
+	pthread_mutex_unlock(&sPlanLock);
+	return plan;
+}
+
+#else // !FFTW
+
+typedef std::map<int, FFTReal *> FFTRealMap;
+static FFTRealMap sFFTReals;
+
+static const FFTReal *sharedFFTReal(int len)
+{
+	pthread_mutex_lock(&sPlanLock);
+	FFTReal *&fftobj = sFFTReals[len];
+	if (fftobj == NULL)
+		fftobj = new FFTReal(len);
+	pthread_mutex_unlock(&sPlanLock);
+	return fftobj;
+}
+
+#endif // !FFTW
 
 
 Offt::Offt(int fftsize, unsigned int flags)
@@ -18,29 +73,26 @@ Offt::Offt(int fftsize, unsigned int flags)
 	int csize = sizeof(fftwf_complex) * ((_len / 2) + 1);
 	_cbuf = (fftwf_complex *) fftwf_malloc(csize);
 	if (flags & kRealToComplex)
-		_plan_r2c = fftwf_plan_dft_r2c_1d(_len, _buf, _cbuf, FFTW_ESTIMATE);
+		_plan_r2c = sharedPlan(_len, kRealToComplex);
 	if (flags & kComplexToReal)
-		_plan_c2r = fftwf_plan_dft_c2r_1d(_len, _cbuf, _buf, FFTW_ESTIMATE);
+		_plan_c2r = sharedPlan(_len, kComplexToReal);
 #else // !FFTW
 	_buf = new float [_len];
 	_tmp = new float [_len];
-	_fftobj = new FFTReal(_len);
+	_work = new float [_len];
+	_fftobj = sharedFFTReal(_len);
 #endif // !FFTW
 }
 
 Offt::~Offt()
 {
 #ifdef FFTW
-	if (_plan_r2c)
-		fftwf_destroy_plan(_plan_r2c);
-	if (_plan_c2r)
-		fftwf_destroy_plan(_plan_c2r);
 	fftwf_free(_buf);
 	fftwf_free(_cbuf);
 #else // !FFTW
 	delete [] _buf;
 	delete [] _tmp;
-	delete _fftobj;
+	delete [] _work;
 #endif // !FFTW
 }
 
@@ -49,7 +101,7 @@ Offt::~Offt()
 
 void Offt::r2c()
 {
-	fftwf_execute(_plan_r2c);
+	fftwf_execute_dft_r2c(_plan_r2c, _buf, _cbuf);
 
 	// _cbuf has complex result in real,imaginary pairs from DC to Nyquist;
 	// copy into _buf while reordering to...
@@ -78,14 +130,14 @@ void Offt::c2r()
 		_cbuf[i][1] = _buf[i + i + 1];
 	}
 
-	fftwf_execute(_plan_c2r);
+	fftwf_execute_dft_c2r(_plan_c2r, _cbuf, _buf);
 }
 
 #else // !FFTW
 
 void Offt::r2c()
 {
-	_fftobj->do_fft(_tmp, _buf);
+	_fftobj->do_fft(_tmp, _buf, _work);
 
 	// _tmp has complex result; copy into _buf while reordering from...
 	//    re(0), re(1), re(2)...re(len/2), im(1), im(2)...im(len/2-1)
@@ -138,7 +190,7 @@ void Offt::c2r()
 	} while (i > 0);
 #endif
 
-	_fftobj->do_ifft(_tmp, _buf);
+	_fftobj->do_ifft(_tmp, _buf, _work);
 
 	// _buf now holds real output
 }
@@ -146,6 +198,24 @@ void Offt::c2r()
 #endif // !FFTW
 
 
+// The cmix rfft() interface, for C code:  <x> holds 2 * <N> real values, or
+// their spectrum in the same packed format Offt uses, and the transform is
+// done in place.  Same scaling as Offt (and the old rfft):  the forward
+// transform scales by 1 / (2 * N).
+
+void offt_rfft(float x[], int N, int forward)
+{
+	Offt fft(N * 2, forward ? Offt::kRealToComplex : Offt::kComplexToReal);
+	float *buf = fft.getbuf();
+	memcpy(buf, x, sizeof(float) * N * 2);
+	if (forward)
+		fft.r2c();
+	else
+		fft.c2r();
+	memcpy(x, buf, sizeof(float) * N * 2);
+}
+
+
 #include <stdio.h>
 
 void Offt::printbuf(float *buf, char *msg)
@@ -17,6 +17,12 @@
 // Muck around with the FFT complex data, then call c2r() to turn it back into
 // real-valued samples.
 //
+// The FFTW plans (or FFTReal lookup tables) depend only on the FFT size and
+// direction, so all Offt objects of a given size share one set, made the first
+// time that size is used and kept until the program exits.  After that,
+// constructing an Offt just allocates its buffers, and any number of Offts
+// can run at once in different threads.
+//
 // Check out Obucket also.  This class makes it fairly easy to decouple the
 // FFT length from your instrument's buffer size and to have a fixed latency,
 // regardless of note start time.  See insts/jg/SPECTACLE2_BASE.cpp for an
@@ -49,10 +55,10 @@ private:
 	float *_buf;
 #ifdef FFTW
 	fftwf_complex *_cbuf;
-	fftwf_plan _plan_r2c, _plan_c2r;
+	fftwf_plan _plan_r2c, _plan_c2r;		// shared; see Offt.cpp
 #else
-	float *_tmp;
-	FFTReal *_fftobj;
+	float *_tmp, *_work;
+	const FFTReal *_fftobj;					// shared; see Offt.cpp
 #endif
 };
 
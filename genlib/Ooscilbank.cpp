@@ -0,0 +1,112 @@
+/* RTcmix - Copyright (C) 2004  The RTcmix Development Team
+   See ``AUTHORS'' for a list of contributors. See ``LICENSE'' for
+   the license to this software and for a DISCLAIMER OF ALL WARRANTIES.
+*/
+#include <Ooscilbank.h>
+#include <math.h>
+#include <string.h>
+//#define NDEBUG
+#include <assert.h>
+
+Ooscilbank::Ooscilbank(float SR, int count, double arr[], int len)
+	: _array(arr), _length(len), _lendivSR((double) len / SR), _count(count)
+{
+	assert(len > 0 && count > 0);
+	_phase = new double [count];
+	_si = new double [count];
+	_left = new float [count];
+	_right = new float [count];
+	for (int i = 0; i < count; i++) {
+		_phase[i] = _si[i] = 0.0;
+		_left[i] = _right[i] = 0.0f;
+	}
+}
+
+Ooscilbank::~Ooscilbank()
+{
+	delete [] _right;
+	delete [] _left;
+	delete [] _si;
+	delete [] _phase;
+}
+
+// Frequencies at or above the sampling rate alias back below it, so that one
+// add or subtract of the length per sample keeps each phase in range.
+
+void Ooscilbank::setfreq(int which, float freq)
+{
+	_si[which] = fmod(freq * _lendivSR, (double) _length);
+}
+
+void Ooscilbank::setphase(int which, double phs)
+{
+	const double dlength = _length;
+	if (phs >= dlength || phs < 0.0) {
+		phs = fmod(phs, dlength);
+		if (phs < 0.0)
+			phs += dlength;
+		if (phs >= dlength)
+			phs = 0.0;
+	}
+	_phase[which] = phs;
+}
+
+void Ooscilbank::setgains(int which, float left, float right)
+{
+	_left[which] = left;
+	_right[which] = right;
+}
+
+void Ooscilbank::process(float *out, int nframes, int chans)
+{
+	assert(chans == 1 || chans == 2);
+	memset(out, 0, nframes * chans * sizeof(float));
+	for (int which = 0; which < _count; which++)
+		processOne(which, out, nframes, chans);
+}
+
+// Adds oscillator <which> into <out>, a chunk of frames at a time:  the
+// table lookups go to a scratch buffer, and the mix from there into <out>
+// is a plain loop that the compiler vectorizes.
+
+void Ooscilbank::processOne(int which, float *out, int nframes, int chans)
+{
+	const int kChunk = 256;
+	float sig[kChunk];
+	const double *tab = _array;
+	const int len = _length;
+	const double dlength = len;
+	const double inc = _si[which];
+	const float gainL = _left[which];
+	const float gainR = _right[which];
+	double phs = _phase[which];
+
+	for (int start = 0; start < nframes; start += kChunk) {
+		const int count = (nframes - start < kChunk) ? nframes - start : kChunk;
+		for (int n = 0; n < count; n++) {
+			const int i = (int) phs;
+			const int k = (i + 1 < len) ? i + 1 : 0;
+			sig[n] = tab[i] + ((tab[k] - tab[i]) * (phs - i));
+			phs += inc;
+			if (phs >= dlength)
+				phs -= dlength;
+			else if (phs < 0.0) {
+				phs += dlength;
+				if (phs >= dlength)
+					phs = 0.0;
+			}
+		}
+		float *frame = &out[start * chans];
+		if (chans == 1) {
+			for (int n = 0; n < count; n++)
+				frame[n] += sig[n] * gainL;
+		}
+		else {
+			for (int n = 0; n < count; n++) {
+				frame[2 * n] += sig[n] * gainL;
+				frame[2 * n + 1] += sig[n] * gainR;
+			}
+		}
+	}
+	_phase[which] = phs;
+}
@@ -0,0 +1,41 @@
+/* RTcmix - Copyright (C) 2004  The RTcmix Development Team
+   See ``AUTHORS'' for a list of contributors. See ``LICENSE'' for
+   the license to this software and for a DISCLAIMER OF ALL WARRANTIES.
+*/
+#ifndef _OOSCILBANK_H_
+#define _OOSCILBANK_H_ 1
+
+// A bank of interpolating oscillators that read the same wavetable, for
+// additive synthesis.  Each has its own frequency, phase and left and right
+// gains, and process() mixes them all into a mono or stereo buffer, running
+// each oscillator a block at a time rather than calling next() per sample.
+// Phases are doubles in wavetable samples, as in Ooscili, so the table may
+// be any length.
+
+class Ooscilbank
+{
+public:
+	Ooscilbank(float SR, int count, double arr[], int len);
+	~Ooscilbank();
+	inline int count() const { return _count; }
+	void setfreq(int which, float freq);
+	void setphase(int which, double phs);	// wavetable index
+	inline double getphase(int which) const { return _phase[which]; }
+	// For mono output, only <left> is used.
+	void setgains(int which, float left, float right = 0.0f);
+	// Writes <nframes> frames of the mix to <out>, with <chans> (1 or 2)
+	// channels interleaved.
+	void process(float *out, int nframes, int chans);
+
+private:
+	void processOne(int which, float *out, int nframes, int chans);
+
+	double *_array;
+	int _length;
+	double _lendivSR;
+	int _count;
+	double *_phase, *_si;
+	float *_left, *_right;
+};
+
+#endif // _OOSCILBANK_H_
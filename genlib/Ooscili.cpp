@@ -7,10 +7,6 @@
 //#define NDEBUG
 #include <assert.h>
 
-#define kFracBits 16
-#define kFracShift 65536
-#define kFracMask (kFracShift - 1)
-
 Ooscili::Ooscili(float SR, float freq, int arr) : _sr(SR)
 {
 	array = floc(arr);
@@ -27,16 +23,15 @@ Ooscili::Ooscili(float SR, float freq, double arr[], int len) : _sr(SR)
 
 void Ooscili::init(float freq)
 {
-	assert(length < kFracShift / 2);
+	assert(length > 0);
 	lendivSR = (double) length / _sr;
-	si = fp(freq * lendivSR);
-	phase = 0;
+	si = freq * lendivSR;
+	phase = 0.0;
 
 	// for arbitrary lookups in the next(nsample) method
 	tabscale = (double) (length - 1) / (_sr / freq);
 }
 
-#include <math.h>
 #ifndef M_PI
 	#define M_PI	3.14159265358979323846264338327950288
 #endif
@@ -52,38 +47,57 @@ void Ooscili::setPhaseRadians(double phs)
 		normphase = ((TWOPI + phs) / TWOPI) * length;
 	else
 		normphase = (phs / TWOPI) * length;
-	// wrap phase to [0, length)
-	if (normphase < 0.0)	{
-		while (normphase < 0.0)
-			normphase += double(length);
-	}
-	else {
-		while (normphase >= double(length))
-			normphase -= double(length);
-	}
-	phase = fp(normphase);
+	setphase(normphase);		// wraps phase to [0, length)
 }
 
 float Ooscili::next()
 {
-	int i = phase >> kFracBits;
+	const int i = (int) phase;
 	int k = i + 1;
 	if (k >= length)
 		k = 0;
-	const int frac = phase & kFracMask;
-	float output = array[i] + (((array[k] - array[i]) * frac) / kFracShift);
+	const double frac = phase - i;
+	float output = array[i] + ((array[k] - array[i]) * frac);
 
 	// prepare for next call
 	phase += si;
-	fixed_t fplen = length << kFracBits;
-	while (phase >= fplen)
-		phase -= fplen;
-	while (phase < 0)		// handle negative freqs
-		phase += fplen;
+	wrap();
 
 	return output;
 }
 
+// Same as calling next() <nsamps> times, with the state in locals.  Unless
+// the frequency is at least the sampling rate, one add or subtract of the
+// length keeps the phase in range.
+
+void Ooscili::process(float *out, int nsamps)
+{
+	const double *tab = array;
+	const int len = length;
+	const double dlength = length;
+	const double inc = si;
+	double phs = phase;
+	if (inc >= dlength || inc <= -dlength) {
+		for (int n = 0; n < nsamps; n++)
+			out[n] = next();
+		return;
+	}
+	for (int n = 0; n < nsamps; n++) {
+		const int i = (int) phs;
+		const int k = (i + 1 < len) ? i + 1 : 0;
+		out[n] = tab[i] + ((tab[k] - tab[i]) * (phs - i));
+		phs += inc;
+		if (phs >= dlength)
+			phs -= dlength;
+		else if (phs < 0.0) {
+			phs += dlength;
+			if (phs >= dlength)
+				phs = 0.0;
+		}
+	}
+	phase = phs;
+}
+
 float Ooscili::next(int nsample)
 {
 	assert(nsample >= 0);
@@ -5,39 +5,53 @@
 #ifndef _OOSCILI_H_
 #define _OOSCILI_H_ 1
 
-#include <stdint.h>
+#include <math.h>
 
-// We use a 16.16 fixed-point integer for phase calculations.  65536 (2^16)
-// is the amount to shift each half of the integer (whole and decimal).
-// NOTE: we could double the size of this on 64-bit platforms, but be
-// careful of overflow when multiplying by <frac> in next().   If changing,
-// note macros at top of .cpp file.
-
-typedef int32_t fixed_t;	// 16.16 fixed point
-
-inline fixed_t fp(double val) { return (fixed_t) (val * 65536); }
+// The phase is a double, in wavetable samples.  (It used to be 16.16 fixed
+// point, which limited tables to fewer than 32768 samples.)  To run many
+// oscillators that share a table, see Ooscilbank.
 
 class Ooscili
 {
 	double lendivSR;
 	double tabscale;
-	fixed_t si, phase;
+	double si, phase;
 	double *array;
 	float _sr;
 	int length;
 
 	void init(float);
+	inline void wrap();
 public:
 	Ooscili(float SR, float freq, int arr);
 	Ooscili(float SR, float freq, double arr[], int len);
 	float next();
 	float next(int nsample);
-	inline void setfreq(float freq) { si = fp(freq * lendivSR); }
-	inline void setphase(double phs) { phase = fp(phs); }	// wavetable index
+	// Writes the next <nsamps> samples to <out>.
+	void process(float *out, int nsamps);
+	inline void setfreq(float freq) { si = freq * lendivSR; }
+	inline void setphase(double phs) { phase = phs; wrap(); }	// wavetable index
 	void setPhaseRadians(double phs);
-	inline double getphase() const { return double(phase) / 65536; }
+	inline double getphase() const { return phase; }
 	inline int getlength() const { return length; }
 //	inline float getdur() const { return 1.0 / freq; }
 };
 
+// Keep the phase within [0, length), for any frequency, negative or not.
+inline void Ooscili::wrap()
+{
+	const double dlength = length;
+	if (phase >= dlength) {
+		if (phase >= dlength * 2)
+			phase = fmod(phase, dlength);
+		else
+			phase -= dlength;
+	}
+	else if (phase < 0.0) {
+		phase = fmod(phase, dlength) + dlength;
+		if (phase >= dlength)		// when fmod gives -0 or a tiny remainder
+			phase = 0.0;
+	}
+}
+
 #endif // _OOSCILI_H_
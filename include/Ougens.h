@@ -11,6 +11,7 @@
 #include "../genlib/Obucket.h"
 #include "../genlib/Ocomb.h"
 #include "../genlib/Ocombi.h"
+#include "../genlib/Oconvolve.h"
 #include "../genlib/Odcblock.h"
 #include "../genlib/Odelay.h"
 #include "../genlib/Odelayi.h"
@@ -19,6 +20,7 @@
 #include "../genlib/Offt.h"
 #include "../genlib/Oonepole.h"
 #include "../genlib/Ooscil.h"
+#include "../genlib/Ooscilbank.h"
 #include "../genlib/Ooscili.h"
 #include "../genlib/Orand.h"
 #include "../genlib/Oreson.h"
@@ -45,7 +45,7 @@ struct CheckNode;
 struct BusConfig
 {
 	BusConfig() : In_Config(0), HasChild(false), HasParent(false), AuxInUse(false), AuxOutInUse(false),
-				  OutInUse(false), RevPlay(0) {}
+				  OutInUse(false), RevPlay(0), Depth(0) {}
 	/* Bus graph, parsed by check_bus_inst_config */
 	/* Allows loop checking ... and buffer playback order? */
 	CheckNode *	In_Config;
@@ -56,6 +56,8 @@ struct BusConfig
 	bool		AuxOutInUse;
 	bool		OutInUse;
 	short		RevPlay;
+	/* Longest chain of aux-to-aux buses feeding this one (0 if none) */
+	short		Depth;
 };
 
 class BusSlot;
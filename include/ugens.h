@@ -107,6 +107,7 @@ float oscilni(float, float, double*, int, float*);
 double pchcps(double);
 double pchmidi(double);
 double pchoct(double);
+void offt_rfft(float x[], int N, int forward);	/* Offt.cpp */
 double octlet(unsigned char *);
 double cpslet(unsigned char *);
 double pchlet(unsigned char *);
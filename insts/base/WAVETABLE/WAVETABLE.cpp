@@ -125,8 +125,6 @@ int WAVETABLE::init(double p[], int n_args)
 				wavetable[i] = sin(twopi * ((double) i / tablelen));
 		}
 	}
-	if (tablelen > 32767)
-		return die("WAVETABLE", "wavetable must have fewer than 32768 samples.");
 
 	osc = new Ooscili(SR, freq, wavetable, tablelen);
 
@@ -154,7 +152,9 @@ void WAVETABLE::doupdate()
 int WAVETABLE::run()
 {
 	const int nframes = framesToRun();
-	for (int i = 0; i < nframes; i++) {
+	const int chans = outputChannels();
+	int i = 0;
+	while (i < nframes) {
 		if (--branch <= 0) {
 			if (fastUpdate) {
 				if (amptable)
@@ -165,16 +165,26 @@ int WAVETABLE::run()
 			branch = getSkip();
 		}
 
-		float out[2];
-		out[0] = osc->next() * amp;
-
-		if (outputChannels() == 2) {
-			out[1] = (1.0 - spread) * out[0];
-			out[0] *= spread;
+		// Run the oscillator up to the next update, straight into outbuf,
+		// then spread the samples out to stereo from the end backwards.
+		const int count = (branch < nframes - i) ? branch : nframes - i;
+		float *out = &outbuf[i * chans];
+		osc->process(out, count);
+		if (chans == 2) {
+			for (int n = count - 1; n >= 0; n--) {
+				const float sig = out[n] * amp;
+				out[2 * n + 1] = (1.0 - spread) * sig;
+				out[2 * n] = sig * spread;
+			}
+		}
+		else {
+			for (int n = 0; n < count; n++)
+				out[n] *= amp;
 		}
 
-		rtaddout(out);
-		increment();
+		branch -= count - 1;
+		i += count;
+		increment(count);
 	}
 	return framesToRun();
 }
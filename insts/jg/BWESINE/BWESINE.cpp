@@ -105,8 +105,6 @@ int BWESINE::init(double p[], int n_args)
 	double *wavetable = (double *) getPFieldTable(7, &tablelen);
 	if (wavetable == NULL)
 		return die("WAVETABLE", "No wavetable specified.");
-	if (tablelen > 32767)
-		return die("WAVETABLE", "wavetable must have fewer than 32768 samples.");
 
 	_noi = new BweNoise();
 	_osc = new Ooscili(SR, 1, wavetable, tablelen);
@@ -140,31 +138,43 @@ void BWESINE::doupdate()
 
 int BWESINE::run()
 {
-	for (int i = 0; i < framesToRun(); i++) {
+	const int nframes = framesToRun();
+	const int chans = outputChannels();
+	int i = 0;
+	while (i < nframes) {
 		if (--_branch <= 0) {
 			doupdate();
 			_branch = getSkip();
 		}
 
-		float out[2];
-		double amp = _amp;
-		if (_bandwidth == 1.0) {
-			amp *= M_SQRT2 * _noi->next();
+		// Run the oscillator up to the next update, straight into outbuf,
+		// apply the noisy amplitude, then spread the samples out to stereo
+		// from the end backwards.
+		const int count = (_branch < nframes - i) ? _branch : nframes - i;
+		float *out = &outbuf[i * chans];
+		_osc->process(out, count);
+		for (int n = 0; n < count; n++) {
+			double amp = _amp;
+			if (_bandwidth == 1.0) {
+				amp *= M_SQRT2 * _noi->next();
+			}
+			else if (_bandwidth != 0.0) {
+				double a = sqrt(1.0 - _bandwidth);
+				a += sqrt(2.0 * _bandwidth) * _noi->next();
+				amp *= a;
+			}
+			out[n] *= amp * kDeNormalizer;
 		}
-		else if (_bandwidth != 0.0) {
-			double a = sqrt(1.0 - _bandwidth);
-			a += sqrt(2.0 * _bandwidth) * _noi->next();
-			amp *= a;
+		if (chans == 2) {
+			for (int n = count - 1; n >= 0; n--) {
+				out[2 * n + 1] = out[n] * (1.0 - _pan);
+				out[2 * n] = out[n] * _pan;
+			}
 		}
-		out[0] = _osc->next() * amp * kDeNormalizer;
 
-		if (outputChannels() == 2) {
-			out[1] = out[0] * (1.0 - _pan);
-			out[0] *= _pan;
-		}
-
-		rtaddout(out);
-		increment();
+		_branch -= count - 1;
+		i += count;
+		increment(count);
 	}
 
 	return framesToRun();
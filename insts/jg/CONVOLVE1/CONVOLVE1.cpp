@@ -17,25 +17,24 @@
    p3 (amplitude), p9 (wet percent) and p11 (pan) can receive dynamic updates
    from a table or real-time control source.
 
-   This instrument is designed for short impulse responses: a maximum of about
-   6 seconds at 44.1kHz sampling rate, though a few hundred milliseconds is more
-   typical.  The impulse response duration determines the FFT size: the longer
-   the response, the larger the FFT size, and therefore the more transient
-   smearing.  Only one FFT of the impulse response is taken.  The FFT size of
-   the input equals that of the impulse response, and there is a delay before
-   the start of sound approximately equal to the impulse response duration.
-   (Actually, the delay in frames is the smallest power of two that is greater
-   than the impulse response length.)
-
-   With this in mind, the best strategy for using the instrument is to loop with
-   very short notes, while creeping through both the input and the impulse
-   response.  See the example scores.
-
-   NOTE: This instrument can work with very small buffer sizes (e.g., 32), but
-   it probably will cause audio buffer underruns if the impulse response is
-   longer than about 20 milliseconds.
+   The impulse response can be up to about 6 seconds long at 44.1kHz sampling
+   rate.  It is convolved in partitions the size of the RTcmix buffer (rounded
+   up to a power of two), using uniformly partitioned overlap-save, so the
+   delay before the start of sound is one such block, however long the
+   impulse response, and the work done for every buffer is the same.  The
+   spectra of the partitions are computed once, when the note is configured.
+   The impulse response is normalized so that the peak of its spectrum equals
+   the impulse gain (p7).
+
+   If there is a window function table, it shapes the impulse response, and
+   it also enters the input repeatedly, once per impulse response duration.
+
+   The best strategy for using the instrument is still to loop with short
+   notes, while creeping through both the input and the impulse response.
+   See the example scores.
 
    John Gibson, 5/31/05 (based on cmix convolve)
+   Partitioned convolution added 10/2026.
 */
 
 #include <stdio.h>
@@ -78,12 +77,13 @@ inline float clamp(float low, float val, float high)
 
 CONVOLVE1::CONVOLVE1()
 	: _branch(0),
+	  _blockIndex(0),
+	  _winIndex(0),
 	  _inbuf(NULL),      // buffer to read (possibly multichannel) input
-	  _imp(NULL),        // buffer holding impulse response spectrum
-	  _ovadd(NULL),      // buffer for overlap-adding fft output
-	  _dry(NULL),        // dry signal for output
-	  _wet(NULL),        // wet signal for output
-	  _bucket(NULL),     // input bucket
+	  _inblock(NULL),    // block of input for the convolver
+	  _wetblock(NULL),   // block of convolver output, one block behind input
+	  _dryblock(NULL),   // dry signal, delayed to match
+	  _convolver(NULL),  // partitioned convolution engine
 	  _winosc(NULL)      // window function table oscillator
 {
 }
@@ -91,13 +91,11 @@ CONVOLVE1::CONVOLVE1()
 CONVOLVE1::~CONVOLVE1()
 {
 	delete [] _inbuf;
-	delete [] _imp;
-	delete [] _ovadd;
-	delete [] _dry;
-	delete [] _wet;
+	delete [] _inblock;
+	delete [] _wetblock;
+	delete [] _dryblock;
 	delete _winosc;
-	delete _bucket;
-	delete _fft;
+	delete _convolver;
 }
 
 int CONVOLVE1::init(double p[], int n_args)
@@ -126,15 +124,24 @@ int CONVOLVE1::init(double p[], int n_args)
 	// NOTE: <impend> may be past end of table; we handle that in prepareImpulse.
 	DPRINT2("impend=%d, _imptablen=%d\n", impend, _imptablen);
 	_impframes = impend - _impStartIndex;
+	if (_impframes > kMaxImpulseFrames)
+		return die("CONVOLVE1", "Impulse duration must be no more than %d frames.",
+										kMaxImpulseFrames);
 
+	// This FFT length is used only to normalize the impulse response.
 	_halfFFTlen = kMinFFTsize / 2;
-	for ( ; _halfFFTlen < kMaxImpulseFrames; _halfFFTlen *= 2)
-		if (_halfFFTlen >= _impframes)
-			break;
+	while (_halfFFTlen < _impframes)
+		_halfFFTlen *= 2;
 	_fftlen = 2 * _halfFFTlen;
-	DPRINT2("_impframes=%d, _halfFFTlen=%d\n", _impframes, _halfFFTlen);
-	rtcmix_advise("CONVOLVE1", "Using %d impulse response frames.  FFT length is %d.",
-				_impframes, _fftlen);
+
+	// The convolution block size, and so the latency, is the RTcmix buffer
+	// size, rounded up to a power of two for the FFT.
+	_blocklen = 32;
+	while (_blocklen < RTBUFSAMPS)
+		_blocklen *= 2;
+	DPRINT2("_impframes=%d, _blocklen=%d\n", _impframes, _blocklen);
+	rtcmix_advise("CONVOLVE1", "Using %d impulse response frames in %d partitions of %d.",
+				_impframes, (_impframes + _blocklen - 1) / _blocklen, _blocklen);
 
 	if (rtsetinput(inskip, this) == -1)
 		return DONT_SCHEDULE;	// no input
@@ -142,11 +149,11 @@ int CONVOLVE1::init(double p[], int n_args)
 		return die("CONVOLVE1", "You asked for channel %d of a %d-channel input.",
 										_inchan, inputChannels());
 
-	// Latency is the delay before the FFT looks at actual input rather than
-	// zero-padding.  Need to let inst run long enough to compensate for this.
+	// Latency is one convolution block.  Need to let inst run long enough to
+	// compensate for this and for the ring-down of the impulse response.
 
-	const float latency = float(_impframes) / SR;
-	const float ringdur = latency;
+	const float latency = float(_blocklen) / SR;
+	const float ringdur = float(_impframes) / SR;
 	if (rtsetoutput(outskip, latency + indur + ringdur, this) == -1)
 		return DONT_SCHEDULE;
 	if (outputChannels() > 2)
@@ -156,8 +163,6 @@ int CONVOLVE1::init(double p[], int n_args)
 	int winlen;
 	double *wintab = (double *) getPFieldTable(8, &winlen);
 	if (wintab) {
-		if (winlen > 32767)	// limit for new fixed-point Ooscili
-			return die("CONVOLVE1", "Window table size must be less than 32768.");
 		const float freq = 1.0 / ((float) _impframes / SR);
 		_winosc = new Ooscili(SR, freq, wintab, winlen);
 	}
@@ -168,42 +173,45 @@ int CONVOLVE1::init(double p[], int n_args)
 
 int CONVOLVE1::prepareImpulse()
 {
-	// copy and window impulse response; zero-pad to fft length
-	const int end = imin(_imptablen, _impframes);
+	// copy and window impulse response
+	float *imp = new float [_impframes];
+	const int end = imin(_imptablen - _impStartIndex, _impframes);
 	if (_winosc) {
 		for (int i = 0, j = _impStartIndex; i < end; i++, j++)
-			_fftbuf[i] = _imptab[j] * _winosc->next(i);
+			imp[i] = _imptab[j] * _winosc->next(i);
 	}
 	else
 		for (int i = 0, j = _impStartIndex; i < end; i++, j++)
-			_fftbuf[i] = _imptab[j];
-	for (int i = end; i < _fftlen; i++)
-		_fftbuf[i] = 0.0f;
-
-	_fft->r2c();	// take FFT
-
-	// normalize spectrum
-	double max = 0.0;
-	for (int i = 0; i < _halfFFTlen; i++) {
-		int index = i << 1;
-		float a = _fftbuf[index];
-		float b = _fftbuf[index + 1];
-		double c2 = (a * a) + (b * b);
-		if (c2 > max)
-			max = c2;
+			imp[i] = _imptab[j];
+	for (int i = end; i < _impframes; i++)
+		imp[i] = 0.0f;
+
+	// Take one FFT of the whole response, zero-padded, to find the peak of
+	// its spectrum, and scale the response so that peak equals _impgain.
+	Offt fft(_fftlen, Offt::kRealToComplex);
+	float *fftbuf = fft.getbuf();
+	for (int i = 0; i < _impframes; i++)
+		fftbuf[i] = imp[i];
+	for (int i = _impframes; i < _fftlen; i++)
+		fftbuf[i] = 0.0f;
+	fft.r2c();
+	double max = fabs(fftbuf[0]) > fabs(fftbuf[1]) ? fabs(fftbuf[0]) : fabs(fftbuf[1]);
+	for (int i = 2; i < _fftlen; i += 2) {
+		double mag = sqrt((fftbuf[i] * fftbuf[i]) + (fftbuf[i + 1] * fftbuf[i + 1]));
+		if (mag > max)
+			max = mag;
 	}
-	if (max != 0.0)
-		max = _impgain / sqrt(max);
-	else
+	if (max == 0.0) {
+		delete [] imp;
 		return die("CONVOLVE1", "Impulse response is all zeros.");
+	}
+	// r2c scaled the spectrum by 1 / _fftlen.
+	const float scale = _impgain / (max * _fftlen);
+	for (int i = 0; i < _impframes; i++)
+		imp[i] *= scale;
 
-	_imp = new float [_fftlen];
-	if (_imp == NULL)
-		return -1;
-	for (int i = 0; i < _fftlen; i++)
-		_imp[i] = _fftbuf[i] * max;
-
-//	for (int i = 0; i < _fftlen; i++) printf("[%d] = %f\n", i, _imp[i]);
+	_convolver = new Oconvolve(imp, _impframes, _blocklen);
+	delete [] imp;
 
 	return 0;
 }
@@ -212,32 +220,11 @@ int CONVOLVE1::prepareImpulse()
 int CONVOLVE1::configure()
 {
 	_inbuf = new float [RTBUFSAMPS * inputChannels()];
-	_ovadd = new float [_impframes];
-	if (_inbuf == NULL || _ovadd == NULL)
-		return -1;
-	for (int i = 0; i < _impframes; i++)
-		_ovadd[i] = 0.0f;
-
-	// read index chases write index by _impframes
-	_outframes = imax(_halfFFTlen, RTBUFSAMPS) * 2;
-	_outReadIndex = _outframes - _impframes;
-	_outWriteIndex = 0;
-	_dry = new float [_outframes];
-	_wet = new float [_outframes];
-	if (_dry == NULL || _wet == NULL)
-		return -1;
-	for (int i = 0; i < _outframes; i++)
-		_dry[i] = _wet[i] = 0.0f;
-	DPRINT1("_outframes: %d\n", _outframes);
-
-	_bucket = new Obucket(_impframes, processWrapper, (void *) this);
-	if (_bucket == NULL)
-		return -1;
-
-	_fft = new Offt(_fftlen);
-	if (_fft == NULL)
-		return -1;
-	_fftbuf = _fft->getbuf();
+	_inblock = new float [_blocklen];
+	_wetblock = new float [_blocklen];
+	_dryblock = new float [_blocklen];
+	for (int i = 0; i < _blocklen; i++)
+		_inblock[i] = _wetblock[i] = _dryblock[i] = 0.0f;
 
 	if (prepareImpulse() != 0)
 		return -1;
@@ -246,66 +233,6 @@ int CONVOLVE1::configure()
 }
 
 
-void CONVOLVE1::convolve()
-{
-	_fft->r2c();
-
-	_fftbuf[0] = _fftbuf[0] * _imp[0];			// DC
-	_fftbuf[1] = _fftbuf[1] * _imp[1];			// Nyquist
-
-	int i = 2;
-	int j = 3;
-	for ( ; i < _fftlen; i += 2, j += 2) {
-		float a = (_fftbuf[i] * _imp[i]) - (_fftbuf[j] * _imp[j]);
-		float b = (_fftbuf[i] * _imp[j]) + (_fftbuf[j] * _imp[i]);
-		_fftbuf[i] = a;
-		_fftbuf[j] = b;
-	}
-
-	_fft->c2r();
-}
-
-
-// Called by Obucket whenever the bucket is full (i.e., has _halfFFTlen samps).
-// This static member wrapper function lets us call a non-static member
-// function, which we can't pass directly as a callback to Obucket.
-// See http://www.newty.de/fpt/callback.html for one explanation of this.
-
-void CONVOLVE1::processWrapper(const float buf[], const int len, void *obj)
-{
-	CONVOLVE1 *myself = (CONVOLVE1 *) obj;
-	myself->process(buf, len);
-}
-
-
-void CONVOLVE1::process(const float *buf, const int len)
-{
-	DPRINT1("CONVOLVE1::process (len=%d)\n", len);
-
-	// NOTE: <len> will always be equal to _impframes
-	if (_winosc)
-		for (int i = 0; i < len; i++)
-			_fftbuf[i] = buf[i] * _winosc->next(i);
-	else
-		for (int i = 0; i < len; i++)
-			_fftbuf[i] = buf[i];
-	for (int i = len; i < _fftlen; i++)
-		_fftbuf[i] = 0.0f;
-
-	convolve();
-
-	for (int i = 0, j = len; i < len; i++, j++) {
-		_ovadd[i] += _fftbuf[i];
-		_wet[_outWriteIndex] = _ovadd[i];
-		_dry[_outWriteIndex] = buf[i];
-		incrementOutWriteIndex();
-		_ovadd[i] = _fftbuf[j];
-	}
-
-//	for (int i = 0; i < _fftlen; i++) printf("[%d] = %f\n", i, _fftbuf[i]);
-}
-
-
 void CONVOLVE1::doupdate()
 {
 	double p[12];
@@ -323,19 +250,10 @@ int CONVOLVE1::run()
 	const int outchans = outputChannels();
 	const int nframes = framesToRun();
 
-	if (currentFrame() < _inframes) {
-		const int insamps = nframes * inchans;
-		rtgetin(_inbuf, this, insamps);
-		for (int i = _inchan; i < insamps; i += inchans)
-			_bucket->drop(_inbuf[i]);
-	}
-	else {
-		for (int i = 0; i < nframes; i++)
-			_bucket->drop(0.0f);
-	}
-	// If in last run invocation, make sure everything in bucket is processed.
-	if (currentFrame() + nframes >= nSamps())
-		_bucket->flush();
+	// Frames of input still to come in this buffer.
+	const int inframes = imax(0, imin(nframes, _inframes - currentFrame()));
+	if (inframes > 0)
+		rtgetin(_inbuf, this, inframes * inchans);
 
 	float drypct = 1.0 - _wetpct;
 
@@ -346,10 +264,24 @@ int CONVOLVE1::run()
 			_branch = getSkip();
 		}
 
+		// Output lags input by one block:  take this slot's output from the
+		// last block before giving the slot to the next one.
+		const float in = (i < inframes) ? _inbuf[(i * inchans) + _inchan] : 0.0f;
 		float out[2];
-		out[0] = (_wet[_outReadIndex] * _wetpct) + (_dry[_outReadIndex] * drypct);
-		incrementOutReadIndex();
+		out[0] = (_wetblock[_blockIndex] * _wetpct) + (_dryblock[_blockIndex] * drypct);
 		out[0] *= _amp;
+		_dryblock[_blockIndex] = in;
+		if (_winosc) {
+			_inblock[_blockIndex] = in * _winosc->next(_winIndex);
+			if (++_winIndex == _impframes)
+				_winIndex = 0;
+		}
+		else
+			_inblock[_blockIndex] = in;
+		if (++_blockIndex == _blocklen) {
+			_convolver->process(_inblock, _wetblock);
+			_blockIndex = 0;
+		}
 
 		if (outchans == 2) {
 			out[1] = out[0] * (1.0 - _pan);
@@ -256,7 +256,7 @@ int FREEVERB :: run()
    }
 
    // Hand off to Freeverb to do the actual work.
-   rvb->processreplace(inL, inR, outL, outR, framesToRun(), inputChannels(),
+   rvb->processblock(inL, inR, outL, outR, framesToRun(), inputChannels(),
                                                          outputChannels());
 
    return framesToRun();
@@ -23,6 +23,7 @@ public:
 			void	setfeedback(float val);
 			float	getfeedback();
 private:
+	friend class revmodel;		// for processblock()
 	float	feedback;
 	float	filterstore;
 	float	damp1;
@@ -6,6 +6,7 @@
 // Modified by JGG for RTcmix, 3 Feb 2001
 
 #include "revmodel.hpp"
+#include "simd.hpp"
 
 revmodel::revmodel()
 {
@@ -123,6 +124,196 @@ void revmodel::processreplace(float *inputL, float *inputR, float *outputL, floa
 	}
 }
 
+// Run four combs over <frames> samples of <input>, adding their outputs into
+// <output>, or replacing what is there unless <accumulate>.  Each lane of a
+// vector is one comb.  A comb reads the sample it wrote a whole buffer ago,
+// so the samples it reads in a stretch that doesn't wrap around its buffer
+// can be loaded four at a time and transposed into lanes; only the damping
+// filter has to step through them one by one.
+
+void revmodel::combblock(fv_comb *combs, const float *input, float *output, int frames, bool accumulate)
+{
+	float lanes[4];
+	for (int k = 0; k < 4; k++)
+		lanes[k] = combs[k].feedback;
+	const fv_float4 feedback = fv_load(lanes);
+	for (int k = 0; k < 4; k++)
+		lanes[k] = combs[k].damp1;
+	const fv_float4 damp1 = fv_load(lanes);
+	for (int k = 0; k < 4; k++)
+		lanes[k] = combs[k].damp2;
+	const fv_float4 damp2 = fv_load(lanes);
+	for (int k = 0; k < 4; k++)
+		lanes[k] = combs[k].filterstore;
+	fv_float4 filterstore = fv_load(lanes);
+
+	int n = 0;
+	while (n < frames)
+	{
+		int seg = frames - n;
+		float *buf[4];
+		for (int k = 0; k < 4; k++)
+		{
+			const int left = combs[k].bufsize - combs[k].bufidx;
+			if (left < seg)
+				seg = left;
+			buf[k] = combs[k].buffer + combs[k].bufidx;
+		}
+		const float *in = input + n;
+		float *out = output + n;
+
+		int m = 0;
+		for (; m + 4 <= seg; m += 4)
+		{
+			fv_float4 r0 = fv_load(buf[0] + m);
+			fv_float4 r1 = fv_load(buf[1] + m);
+			fv_float4 r2 = fv_load(buf[2] + m);
+			fv_float4 r3 = fv_load(buf[3] + m);
+			fv_float4 sum = fv_add(fv_add(r0, r1), fv_add(r2, r3));
+			if (accumulate)
+				sum = fv_add(fv_load(out + m), sum);
+			fv_store(out + m, sum);
+
+			// Now each vector holds one sample of all four combs.  The filter
+			// state is flushed once per vector, outside of its dependency chain.
+			fv_transpose(r0, r1, r2, r3);
+			filterstore = fv_add(fv_mul(r0, damp2), fv_mul(filterstore, damp1));
+			r0 = fv_clamp(fv_add(fv_set1(in[m]), fv_mul(filterstore, feedback)));
+			filterstore = fv_add(fv_mul(r1, damp2), fv_mul(filterstore, damp1));
+			r1 = fv_clamp(fv_add(fv_set1(in[m + 1]), fv_mul(filterstore, feedback)));
+			filterstore = fv_add(fv_mul(r2, damp2), fv_mul(filterstore, damp1));
+			r2 = fv_clamp(fv_add(fv_set1(in[m + 2]), fv_mul(filterstore, feedback)));
+			filterstore = fv_add(fv_mul(r3, damp2), fv_mul(filterstore, damp1));
+			r3 = fv_clamp(fv_add(fv_set1(in[m + 3]), fv_mul(filterstore, feedback)));
+			filterstore = fv_clamp(filterstore);
+			fv_transpose(r0, r1, r2, r3);
+			fv_store(buf[0] + m, r0);
+			fv_store(buf[1] + m, r1);
+			fv_store(buf[2] + m, r2);
+			fv_store(buf[3] + m, r3);
+		}
+		if (m < seg)
+		{
+			fv_store(lanes, filterstore);
+			for (; m < seg; m++)
+			{
+				float sum = 0.0f;
+				for (int k = 0; k < 4; k++)
+				{
+					const float output = buf[k][m];
+					lanes[k] = fv_clamp((output*combs[k].damp2) + (lanes[k]*combs[k].damp1));
+					buf[k][m] = fv_clamp(in[m] + (lanes[k]*combs[k].feedback));
+					sum += output;
+				}
+				out[m] = accumulate ? out[m] + sum : sum;
+			}
+			filterstore = fv_load(lanes);
+		}
+
+		for (int k = 0; k < 4; k++)
+		{
+			combs[k].bufidx += seg;
+			if (combs[k].bufidx >= combs[k].bufsize)
+				combs[k].bufidx = 0;
+		}
+		n += seg;
+	}
+
+	fv_store(lanes, filterstore);
+	for (int k = 0; k < 4; k++)
+		combs[k].filterstore = lanes[k];
+}
+
+// Run <buf> through an allpass in place.  As with the combs, nothing read
+// within a stretch that doesn't wrap was written in it, so it vectorizes
+// straight across the samples.
+
+void revmodel::allpassblock(fv_allpass &allpass, float *buf, int frames)
+{
+	const fv_float4 feedback = fv_set1(allpass.feedback);
+
+	int n = 0;
+	while (n < frames)
+	{
+		int seg = frames - n;
+		const int left = allpass.bufsize - allpass.bufidx;
+		if (left < seg)
+			seg = left;
+		float *delay = allpass.buffer + allpass.bufidx;
+		float *io = buf + n;
+
+		int m = 0;
+		for (; m + 4 <= seg; m += 4)
+		{
+			const fv_float4 bufout = fv_load(delay + m);
+			const fv_float4 input = fv_load(io + m);
+			fv_store(delay + m, fv_clamp(fv_add(input, fv_mul(bufout, feedback))));
+			fv_store(io + m, fv_sub(bufout, input));
+		}
+		for (; m < seg; m++)
+		{
+			const float bufout = delay[m];
+			const float input = io[m];
+			delay[m] = fv_clamp(input + (bufout*allpass.feedback));
+			io[m] = -input + bufout;
+		}
+
+		allpass.bufidx += seg;
+		if (allpass.bufidx >= allpass.bufsize)
+			allpass.bufidx = 0;
+		n += seg;
+	}
+}
+
+void revmodel::processblock(float *inputL, float *inputR, float *outputL, float *outputR, long numsamples, int input_skip, int output_skip)
+{
+	float input[blockframes];
+	float outL[blockframes];
+	float outR[blockframes];
+
+	while (numsamples > 0)
+	{
+		const int frames = (numsamples < blockframes) ? (int) numsamples : (int) blockframes;
+
+		for (int n = 0; n < frames; n++)
+			input[n] = (inputL[n*input_skip] + inputR[n*input_skip]) * gain;
+
+		// Accumulate comb filters in parallel
+		combblock(&combL[0], input, outL, frames, false);
+		combblock(&combL[4], input, outL, frames, true);
+		combblock(&combR[0], input, outR, frames, false);
+		combblock(&combR[4], input, outR, frames, true);
+
+		// Feed through allpasses in series
+		for (int i=0; i<numallpasses; i++)
+		{
+			allpassblock(allpassL[i], outL, frames);
+			allpassblock(allpassR[i], outR, frames);
+		}
+
+		// Calculate output REPLACING anything already there
+		for (int n = 0; n < frames; n++)
+		{
+			const float dryL = inputL[n*input_skip] * dry;
+			const float dryR = inputR[n*input_skip] * dry;
+			if (predelay_samps) {
+				outputL[n*output_skip] = delayL.process(outL[n]*wet1 + outR[n]*wet2) + dryL;
+				outputR[n*output_skip] = delayR.process(outR[n]*wet1 + outL[n]*wet2) + dryR;
+			}
+			else {
+				outputL[n*output_skip] = outL[n]*wet1 + outR[n]*wet2 + dryL;
+				outputR[n*output_skip] = outR[n]*wet1 + outL[n]*wet2 + dryR;
+			}
+		}
+
+		inputL += frames * input_skip;
+		inputR += frames * input_skip;
+		outputL += frames * output_skip;
+		outputR += frames * output_skip;
+		numsamples -= frames;
+	}
+}
+
 void revmodel::processmix(float *inputL, float *inputR, float *outputL, float *outputR, long numsamples, int skip)
 {
 	float outL,outR,input;
@@ -20,6 +20,9 @@ public:
 			void	mute();
 			void	processmix(float *inputL, float *inputR, float *outputL, float *outputR, long numsamples, int skip);
 			void	processreplace(float *inputL, float *inputR, float *outputL, float *outputR, long numsamples, int input_skip, int output_skip);
+			// Same result as processreplace, but a block at a time, with the
+			// combs four to a SIMD vector and denormals flushed to zero.
+			void	processblock(float *inputL, float *inputR, float *outputL, float *outputR, long numsamples, int input_skip, int output_skip);
 			void	setroomsize(float value);
 			float	getroomsize();
 			void	setdamp(float value);
@@ -36,6 +39,9 @@ public:
 			int		getpredelay();
 private:
 			void	update();
+	static	void	combblock(fv_comb *combs, const float *input, float *output, int frames, bool accumulate);
+	static	void	allpassblock(fv_allpass &allpass, float *buf, int frames);
+	enum { blockframes = 128 };
 private:
 	float	gain;
 	float	roomsize,roomsize1;
@@ -0,0 +1,116 @@
+// Four-wide float vectors for the block reverb
+//
+// Uses SSE2 or NEON when the compiler targets them, and plain arrays otherwise.
+// Only the handful of operations that revmodel::processblock() needs are here.
+// JGG's objlib ClampDenormals.h macro works on one sample and only on i386;
+// fv_clamp() does the same thing to four samples on any target.
+
+#ifndef _fv_simd_
+#define _fv_simd_
+
+#if defined(__SSE2__)
+ #include <emmintrin.h>
+ #define FV_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define FV_NEON
+#endif
+
+#if defined(FV_SSE)
+
+typedef __m128 fv_float4;
+
+inline fv_float4 fv_load(const float *p) { return _mm_loadu_ps(p); }
+inline void fv_store(float *p, fv_float4 v) { _mm_storeu_ps(p, v); }
+inline fv_float4 fv_set1(float x) { return _mm_set1_ps(x); }
+inline fv_float4 fv_add(fv_float4 a, fv_float4 b) { return _mm_add_ps(a, b); }
+inline fv_float4 fv_sub(fv_float4 a, fv_float4 b) { return _mm_sub_ps(a, b); }
+inline fv_float4 fv_mul(fv_float4 a, fv_float4 b) { return _mm_mul_ps(a, b); }
+
+// Zero any lane whose exponent bits are all zero.
+inline fv_float4 fv_clamp(fv_float4 v)
+{
+	const __m128i exponent = _mm_and_si128(_mm_castps_si128(v), _mm_set1_epi32(0x7f800000));
+	const __m128 denormal = _mm_castsi128_ps(_mm_cmpeq_epi32(exponent, _mm_setzero_si128()));
+	return _mm_andnot_ps(denormal, v);
+}
+
+inline void fv_transpose(fv_float4 &a, fv_float4 &b, fv_float4 &c, fv_float4 &d)
+{
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+#elif defined(FV_NEON)
+
+typedef float32x4_t fv_float4;
+
+inline fv_float4 fv_load(const float *p) { return vld1q_f32(p); }
+inline void fv_store(float *p, fv_float4 v) { vst1q_f32(p, v); }
+inline fv_float4 fv_set1(float x) { return vdupq_n_f32(x); }
+inline fv_float4 fv_add(fv_float4 a, fv_float4 b) { return vaddq_f32(a, b); }
+inline fv_float4 fv_sub(fv_float4 a, fv_float4 b) { return vsubq_f32(a, b); }
+inline fv_float4 fv_mul(fv_float4 a, fv_float4 b) { return vmulq_f32(a, b); }
+
+inline fv_float4 fv_clamp(fv_float4 v)
+{
+	const uint32x4_t exponent = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x7f800000));
+	const uint32x4_t denormal = vceqq_u32(exponent, vdupq_n_u32(0));
+	return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(v), denormal));
+}
+
+inline void fv_transpose(fv_float4 &a, fv_float4 &b, fv_float4 &c, fv_float4 &d)
+{
+	const float32x4x2_t ab = vtrnq_f32(a, b);
+	const float32x4x2_t cd = vtrnq_f32(c, d);
+	a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+	b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+	c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+	d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+
+struct fv_float4 { float v[4]; };
+
+inline fv_float4 fv_load(const float *p) { fv_float4 r; for (int i = 0; i < 4; i++) r.v[i] = p[i]; return r; }
+inline void fv_store(float *p, fv_float4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+inline fv_float4 fv_set1(float x) { fv_float4 r; for (int i = 0; i < 4; i++) r.v[i] = x; return r; }
+inline fv_float4 fv_add(fv_float4 a, fv_float4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+inline fv_float4 fv_sub(fv_float4 a, fv_float4 b) { for (int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a; }
+inline fv_float4 fv_mul(fv_float4 a, fv_float4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+
+inline fv_float4 fv_clamp(fv_float4 a)
+{
+	for (int i = 0; i < 4; i++) {
+		union { float f; unsigned int u; } bits;
+		bits.f = a.v[i];
+		if ((bits.u & 0x7f800000) == 0)
+			a.v[i] = 0.0f;
+	}
+	return a;
+}
+
+inline void fv_transpose(fv_float4 &a, fv_float4 &b, fv_float4 &c, fv_float4 &d)
+{
+	fv_float4 *rows[4] = { &a, &b, &c, &d };
+	for (int i = 0; i < 4; i++)
+		for (int j = i + 1; j < 4; j++) {
+			float t = rows[i]->v[j];
+			rows[i]->v[j] = rows[j]->v[i];
+			rows[j]->v[i] = t;
+		}
+}
+
+#endif
+
+// One sample's worth of fv_clamp().
+inline float fv_clamp(float x)
+{
+	union { float f; unsigned int u; } bits;
+	bits.f = x;
+	return ((bits.u & 0x7f800000) == 0) ? 0.0f : x;
+}
+
+#endif//_fv_simd_
+
+//ends
@@ -87,18 +87,48 @@ void SynthGrainVoice::next(float &left, float &right)
       _inuse = false;
 }
 
+// Runs the oscillator and envelope a chunk at a time into stack buffers,
+// then mixes their product into <buffer>.
 void SynthGrainVoice::next(float *buffer, const int numFrames, const float amp)
 {
-	for (int i = _bufoutstart; i < numFrames; i++) {
-		float sig = _osc->next() * amp;
-		addOutGrain(sig, buffer, i);           // inlined
-
-      _curframe++;
-      if (_curframe == _outframes) {
-         _inuse = false;
-         break;
+   const int kChunk = 64;
+   float sigbuf[kChunk], envbuf[kChunk];
+
+   int frames = numFrames - _bufoutstart;
+   if (frames > _outframes - _curframe)
+      frames = _outframes - _curframe;
+
+   float gainL = amp * _amp, gainR = 0.0f;
+   if (_numoutchans > 1) {
+      const float panR = 1.0 - _pan;
+      const float boosted = gainL * boost(_pan, panR);
+      gainL = boosted * _pan;
+      gainR = boosted * panR;
+   }
+
+   float *out = buffer + (_bufoutstart * _numoutchans);
+   while (frames > 0) {
+      const int count = (frames < kChunk) ? frames : kChunk;
+      _osc->process(sigbuf, count);
+      _env->process(envbuf, count);
+      if (_numoutchans > 1) {
+         for (int i = 0; i < count; i++) {
+            const float sig = sigbuf[i] * envbuf[i];
+            out[0] += sig * gainL;
+            out[1] += sig * gainR;
+            out += _numoutchans;
+         }
       }
-	}
+      else {
+         for (int i = 0; i < count; i++)
+            out[i] += sigbuf[i] * envbuf[i] * gainL;
+         out += count;
+      }
+      _curframe += count;
+      frames -= count;
+   }
+
+   if (_curframe >= _outframes)
+      _inuse = false;
    _bufoutstart = 0;
 }
-
@@ -23,7 +23,7 @@ public:
    // single frame version
    void next(float &left, float &right);
 
-   // block version
+   // block version, a block of oscillator and envelope samples at a time
    void next(float *buffer, const int numFrames, const float amp);
 
 private:
@@ -34,22 +34,6 @@ private:
       return 1.0 / sqrt((panL * panL) + (panR * panR));
    }
 
-   // Called only when doing block I/O.
-   inline void addOutGrain(float sig, float *buffer, const int frameIndex)
-   {
-      sig *= _env->next() * _amp;
-
-      if (_numoutchans > 1) {
-         const float panR = 1.0 - _pan;
-         sig *= boost(_pan, panR);
-         const int index = frameIndex * _numoutchans;
-         buffer[index] += sig * _pan;
-         buffer[index + 1] += sig * panR;
-      }
-      else
-         buffer[frameIndex] += sig;
-   }
-
    double _srate;
    double *_wavetab;
    int _wavetablen;
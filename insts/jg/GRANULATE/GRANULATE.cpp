@@ -260,7 +260,7 @@ int GRANULATE::run()
       increment();
 
       if (!_keepgoing) {
-// FIXME: how do we remove note from RTcmix queue?
+         finish();
          break;
       }
    }
@@ -293,7 +293,8 @@ int GRANULATE::run()
       rtbaddout(_block, blockframes);
       increment(blockframes);
       if (!_keepgoing && !_stopped) {
-// FIXME: how do we remove note from RTcmix queue?
+         // Play silence to the end of this buffer, then leave the queue.
+         finish();
          const int samps = RTBUFSAMPS * outputChannels();
          for (int i = 0; i < samps; i++)
             _block[i] = 0.0f;
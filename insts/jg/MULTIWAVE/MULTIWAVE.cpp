@@ -40,18 +40,12 @@ MULTIWAVE::MULTIWAVE() : Instrument()
    branch = 0;
    numpartials = 0;
    oscil = NULL;
-   amp = NULL;
-   pan = NULL;
 }
 
 
 MULTIWAVE::~MULTIWAVE()
 {
-   for (int i = 0; i < numpartials; i++)
-      delete oscil[i];
-   delete [] oscil;
-   delete [] amp;
-   delete [] pan;
+   delete oscil;
 }
 
 
@@ -83,34 +77,36 @@ int MULTIWAVE::init(double p[], int n_args)
       return die("MULTIWAVE", "p3 must be wavetable (use maketable)");
 
    numpartials = (nargs - FIRST_FREQ_ARG) / 4;
-   oscil = new Ooscili * [numpartials];
-   amp = new double [numpartials];
-   pan = new double [numpartials];
+   oscil = new Ooscilbank(SR, numpartials, wavet, wavelen);
 
    for (int i = 0; i < numpartials; i++) {
-      oscil[i] = new Ooscili(SR, 440.0, wavet, wavelen);
       const int index = FIRST_FREQ_ARG + (4 * i);
-      oscil[i]->setphase(p[index + 2] / 360.0);
-      amp[i] = 0.0;
-      pan[i] = 0.0;
+      oscil->setphase(i, p[index + 2] / 360.0);
    }
 
    return nSamps();
 }
 
 
+// The overall amplitude and the partial count scale each partial's gains.
+
 void MULTIWAVE::doupdate()
 {
    double p[nargs];
    update(p, nargs);
 
-   overall_amp = p[2];
+   const int chans = outputChannels();
+   const double scale = (1.0 / double(numpartials)) * (p[2] * chans);
 
    for (int i = 0; i < numpartials; i++) {
       const int index = FIRST_FREQ_ARG + (4 * i);
-      oscil[i]->setfreq(p[index]);
-      amp[i] = p[index + 1];
-      pan[i] = p[index + 3];
+      oscil->setfreq(i, p[index]);
+      const double amp = p[index + 1] * scale;
+      const double pan = p[index + 3];
+      if (chans == 1)
+         oscil->setgains(i, amp);
+      else
+         oscil->setgains(i, amp * pan, amp * (1.0 - pan));
    }
 }
 
@@ -119,32 +115,19 @@ int MULTIWAVE::run()
 {
    const int samps = framesToRun();
    const int chans = outputChannels();
-   float out[chans];
 
-   for (int i = 0; i < samps; i++) {
+   // Run the bank up to each update, straight into outbuf.
+   int i = 0;
+   while (i < samps) {
       if (--branch <= 0) {
          doupdate();
          branch = getSkip();
       }
-
-      for (int j = 0; j < chans; j++)
-         out[j] = 0.0f;
-
-      for (int j = 0; j < numpartials; j++) {
-         float sig = oscil[j]->next() * amp[j];
-         if (chans == 1)
-            out[0] += sig;
-         else {
-            out[0] += sig * pan[j];
-            out[1] += sig * (1.0 - pan[j]);
-         }
-      }
-      float scale = (1.0 / float(numpartials)) * (overall_amp * chans);
-      for (int j = 0; j < chans; j++)
-         out[j] *= scale;
-
-      rtaddout(out);
-      increment();
+      const int count = (branch < samps - i) ? branch : samps - i;
+      oscil->process(&outbuf[i * chans], count, chans);
+      branch -= count - 1;
+      i += count;
+      increment(count);
    }
 
    return framesToRun();
@@ -1,10 +1,8 @@
-class Ooscili;
+class Ooscilbank;
 
 class MULTIWAVE : public Instrument {
    int     nargs, branch, numpartials;
-   double  overall_amp;
-   double  *amp, *pan;
-   Ooscili **oscil;
+   Ooscilbank *oscil;
 
    int usage();
    void doupdate();
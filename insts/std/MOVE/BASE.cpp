@@ -43,6 +43,7 @@ BASE::BASE() : m_tapsize(0)
 	in = NULL;
 	m_tapDelay = NULL;
 	m_buffersize = BUFLEN;
+	m_sharedRvb = 0;
 
 	for (int i = 0; i < 2; i++) {
 	   int j;
@@ -109,8 +110,13 @@ int BASE::init(double p[], int n_args)
 	if (inputChannels() == 1)
 	   m_inchan = 0;
 
-	if (outputChannels() != 2) {
-		return die(name(), "Output must be stereo.");
+	// With four output channels, the early response goes to the first two
+	// and the reverb input to the last two, for ROOMRVB to process once for
+	// all the notes in the room.
+	if (outputChannels() == 4)
+		m_sharedRvb = 1;
+	else if (outputChannels() != 2) {
+		return die(name(), "Output must be stereo, or 4-channel to feed ROOMRVB.");
 	}
 
 	wire_matrix(Matrix);
@@ -137,6 +143,8 @@ int BASE::init(double p[], int n_args)
    /* determine extra run time for this routine before calling rtsetoutput() */
    double ringdur = 0.0;
    finishInit(rvb_time, &ringdur);
+   if (m_sharedRvb)
+	  ringdur = (double) m_tapsize / SR;	// longest early reflection only
    
    m_branch = 0;
 
@@ -236,6 +244,7 @@ int BASE::run()
 {
 	int	i = 0;
 	double roomsig[2][BUFLEN], rvbsig[2][BUFLEN];
+	const int outChans = outputChannels();
 
 	const int totalSamps = insamps + tapcount;
 
@@ -310,19 +319,26 @@ int BASE::run()
 				/* scale reverb input by amp factor */
 				scale(&roomsig[ch][0], bufsamps, m_rvbamp);
 			}
-			/* run 1st and 2nd generation paths through reverberator */
- 			for (int n = 0; n < bufsamps; n++) {
-				if (m_rvbamp != 0.0) {
-					double rmPair[2];
-					double rvbPair[2];
-					rmPair[0] = roomsig[0][n];
-					rmPair[1] = roomsig[1][n];
-					RVB(rmPair, rvbPair, cursamp + n);
-					rvbsig[0][n] = rvbPair[0];
-					rvbsig[1][n] = rvbPair[1];
+			/* run 1st and 2nd generation paths through reverberator,
+			   or just pass them along to ROOMRVB */
+			if (m_sharedRvb) {
+				copyBuf(&rvbsig[0][0], &roomsig[0][0], bufsamps);
+				copyBuf(&rvbsig[1][0], &roomsig[1][0], bufsamps);
+			}
+			else {
+				for (int n = 0; n < bufsamps; n++) {
+					if (m_rvbamp != 0.0) {
+						double rmPair[2];
+						double rvbPair[2];
+						rmPair[0] = roomsig[0][n];
+						rmPair[1] = roomsig[1][n];
+						RVB(rmPair, rvbPair, cursamp + n);
+						rvbsig[0][n] = rvbPair[0];
+						rvbsig[1][n] = rvbPair[1];
+					}
+					else
+						rvbsig[0][n] = rvbsig[1][n] = 0.0;
 				}
-				else
-					rvbsig[0][n] = rvbsig[1][n] = 0.0;
 			}
 			DBG(printf("summing vectors\n"));
 			if (!m_binaural) {
@@ -344,10 +360,20 @@ int BASE::run()
 			DBG(printf("right signal:\n"));
 			DBG(PrintSig(roomsig[1], bufsamps, 0.1));
 			/* sum the early response & reverbed sigs  */
-			float *outptr = &this->outbuf[i*2];
-			for (int n = 0; n < bufsamps; n++) {
-				*outptr++ = roomsig[0][n] + rvbsig[0][n];
-				*outptr++ = roomsig[1][n] + rvbsig[1][n];
+			float *outptr = &this->outbuf[i*outChans];
+			if (m_sharedRvb) {
+				for (int n = 0; n < bufsamps; n++) {
+					*outptr++ = roomsig[0][n];
+					*outptr++ = roomsig[1][n];
+					*outptr++ = rvbsig[0][n];
+					*outptr++ = rvbsig[1][n];
+				}
+			}
+			else {
+				for (int n = 0; n < bufsamps; n++) {
+					*outptr++ = roomsig[0][n] + rvbsig[0][n];
+					*outptr++ = roomsig[1][n] + rvbsig[1][n];
+				}
 			}
 			DBG(printf("FINAL MIX:\n"));
 			DBG(PrintInput(&this->outbuf[i], bufsamps));
@@ -356,10 +382,14 @@ int BASE::run()
 		else {		 /* flushing reverb */
 			// this is the current location in the main output buffer
 			// to write to now
-			float *outptr = &this->outbuf[i*2];
+			float *outptr = &this->outbuf[i*outChans];
 			DBG1(printf("  flushing reverb: i = %d, bufsamps = %d\n", i, bufsamps));
 			for (int n = 0; n < bufsamps; n++) {
-				if (m_rvbamp > 0.0) {
+				if (m_sharedRvb) {
+					for (int ch = 0; ch < outChans; ch++)
+						*outptr++ = 0.0;
+				}
+				else if (m_rvbamp > 0.0) {
 					double rmPair[2];
 					double rvbPair[2];
 					rmPair[0] = 0.0;
@@ -434,7 +464,8 @@ int BASE::alloc_firfilters()
 }
 
 /* --------------------------------------------------------- alloc_delays --- */
-/* Sets aside the memory needed for tap delay and the delays in RVB
+/* Sets aside the memory needed for tap delay and the delays in RVB.  A note
+   that sends to ROOMRVB has no delays in RVB.
 */
 int BASE::alloc_delays()
 {
@@ -446,6 +477,11 @@ int BASE::alloc_delays()
 	}
 	memset(m_tapDelay, 0, (m_tapsize + 8) * sizeof(double));
 
+	return m_sharedRvb ? 0 : alloc_rvb_delays();
+}
+
+int BASE::alloc_rvb_delays()
+{
    /* allocate memory for reverb delay lines */
    for (int i = 0; i < 2; i++) {
 	  for (int j = 0; j < 6; j++) {
@@ -942,7 +978,7 @@ void BASE::rvb_reset()
 			r->deltap = 0;	// index for each delay unit
 			r->Rvb_air[2] = 0.0;
 			double *point = r->Rvb_del;
-			while (k < rvbdelsize)
+			while (point != NULL && k < rvbdelsize)
 				point[k++] = 0.0;
 		}
 		for (j = 2; j < 502; ++j)
@@ -953,7 +989,7 @@ void BASE::rvb_reset()
 
 	/* reset tap delay */
 
-	for (i = 0; i < m_tapsize + 8; ++i)
+	for (i = 0; m_tapDelay != NULL && i < m_tapsize + 8; ++i)
 		m_tapDelay[i] = 0.0;
 }
 
@@ -27,6 +27,7 @@ protected:
    int getInput(int currentFrame, int frames);
    void wire_matrix(double [12][12]);
    int alloc_delays(void);
+   int alloc_rvb_delays(void);
    int alloc_firfilters(void);
    void get_lengths(long);
    void set_gains(float);
@@ -48,6 +49,7 @@ protected:
 protected:
    int    m_inchan, insamps, m_binaural, m_tapsize, tapcount;
    int    cartflag, rvbdelsize, m_buffersize, m_branch;
+   int    m_sharedRvb;	// send to ROOMRVB instead of running RVB per note
    float  inamp, m_dur, m_rvbamp;
    float  amptabs[2], *in;
    double *amparray;
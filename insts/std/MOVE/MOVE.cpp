@@ -37,6 +37,8 @@ Instrument *makeMOVE()
 
 
 #ifndef EMBEDDED
+extern Instrument *makeROOMRVB();	// From ROOMRVB.cpp
+
 /* ------------------------------------------------------------ rtprofile --- */
 void rtprofile()
 {
@@ -45,6 +47,7 @@ void rtprofile()
 #else
    RT_INTRO("MOVE", makeMOVE);
 #endif
+   RT_INTRO_SHARED("ROOMRVB", makeROOMRVB);
 }
 #endif
 
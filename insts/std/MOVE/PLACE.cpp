@@ -101,10 +101,13 @@ Instrument *makePLACE()
 }
 
 #ifndef EMBEDDED
+extern Instrument *makeROOMRVB();	// From ROOMRVB.cpp
+
 /* ------------------------------------------------------------ rtprofile --- */
 void rtprofile()
 {
    RT_INTRO("PLACE", makePLACE);
+   RT_INTRO_SHARED("ROOMRVB", makeROOMRVB);
 }
 #endif
 
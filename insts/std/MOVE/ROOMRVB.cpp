@@ -0,0 +1,131 @@
+// ROOMRVB.cpp -- late reverb shared by all the PLACE and MOVE notes in a room
+//
+// PLACE and MOVE each run the 2x6 delay RVB network for their own note.
+// Given four output channels, they skip it and write the early response to
+// the first two and the reverb input to the last two instead.  ROOMRVB reads
+// those four channels from an aux bus, passes the early response through and
+// adds the late reverb of the sum of all the notes' reverb inputs, using the
+// room set up by space() and matrix().
+//
+//    p0 = output skip
+//    p1 = input skip
+//    p2 = duration (covering the notes that feed it)
+//    p3 = reverb amplitude (can be updated)
+//
+// ROOMRVB rings for the reverb time given to space() after the duration.
+
+#include "ROOMRVB.h"
+#include <stdio.h>
+#include <ugens.h>
+#include "common.h"
+#include <rt.h>
+#include <rtdefs.h>
+
+extern "C" {
+   #include "setup.h"
+}
+
+/* ---------------------------------------------------------- makeROOMRVB --- */
+Instrument *makeROOMRVB()
+{
+   ROOMRVB *inst;
+
+   inst = new ROOMRVB();
+   inst->set_bus_config("ROOMRVB");
+
+   return inst;
+}
+
+ROOMRVB::ROOMRVB()
+{
+}
+
+ROOMRVB::~ROOMRVB()
+{
+}
+
+int ROOMRVB::init(double p[], int n_args)
+{
+	int	UseMikes;
+	float  outskip, inskip, abs_factor, rvb_time;
+
+	if (n_args < 4)
+		return die(name(), "Wrong number of args.");
+	outskip = p[0];
+	inskip = p[1];
+	m_dur = p[2];
+	if (m_dur < 0)					  /* "dur" represents timend */
+		m_dur = -m_dur - inskip;
+	m_rvbamp = p[3];
+
+	if (rtsetinput(inskip, this) == -1)
+	  return DONT_SCHEDULE;
+
+	if (inputChannels() != 4)
+		return die(name(), "Input must be 4-channel (2 early response, 2 reverb input).");
+	if (outputChannels() != 2)
+		return die(name(), "Output must be stereo.");
+
+	double Matrix[12][12];
+
+	/* Get results of Minc setup calls (space, mikes_on, mikes_off, matrix) */
+	if (get_setup_params(Dimensions, Matrix, &abs_factor, &rvb_time,
+						 &UseMikes, &MikeAngle, &MikePatternFactor) == -1) {
+	   return die(name(), "You must call setup routine `space' first.");
+	}
+
+	wire_matrix(Matrix);
+
+	int meanLength = MFP_samps(SR, Dimensions); // mean delay length for reverb
+	get_lengths(meanLength);			  /* sets up delay lengths */
+	set_gains(rvb_time);				/* sets gains for filters */
+	set_allpass();
+	set_random();					   /* sets up random variation of delays */
+
+	m_branch = 0;
+
+	if (rtsetoutput(outskip, m_dur + rvb_time, this) == -1)
+	  return DONT_SCHEDULE;
+	return nSamps();
+}
+
+int ROOMRVB::configure()
+{
+	in = new float [RTBUFSAMPS * inputChannels()];
+	int status = alloc_rvb_delays();
+	rvb_reset();
+	return status;
+}
+
+/* ------------------------------------------------------------------ run --- */
+int ROOMRVB::run()
+{
+	const int frames = framesToRun();
+	const int inChans = inputChannels();
+
+	rtgetin(in, this, frames * inChans);
+
+	float *outptr = &this->outbuf[0];
+	for (int n = 0; n < frames; n++) {
+		if (--m_branch < 0) {
+			double p[4];
+			update(p, 4, 1 << 3);
+			m_rvbamp = p[3];
+			m_branch = getSkip();
+		}
+		// The reverberator runs even at zero amplitude, so that its tail
+		// carries on when the amplitude comes back up.
+		double rmPair[2];
+		double rvbPair[2];
+		rmPair[0] = in[n * inChans + 2];
+		rmPair[1] = in[n * inChans + 3];
+		RVB(rmPair, rvbPair, currentFrame() + n);
+
+		/* sum the early response & reverbed sigs  */
+		*outptr++ = in[n * inChans] + rvbPair[0] * m_rvbamp;
+		*outptr++ = in[n * inChans + 1] + rvbPair[1] * m_rvbamp;
+	}
+	increment(frames);
+
+	return frames;
+}
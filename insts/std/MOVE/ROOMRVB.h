@@ -0,0 +1,19 @@
+/* ROOMRVB.h -- the late reverb of PLACE and MOVE, once for a whole room.
+   Derived from BASE for its reverberator; it has no source of its own.
+*/
+
+#include "BASE.h"
+
+class ROOMRVB : public BASE {
+public:
+    ROOMRVB();
+    virtual ~ROOMRVB();
+    virtual int init(double *, int);
+    virtual int configure();
+    virtual int run();
+protected:
+    virtual int localInit(double *, int) { return 0; }
+    virtual int finishInit(double, double *) { return 0; }
+    virtual int updatePosition(int) { return 0; }
+    virtual void get_tap(int, int, int, int) {}
+};
@@ -6,6 +6,7 @@
 #include <rtdefs.h>
 #include <string.h>
 #include <assert.h>
+#include <Ougens.h>
 
 #include "pv.h"
 #include "PVOC.h"
@@ -136,6 +137,7 @@ PVOC::PVOC() : _first(1), _valid(-1)
 	winput= NULL;
 	lpcoef= NULL;
 	_fftBuf= NULL;
+	_fft = NULL;
 	channel= NULL;
 	_pvOutput= NULL;
 	_convertPhase = NULL;
@@ -157,7 +159,7 @@ PVOC::~PVOC()
 	delete [] winput;
 	RefCounted::unref(_pvFilter);
 	delete [] lpcoef;
-	delete [] _fftBuf;
+	delete _fft;
 	delete [] channel;
 	delete [] _pvOutput;
 	delete [] _inbuf;
@@ -301,7 +303,8 @@ int PVOC::configure()
 	Hwin = ::NewArray(_windowLen);		/* plain Hamming window */
 	winput = ::NewArray(_windowLen);		/* windowed input buffer */
 	lpcoef = ::NewArray(Np+1);	/* lp coefficients */
-	_fftBuf = ::NewArray(_fftLen);		/* FFT buffer */
+	_fft = new Offt(_fftLen);			/* FFT, with shared plan */
+	_fftBuf = _fft->getbuf();		/* FFT buffer */
 	channel = ::NewArray(_fftLen+2);	/* analysis channels */
 	_pvOutput = ::NewArray(_windowLen);	/* output buffer */
 	/*
@@ -433,7 +436,7 @@ int PVOC::run()
 		/*			printf("%.3g/", lpcoef[0] ); */
 		}
 		::fold( _pvInput, Wanal, _windowLen, _fftBuf, _fftLen, _in );
-		::rfft( _fftBuf, N2, FORWARD );
+		_fft->r2c();
 		convert( _fftBuf, channel, N2, _decimation, R );
 
 	// 	if ( _interpolation == 0 ) {
@@ -477,7 +480,7 @@ int PVOC::run()
 			 * overlap-add resynthesis
 			 */
 			unconvert( channel, _fftBuf, N2, _interpolation, R );
-			::rfft( _fftBuf, N2, INVERSE );
+			_fft->c2r();
 			::overlapadd( _fftBuf, _fftLen, Wsyn, _pvOutput, _windowLen, _on );
 			// _interpolation samples written into _outbuf
 			shiftout( _pvOutput, _windowLen, _interpolation, _on);
@@ -1,6 +1,7 @@
 #include <Instrument.h>      /* the base class for this instrument */
 
 class PVFilter;
+class Offt;
 
 class PVOC : public Instrument {
 public:
@@ -24,6 +25,7 @@ protected:
 	float	_amp;
 	float	P, *Hwin, *Wanal, *Wsyn, *_pvInput, *winput;
 	float 	*lpcoef, *_fftBuf, *channel, *_pvOutput;
+	Offt	*_fft;		// _fftBuf is its buffer
 	BUFTYPE	*_outbuf;         // private interleaved buffer
 	PVFilter *_pvFilter;
 	
@@ -29,8 +29,6 @@ int sinbuf;
 int tail;
 int input,output;
 
-extern void rfft(float x[], int N, int forward);
-
 static void malerr(char *str, int ex);
 static int cmixgetfloat(float xin[2], int inchan);
 static int cmixputfloat(float *xout, float *dout, float drymix,
@@ -179,7 +177,7 @@ convolve(double p[], int n_args)
       *(filt[c]+i) = 0.;
     }
 
-    rfft(filt[c],N2,1);
+    offt_rfft(filt[c],N2,1);
     for (i=0; i<=N2; i++){
       a = *(filt[c] + 2*i);
       b = *(filt[c] + 2*i + 1);
@@ -235,7 +233,7 @@ convolve(double p[], int n_args)
   while(ringdown[0] > 0 || ringdown[1] > 0 ){
     for(c=0;c<ichan;c++){
     printf(".");	
-      rfft(sbuf[c],N2,1);
+      offt_rfft(sbuf[c],N2,1);
       if (!invert) {	/* convolution */
         for (i=0; i<=N2; i++) {
     	  ip = 2*i;
@@ -273,7 +271,7 @@ convolve(double p[], int n_args)
       }
     }
 
-    rfft(sbuf[c],N2,0);
+    offt_rfft(sbuf[c],N2,0);
     
     
     for (i=0; i<N2; i++)
@@ -20,7 +20,8 @@ public:
 		DirectionMask 	= 0xf,
 		Passive 		= 0x10,
 		CheckPeaks 		= 0x100,
-		ReportClipping 	= 0x200
+		ReportClipping 	= 0x200,
+		Dither 			= 0x400
 	};
 public:
 	virtual				~AudioDevice();
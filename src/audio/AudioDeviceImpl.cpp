@@ -2,6 +2,8 @@
 
 #include "AudioDeviceImpl.h"
 #include "audiostream.h"
+#include "OutputKernels.h"
+#include "BlockAdapter.h"
 #include "ugens.h"
 #include <string.h>
 #include <stdio.h>
@@ -36,10 +38,13 @@ AudioDeviceImpl::AudioDeviceImpl()
 	  _frameChannels(0), _deviceChannels(0), _samplingRate(0.0), _maxFrames(0),
 	  _runCallback(NULL), _stopCallback(NULL),
 	  _convertBuffer(NULL), 
-	  _recConvertFunction(NULL), _playConvertFunction(NULL), _muteThreshold(0.0)
+	  _recConvertFunction(NULL), _playConvertFunction(NULL),
+	  _playOutputFormat(MUS_UNKNOWN), _muteThreshold(0.0),
+	  _blockAdapter(NULL), _blockFrames(0), _hostFrames(0), _maxHostFrames(0)
 {
 	_lastErr[0] = '\0';
-	for (int n = 0; n < 32; ++n) {
+	outputSeedDither(_ditherState);
+	for (int n = 0; n < MAXBUS; ++n) {
 		_peaks[n] = 0.0;
 		_peakLocs[n] = 0;
 	}
@@ -50,6 +55,7 @@ AudioDeviceImpl::~AudioDeviceImpl()
 	PRINT0("AudioDeviceImpl::~AudioDeviceImpl()\n");
 	/* if this asserts, close() is not being called before destructor */
 	assert(_convertBuffer == NULL);
+	destroyBlockAdapter();
 	delete _runCallback;
 	delete _stopCallback;
 }
@@ -91,6 +97,8 @@ int AudioDeviceImpl::close()
 		if ((status = doClose()) == 0) {
 			PRINT0("AudioDeviceImpl::close: now calling destroyConvertBuffer()\n");
 			destroyConvertBuffer();
+			destroyBlockAdapter();
+			_blockFrames = _hostFrames = _maxHostFrames = 0;
 			setState(Closed);
 			_frameFormat = MUS_UNSUPPORTED;
 			_frameChannels = 0;
@@ -177,11 +185,17 @@ int AudioDeviceImpl::getFrames(void *frameBuffer, int frameCount)
 		// XXX this is a hack to avoid an extra buffer copy.
 		if (_frameFormat == _deviceFormat) {
 			PRINT1("getFrames: skipping conversion after doGetFrames (formats identical)\n");
-			doGetFrames(frameBuffer, frameCount);
+			if (_blockAdapter)
+				_blockAdapter->readBlock(frameBuffer, frameCount);
+			else
+				doGetFrames(frameBuffer, frameCount);
 		}
 		else {
 			PRINT1("getFrames: running conversion after doGetFrames\n");
-			doGetFrames(_convertBuffer, frameCount);
+			if (_blockAdapter)
+				_blockAdapter->readBlock(_convertBuffer, frameCount);
+			else
+				doGetFrames(_convertBuffer, frameCount);
 			convertFrame(_convertBuffer, frameBuffer, frameCount, true);
 		}
 	}
@@ -196,13 +210,25 @@ int AudioDeviceImpl::sendFrames(void *frameBuffer, int frameCount)
 	if (isPlaying()) {
 		// Clip if converting from non-clipped to clipped.
 		bool doClipping = !isFrameFmtClipped() && isPlaybackDeviceFmtClipped();
-		limitFrame(frameBuffer, frameCount,
-				   doClipping, checkPeaks(), reportClipping());
-		void *sendBuffer = convertFrame(frameBuffer,
-										_convertBuffer, 
-										frameCount, 
-										false);
-		status = doSendFrames(sendBuffer, frameCount);
+		void *sendBuffer;
+		if (_playOutputFormat != MUS_UNKNOWN) {
+			sendBuffer = outputFrame(frameBuffer, _convertBuffer, frameCount,
+									 doClipping, checkPeaks(), reportClipping());
+		}
+		else {
+			limitFrame(frameBuffer, frameCount,
+					   doClipping, checkPeaks(), reportClipping());
+			sendBuffer = convertFrame(frameBuffer,
+									  _convertBuffer, 
+									  frameCount, 
+									  false);
+		}
+		if (_blockAdapter) {
+			_blockAdapter->writeBlock(sendBuffer, frameCount);
+			status = frameCount;
+		}
+		else
+			status = doSendFrames(sendBuffer, frameCount);
 	}
 	else
 		status = error("Not in playback mode");
@@ -426,7 +452,11 @@ int AudioDeviceImpl::setQueueSize(int *pWriteSize, int *pCount)
 		*pWriteSize = reqWriteSize;
 		*pCount = reqCount;
 		_maxFrames = reqWriteSize * reqCount;
-		return setupConversion(isRecording(), isPlaying());
+		_blockFrames = reqWriteSize;
+		int status = setupConversion(isRecording(), isPlaying());
+		if (status == 0)
+			status = configureBlockAdapter();
+		return status;
 	}
 	*pWriteSize = -1;	// error condition
 	return AUDIO_ERROR;
@@ -460,6 +490,8 @@ int AudioDeviceImpl::setupConversion(bool recording, bool playing)
 		PRINT0("\tplayback device chans: %d\n", deviceChannels);
 	}
 			
+	_playOutputFormat = MUS_UNKNOWN;
+
 	// Create conversion routines if 1) frame format differs from device or 2) channel counts differ
 	if (_frameFormat != _deviceFormat || getFrameChannels() != deviceChannels)
 	{
@@ -474,6 +506,99 @@ int AudioDeviceImpl::setupConversion(bool recording, bool playing)
 	return status;
 }
 
+// The block adapter is only needed when a host-driven device's period may
+// differ from RTcmix's buffer size; otherwise runHostPeriod() just runs the
+// callback, as before.  Once made, the adapter stays, so that a change of
+// period never drops the audio queued in it.
+
+int AudioDeviceImpl::configureBlockAdapter()
+{
+	if (_hostFrames <= 0 || _blockFrames <= 0)
+		return 0;
+	if (_blockAdapter == NULL && _hostFrames == _blockFrames && _maxHostFrames == _blockFrames)
+		return 0;
+	PRINT0("AudioDeviceImpl::configureBlockAdapter: %d-frame buffers, %d-frame host periods (up to %d)\n",
+		   _blockFrames, _hostFrames, _maxHostFrames);
+	if (_blockAdapter == NULL) {
+		try {
+			_blockAdapter = new BlockAdapter(mus_data_format_to_bytes_per_sample(getDeviceFormat()),
+											 isRecording() ? getRecordDeviceChannels() : 0,
+											 isPlaying() ? getPlaybackDeviceChannels() : 0,
+											 isDeviceInterleaved());
+		}
+		catch (...) {
+			return error("Block adapter: memory allocation failure");
+		}
+	}
+	if (_blockAdapter->configure(_blockFrames, _maxHostFrames) != 0) {
+		destroyBlockAdapter();
+		return error("Block adapter: memory allocation failure");
+	}
+	_blockAdapter->setHostFrames(_hostFrames);
+	return 0;
+}
+
+void AudioDeviceImpl::destroyBlockAdapter()
+{
+	delete _blockAdapter;
+	_blockAdapter = NULL;
+}
+
+int AudioDeviceImpl::setHostPeriod(int frames, int maxFrames)
+{
+	if (frames <= 0)
+		return error("Invalid host buffer size");
+	_hostFrames = frames;
+	_maxHostFrames = max(max(frames, maxFrames), _maxHostFrames);
+	return configureBlockAdapter();
+}
+
+int AudioDeviceImpl::maxHostPeriod() const
+{
+	return _blockAdapter ? _blockAdapter->maxHostFrames() : _hostFrames;
+}
+
+// Reads the host's input for this period, runs the callback until there is
+// a period's worth of output (or, when only recording, until the input is
+// used up), and hands the host that output.  This runs in the host's audio
+// callback, so a new period is only taken up if the adapter already has
+// room for it.
+
+bool AudioDeviceImpl::runHostPeriod(int frames)
+{
+	if (frames != _hostFrames) {
+		if (_blockAdapter == NULL || frames > _blockAdapter->maxHostFrames()) {
+			error("Host period is longer than the audio device was set up for");
+			return false;
+		}
+		_hostFrames = frames;
+		_blockAdapter->setHostFrames(frames);
+	}
+	if (_blockAdapter == NULL)
+		return runCallback();
+
+	if (isRecording()) {
+		doGetFrames(_blockAdapter->hostInput(), frames);
+		_blockAdapter->pushInput(frames);
+	}
+	bool keepGoing = true;
+	if (isPlaying()) {
+		while (keepGoing && _blockAdapter->outputFrames() < frames) {
+			const int before = _blockAdapter->outputFrames();
+			keepGoing = runCallback();
+			if (_blockAdapter->outputFrames() == before)
+				break;		// callback sent nothing
+		}
+		_blockAdapter->pullOutput(frames);
+		doSendFrames(_blockAdapter->hostOutput(), frames);
+	}
+	else {
+		while (keepGoing && _blockAdapter->inputFrames() >= _blockFrames)
+			keepGoing = runCallback();
+	}
+	return keepGoing;
+}
+
 // This is used by specialized derived classes that need to change formats
 // in mid-stream.
 
@@ -565,7 +690,18 @@ AudioDeviceImpl::limitFrame(void *frameBuffer, int frames, bool doClip, bool che
 			}
 		}
 	}
-	if (frameMuting && clipmax >= _muteThreshold) {
+	reportLimiting(frameBuffer, frames, numclipped, clipmax, reportClipping);
+}
+
+// Mutes the frames if any sample exceeded the mute threshold, or else reports
+// clipping, for limitFrame() and outputFrame().  Returns true if it muted.
+
+bool
+AudioDeviceImpl::reportLimiting(void *frameBuffer, int frames, int numclipped, float clipmax, bool reportClipping)
+{
+	const int chans = getFrameChannels();
+	const long bufStartSamp = getFrameCount();
+	if (_muteThreshold > 0.0 && clipmax >= _muteThreshold) {
 		if (reportClipping) {
 			float loc1 = bufStartSamp / getSamplingRate();
 			float loc2 = loc1 + (frames / getSamplingRate());
@@ -581,6 +717,7 @@ AudioDeviceImpl::limitFrame(void *frameBuffer, int frames, bool doClip, bool che
 				memset(fp, 0, frames * sizeof(float));
 			}
 		}
+		return true;
 	}
 	else if (numclipped && reportClipping) {
 		float loc1 = bufStartSamp / getSamplingRate();
@@ -591,6 +728,58 @@ AudioDeviceImpl::limitFrame(void *frameBuffer, int frames, bool doClip, bool che
     		  "%sCLIPPING: %4d samps, max: %6.1f (%5.2f dBFS), time range: %.4f - %.4f\n",
     		  (printing_dots? "\n" : ""), numclipped, clipmax, 20.0 * log10(fabs(clipmax) / 32768.0), loc1, loc2);
 	}
+	return false;
+}
+
+// The single-pass version of limitFrame() and convertFrame(), for the
+// device formats in OutputKernels.h.  Returns the device buffer.
+
+void *
+AudioDeviceImpl::outputFrame(void *frameBuffer, void *outBuffer, int frames,
+							 bool doClip, bool checkPeaks, bool reportClipping)
+{
+	const int chans = getFrameChannels();
+	const int devChans = getPlaybackDeviceChannels();
+	const bool interleaved = isFrameInterleaved();
+	unsigned char *out = (unsigned char *) outBuffer;
+	assert(out != NULL);
+
+	OutputParams params;
+	params.clip = doClip || _muteThreshold > 0.0;
+	params.checkPeaks = checkPeaks;
+	params.dither = dither();
+	params.floatScale = isPlaybackDeviceFmtNormalized() ? kNormalizer : 1.0f;
+	params.startFrame = getFrameCount();
+	OutputClipStats stats = { 0, 0.0f };
+	const int bytesPerSamp = mus_data_format_to_bytes_per_sample(_playOutputFormat);
+
+	PRINT1("AudioDeviceImpl::outputFrame: clip = %d check = %d dither = %d\n",
+		   params.clip, checkPeaks, params.dither);
+	for (int c = 0; c < chans; ++c) {
+		float *fp = interleaved ? &((float *) frameBuffer)[c] : ((float **) frameBuffer)[c];
+		const int incr = interleaved ? chans : 1;
+		unsigned char *cp = (c < devChans) ? &out[c * bytesPerSamp] : NULL;
+		switch (_playOutputFormat) {
+		case OutputShort:
+			outputChannel<OutputShort>(fp, incr, cp, devChans, frames, params,
+									   _ditherState, &_peaks[c], &_peakLocs[c], &stats);
+			break;
+		case Output24Bit:
+			outputChannel<Output24Bit>(fp, incr, cp, devChans, frames, params,
+									   _ditherState, &_peaks[c], &_peakLocs[c], &stats);
+			break;
+		case OutputFloat:
+			outputChannel<OutputFloat>(fp, incr, cp, devChans, frames, params,
+									   _ditherState, &_peaks[c], &_peakLocs[c], &stats);
+			break;
+		}
+	}
+	for (int c = chans; c < devChans; ++c)
+		outputSilence(&out[c * bytesPerSamp], devChans, bytesPerSamp, frames);
+
+	if (reportLimiting(frameBuffer, frames, stats.numClipped, stats.clipMax, reportClipping))
+		memset(out, 0, frames * devChans * bytesPerSamp);
+	return outBuffer;
 }
 
 static const float kFloatNormalizer = (1.0 / 32768.0);
@@ -773,11 +962,11 @@ int AudioDeviceImpl::setConvertFunctions(int rawFrameFormat,
 				break;
 
 			case MUS_B24INT:	// float frame, BE 24bit file.  HW record not supported
-				_playConvertFunction = _convertIToIL24Bit<float>;
+				_playConvertFunction = _convertIToIB24Bit<float>;
 				break;
 
-			case MUS_L24INT:	// float frame, BE 24bit file.  HW record not supported
-				_playConvertFunction = _convertIToIB24Bit<float>;
+			case MUS_L24INT:	// float frame, LE 24bit file.  HW record not supported
+				_playConvertFunction = _convertIToIL24Bit<float>;
 				break;
 
 			case MUS_LSHORT:	// float frame, LE short device
@@ -884,7 +1073,7 @@ int AudioDeviceImpl::setConvertFunctions(int rawFrameFormat,
 				_playConvertFunction = _convertNFloatToIB24Bit;
 				break;
 
-			case MUS_L24INT:	// float frame, BE 24bit file.  HW record not supported
+			case MUS_L24INT:	// float frame, LE 24bit file.  HW record not supported
 				_playConvertFunction = _convertNFloatToIL24Bit;
 				break;
 
@@ -969,6 +1158,20 @@ int AudioDeviceImpl::setConvertFunctions(int rawFrameFormat,
 		}	// !deviceInterleaved
 	}	// !frameInterleaved
 	
+	// Full-range float frames going to the common interleaved little-endian
+	// formats take the single pass in outputFrame() instead.
+	if (deviceInterleaved && !frameNormalized && _playConvertFunction != NULL) {
+		switch (MUS_GET_FORMAT(rawDeviceFormat)) {
+		case MUS_LSHORT:
+		case MUS_L24INT:
+		case MUS_LFLOAT:
+			_playOutputFormat = MUS_GET_FORMAT(rawDeviceFormat);
+			break;
+		default:
+			break;
+		}
+	}
+
 	if (isPlaying() && _playConvertFunction == NULL)
 		return error("This format conversion is currently not supported!");
 	if (isRecording() && _recConvertFunction == NULL)
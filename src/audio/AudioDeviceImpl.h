@@ -4,10 +4,14 @@
 #define _RT_AUDIODEVICEIMPL_H_
 
 #include <sndlibsupport.h>	// RTcmix header
+#include <bus.h>			// for MAXBUS
+#include <stdint.h>
 #include "AudioDevice.h"
 
 typedef void (*ConversionFunction)(void *, void*, int, int, int);
 
+class BlockAdapter;
+
 class AudioDeviceImpl : public AudioDevice {
 public:
 	// Redefined from AudioDevice
@@ -93,6 +97,7 @@ protected:
 	inline bool		isPassive() const;	// False if we don't run our own thread.
 	inline bool		checkPeaks() const;
 	inline bool		reportClipping() const;
+	inline bool		dither() const;
 	int				getDeviceBytesPerFrame() const;
 	inline void		setMode(int m);
 	inline void		setState(State s);
@@ -100,7 +105,18 @@ protected:
 	inline State	getState() const;
 	void			*convertFrame(void *inFrame, void *outFrame, int frames, bool rec);
 	void			limitFrame(void *frame, int frames, bool doClip, bool checkPeaks, bool reportClip);
+	void			*outputFrame(void *inFrame, void *outFrame, int frames, bool doClip, bool checkPeaks, bool reportClip);
 	int				error(const char *msg, const char *msg2=0);
+	// For devices driven by a host callback whose period may differ from,
+	// or change independently of, the frame count given to setQueueSize().
+	// Call setHostPeriod() outside the host callback whenever the host's
+	// period is known or changes, with the longest period the host may
+	// switch to without warning, and runHostPeriod() from the host callback
+	// instead of runCallback().  runHostPeriod() allocates nothing, so it
+	// fails for a period longer than maxHostPeriod().
+	int				setHostPeriod(int frames, int maxFrames=0);
+	int				maxHostPeriod() const;
+	bool			runHostPeriod(int frames);
 
 private:
 	int				setupConversion(bool recording, bool playing);
@@ -111,10 +127,13 @@ private:
 	void 			destroyNoninterleavedBuffer(int fmt, int chans);
 	int				createConvertBuffer(int frames, int chans);
 	void			destroyConvertBuffer();
+	bool			reportLimiting(void *frame, int frames, int numClipped, float clipMax, bool reportClip);
+	int				configureBlockAdapter();
+	void			destroyBlockAdapter();
 
 protected:
-	float				_peaks[32];
-	long				_peakLocs[32];
+	float				_peaks[MAXBUS];
+	long				_peakLocs[MAXBUS];
 
 private:	
 	int					_mode;		// Playback, Record, etc.
@@ -130,7 +149,13 @@ private:
 	void				*_convertBuffer;
 	ConversionFunction	_recConvertFunction;
 	ConversionFunction	_playConvertFunction;
+	int					_playOutputFormat;	// device format, if outputFrame() handles it
+	uint32_t			_ditherState[4];
 	double				_muteThreshold;
+	BlockAdapter		*_blockAdapter;
+	int					_blockFrames;	// RTcmix's buffer size
+	int					_hostFrames;	// host period, if host-driven
+	int					_maxHostFrames;	// longest host period set up for
 	enum { ErrLength = 128 };
 	char				_lastErr[ErrLength];
 };
@@ -149,6 +174,8 @@ inline bool AudioDeviceImpl::checkPeaks() const { return (_mode & CheckPeaks) !=
 
 inline bool AudioDeviceImpl::reportClipping() const { return (_mode & ReportClipping) != 0; }
 
+inline bool AudioDeviceImpl::dither() const { return (_mode & Dither) != 0; }
+
 inline AudioDevice::State AudioDeviceImpl::getState() const { return _state; }
 
 inline bool AudioDeviceImpl::isOpen() const { return _state >= Open; }
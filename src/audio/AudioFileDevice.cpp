@@ -8,9 +8,14 @@
 #include <math.h>       /* for fabs */
 #include "AudioFileDevice.h"
 #include <byte_routines.h>
+#include <RTSemaphore.h>
+#include <WorkerThread.h>
+#include <ugens.h>
 #include <assert.h>
 #include <errno.h>
 #include <string.h>
+#include <pthread.h>
+#include <atomic>
 #if defined(LINUX) || defined(MACOSX)
 #include <unistd.h>
 #endif
@@ -28,9 +33,209 @@
 #define PRINT1 if (0) printf
 #endif
 
+// The Writer moves ::write() off the render thread.  sendFrames() copies each
+// converted buffer into a slot of a single-producer, single-consumer ring,
+// and a normal-priority thread writes the slots to disk in order.  When
+// rendering offline, a slot holds a superblock of several buffers, so the
+// writer wakes up and calls ::write() less often.
+
+class AudioFileDevice::Writer {
+public:
+	Writer(int fd, int slotCount, long slotBytes, bool dropOnOverflow);
+	~Writer();
+	// Render thread.  Returns the number of bytes queued, which is less than
+	// <bytes> only if the queue was full and we are dropping.
+	long	queue(const char *buffer, long bytes);
+	int		error() const { return _error.load(std::memory_order_acquire); }
+	// Wait for everything queued to reach the disk, and stop the thread.
+	void	finish();
+	void	reportStats(const char *path, int bytesPerFrame);
+private:
+	void	publish();
+	void	releaseSlots();
+	struct Slot {
+		long	bytes;
+		double	queueTime;
+		char	*data;
+	};
+	static void *	sRun(void *);
+	void			run();
+
+	int							_fd;
+	int							_slotCount;
+	long						_slotBytes;
+	bool						_dropOnOverflow;
+	Slot						*_slots;
+	long						_fill;		// bytes in the slot being filled
+	std::atomic<long>			_head;		// slots queued (producer)
+	std::atomic<long>			_tail;		// slots written (consumer)
+	std::atomic<bool>			_done;
+	std::atomic<int>			_error;		// errno of a failed write
+	RTSemaphore					_dataReady;
+	RTSemaphore					_spaceReady;
+	pthread_t					_thread;
+	bool						_running;
+	// Stats, for the report at close.
+	double						_maxLatency;
+	long						_droppedBuffers;
+	long						_droppedBytes;
+	long						_blockedCount;
+};
+
+AudioFileDevice::Writer::Writer(int fd, int slotCount, long slotBytes, bool dropOnOverflow)
+	: _fd(fd), _slotCount(slotCount), _slotBytes(slotBytes), _dropOnOverflow(dropOnOverflow),
+	  _slots(new Slot[slotCount]), _fill(0), _head(0), _tail(0), _done(false), _error(0), _running(false),
+	  _maxLatency(0.0), _droppedBuffers(0), _droppedBytes(0), _blockedCount(0)
+{
+	// The destructor does not run if we throw, so we clean up here.
+	for (int n = 0; n < _slotCount; ++n) {
+		_slots[n].bytes = 0;
+		_slots[n].data = NULL;
+	}
+	try {
+		for (int n = 0; n < _slotCount; ++n)
+			_slots[n].data = new char[_slotBytes];
+	}
+	catch (...) {
+		releaseSlots();
+		throw;
+	}
+	_running = (createWorkerThread(&_thread, sRun, this) == 0);
+	if (!_running) {
+		releaseSlots();
+		throw -1;
+	}
+}
+
+AudioFileDevice::Writer::~Writer()
+{
+	finish();
+	releaseSlots();
+}
+
+void AudioFileDevice::Writer::releaseSlots()
+{
+	for (int n = 0; n < _slotCount; ++n)
+		delete [] _slots[n].data;
+	delete [] _slots;
+	_slots = NULL;
+}
+
+long AudioFileDevice::Writer::queue(const char *buffer, long bytes)
+{
+	long queued = 0;
+	while (queued < bytes) {
+		const long head = _head.load(std::memory_order_relaxed);
+		Slot &slot = _slots[head % _slotCount];
+		if (_fill == 0) {
+			if (head - _tail.load(std::memory_order_acquire) == _slotCount) {
+				if (_dropOnOverflow) {
+					++_droppedBuffers;
+					_droppedBytes += bytes - queued;
+					break;
+				}
+				++_blockedCount;
+				while (head - _tail.load(std::memory_order_acquire) == _slotCount)
+					_spaceReady.wait();
+			}
+			slot.queueTime = monotonicTime();
+		}
+		const long count = (bytes - queued < _slotBytes - _fill) ? bytes - queued : _slotBytes - _fill;
+		memcpy(slot.data + _fill, buffer + queued, count);
+		_fill += count;
+		queued += count;
+		if (_fill == _slotBytes)
+			publish();
+	}
+	return queued;
+}
+
+void AudioFileDevice::Writer::publish()
+{
+	const long head = _head.load(std::memory_order_relaxed);
+	_slots[head % _slotCount].bytes = _fill;
+	_fill = 0;
+	_head.store(head + 1, std::memory_order_release);
+	_dataReady.post();
+}
+
+void AudioFileDevice::Writer::finish()
+{
+	if (_running) {
+		if (_fill > 0)
+			publish();		// the last, partial superblock
+		_done.store(true, std::memory_order_release);
+		_dataReady.post();
+		pthread_join(_thread, NULL);
+		_running = false;
+	}
+}
+
+void *AudioFileDevice::Writer::sRun(void *context)
+{
+	((Writer *) context)->run();
+	return NULL;
+}
+
+void AudioFileDevice::Writer::run()
+{
+	for (;;) {
+		_dataReady.wait();
+		long tail = _tail.load(std::memory_order_relaxed);
+		while (tail < _head.load(std::memory_order_acquire)) {
+			Slot &slot = _slots[tail % _slotCount];
+			if (_error.load(std::memory_order_relaxed) == 0) {
+				long bytesWritten = ::write(_fd, slot.data, slot.bytes);
+				if (bytesWritten < 0)
+					_error.store(errno ? errno : EIO, std::memory_order_release);
+				else if (bytesWritten < slot.bytes)
+					_error.store(ENOSPC, std::memory_order_release);
+			}
+			const double latency = monotonicTime() - slot.queueTime;
+			if (latency > _maxLatency)
+				_maxLatency = latency;
+			_tail.store(++tail, std::memory_order_release);
+			_spaceReady.post();
+		}
+		if (_done.load(std::memory_order_acquire) && tail == _head.load(std::memory_order_acquire))
+			break;
+	}
+}
+
+// Called after finish(), so the stats are no longer changing.
+
+void AudioFileDevice::Writer::reportStats(const char *path, int bytesPerFrame)
+{
+	rtcmix_advise("AudioFileDevice", "Maximum write latency for \"%s\": %.1f ms (queue of %d x %ld frames)",
+				  path, _maxLatency * 1000.0, _slotCount, _slotBytes / bytesPerFrame);
+	if (_blockedCount > 0)
+		rtcmix_advise("AudioFileDevice", "Waited for the file writer %ld times", _blockedCount);
+	if (_droppedBuffers > 0)
+		rtcmix_warn("AudioFileDevice", "Dropped %ld frames in %ld buffers writing \"%s\": disk too slow",
+					_droppedBytes / bytesPerFrame, _droppedBuffers, path);
+	if (error() != 0)
+		rtcmix_warn("AudioFileDevice", "Error writing \"%s\": %s", path, ::strerror(error()));
+}
+
 struct AudioFileDevice::Impl {
+	Impl() : path(NULL), fileType(0), writeQueueDepth(0), dropOnOverflow(false), writer(NULL),
+			 stopRequested(false) {
+		pthread_mutex_init(&pauseLock, NULL);
+		pthread_cond_init(&pauseChanged, NULL);
+	}
+	~Impl() {
+		pthread_cond_destroy(&pauseChanged);
+		pthread_mutex_destroy(&pauseLock);
+	}
 	char						*path;
 	int							fileType;		// wave, aiff, etc.
+	int							writeQueueDepth;
+	bool						dropOnOverflow;
+	Writer						*writer;
+	// run() sleeps on pauseChanged while we are paused.
+	pthread_mutex_t				pauseLock;
+	pthread_cond_t				pauseChanged;
+	std::atomic<bool>			stopRequested;
 };
 
 AudioFileDevice::AudioFileDevice(const char *path,
@@ -42,6 +247,12 @@ AudioFileDevice::AudioFileDevice(const char *path,
 	_impl->fileType = fileType;
 }
 
+void AudioFileDevice::setWriteQueue(int depth, bool dropOnOverflow)
+{
+	_impl->writeQueueDepth = depth;
+	_impl->dropOnOverflow = dropOnOverflow;
+}
+
 AudioFileDevice::~AudioFileDevice()
 {
 	PRINT1("AudioFileDevice::~AudioFileDevice\n");
@@ -102,6 +313,12 @@ int AudioFileDevice::doClose()
 	int status = 0;
 	if (!closing()) {
 		closing(true);
+		if (_impl->writer) {
+			_impl->writer->finish();	// everything queued must precede the header update
+			_impl->writer->reportStats(_impl->path, getDeviceBytesPerFrame());
+			delete _impl->writer;
+			_impl->writer = NULL;
+		}
 		if (checkPeaks()) {
 			// Normalize peaks if file was normalized.
 			if (isDeviceFmtNormalized())
@@ -126,22 +343,68 @@ int AudioFileDevice::doClose()
 int AudioFileDevice::doStart()
 {
 //	printf("AudioFileDevice::doStart: starting thread\n");
+	_impl->stopRequested = false;
 	return ThreadedAudioDevice::startThread();
 }
 
 int AudioFileDevice::doPause(bool paused)
 {
+	pthread_mutex_lock(&_impl->pauseLock);
 	this->paused(paused);
+	pthread_cond_broadcast(&_impl->pauseChanged);
+	pthread_mutex_unlock(&_impl->pauseLock);
 	return 0;
 }
 
+// Wake run() if it is waiting out a pause, so that its thread can be joined.
+
+int AudioFileDevice::doStop()
+{
+	pthread_mutex_lock(&_impl->pauseLock);
+	_impl->stopRequested = true;
+	pthread_cond_broadcast(&_impl->pauseChanged);
+	pthread_mutex_unlock(&_impl->pauseLock);
+	return ThreadedAudioDevice::doStop();
+}
+
+// Returns false if we were stopped instead of resumed.
+
+bool AudioFileDevice::waitWhilePaused()
+{
+	pthread_mutex_lock(&_impl->pauseLock);
+	while (paused() && !_impl->stopRequested)
+		pthread_cond_wait(&_impl->pauseChanged, &_impl->pauseLock);
+	const bool resumed = !_impl->stopRequested;
+	pthread_mutex_unlock(&_impl->pauseLock);
+	return resumed;
+}
+
 int AudioFileDevice::doSetFormat(int sampfmt, int chans, double srate)
 {
 	return 0;
 }
 
+// Our "queue" is the writer's ring:  one slot per buffer of *pWriteSize frames
+// when paired with a hardware device, or one superblock of several buffers
+// when we are rendering offline (i.e., running our own thread).  Offline, there
+// is no deadline, so we always wait for the writer rather than drop.
+
+static const int kOfflineBuffersPerSlot = 16;
+
 int AudioFileDevice::doSetQueueSize(int *pWriteSize, int *pCount)
 {
+	if (_impl->writeQueueDepth > 0 && _impl->writer == NULL) {
+		const bool offline = !isPassive();
+		const int buffersPerSlot = offline ? kOfflineBuffersPerSlot : 1;
+		try {
+			_impl->writer = new Writer(device(), _impl->writeQueueDepth,
+									   (long) buffersPerSlot * *pWriteSize * getDeviceBytesPerFrame(),
+									   offline ? false : _impl->dropOnOverflow);
+		}
+		catch (...) {
+			return error("Unable to start file writer thread");
+		}
+	}
 	return 0;
 }
 
@@ -158,6 +421,14 @@ int AudioFileDevice::doGetFrames(void *frameBuffer, int frameCount)
 int	AudioFileDevice::doSendFrames(void *frameBuffer, int frames)
 {
 	long bytesToWrite = frames * getDeviceBytesPerFrame();
+	if (_impl->writer) {
+		if (_impl->writer->error() != 0)
+			return error("Error writing to file: ", ::strerror(_impl->writer->error()));
+		long bytesQueued = _impl->writer->queue((const char *) frameBuffer, bytesToWrite);
+		// Dropped frames are not counted, so the header stays correct.
+		incrementFrameCount(bytesQueued / getDeviceBytesPerFrame());
+		return frames;
+	}
 	long bytesWritten = ::write(device(), frameBuffer, bytesToWrite);
 	if (bytesWritten < 0) {
 		return error("Error writing to file.");
@@ -175,11 +446,8 @@ void AudioFileDevice::run()
 	assert(!isPassive());	// Cannot call this method when passive!
 	
 	while (!stopping()) {
-		while (paused()) {
-#ifdef linux
-			::usleep(1000);
-#endif
-		}
+		if (!waitWhilePaused())
+			break;
 		if (runCallback() != true) {
 //			printf("AudioFileDevice::run: callback returned false\n");
 			break;
@@ -189,7 +457,7 @@ void AudioFileDevice::run()
 	// call to close() does not attempt to call stop, which we cannot do in
 	// this thread.  Then, check to see if we are being closed by the main
 	// thread before calling close() here, to avoid a reentrant call.
-	if (!stopping()) {
+	if (!stopping() && !_impl->stopRequested) {
 		setState(Configured);
 		if (!closing()) {
 			PRINT1("AudioFileDevice::run: calling close()\n");
@@ -12,6 +12,10 @@ public:
 
 	// AudioDeviceImpl overrides.
 	virtual int open(int mode, int sampfmt, int chans, double srate);
+	// Queue up to <depth> buffers for a background writer thread (0 means
+	// write synchronously).  When the queue is full, either wait or drop the
+	// buffer and report it at close.  Call before setQueueSize().
+	void setWriteQueue(int depth, bool dropOnOverflow);
 
 protected:
     // ThreadedAudioDevice redefine.
@@ -21,12 +25,15 @@ protected:
 	virtual int doClose();
 	virtual int doStart();
 	virtual int doPause(bool);
+	virtual int doStop();
 	virtual int doSetFormat(int sampfmt, int chans, double srate);
 	virtual int doSetQueueSize(int *pWriteSize, int *pCount);
 	virtual int doGetFrameCount() const;
 	virtual int doGetFrames(void *frameBuffer, int frameCount);
 	virtual	int	doSendFrames(void *frameBuffer, int frameCount);
 private:
+	bool	waitWhilePaused();
+	class Writer;
 	struct Impl;
 	Impl	*_impl;
 };
@@ -0,0 +1,219 @@
+// BlockAdapter.cpp -- FIFOs between a host's audio periods and RTcmix's buffers
+
+#include "BlockAdapter.h"
+#include <string.h>
+#include <assert.h>
+
+// A device buffer is either the frames themselves, or an array of pointers
+// to each channel's samples.
+
+static inline char *lanePointer(const void *buf, int lane, bool interleaved)
+{
+	return interleaved ? (char *) buf : ((char **) buf)[lane];
+}
+
+// Replaces the ring and period buffer with ones of the new sizes, moving
+// across whatever frames are queued (the newest, if they no longer fit).
+// Returns -1, leaving the old ones in place, if out of memory.
+
+int BlockAdapter::Fifo::allocate(int inLanes, int inLaneBytes, int inCapacity,
+								 int periodFrames, bool interleaved)
+{
+	Fifo fresh;
+	fresh.lanes = inLanes;
+	fresh.laneBytes = inLaneBytes;
+	fresh.capacity = inCapacity;
+	try {
+		// Zeroed pointer arrays, so that release() can clean up after a throw.
+		fresh.ring = new char *[fresh.lanes]();
+		for (int n = 0; n < fresh.lanes; ++n)
+			fresh.ring[n] = new char[fresh.capacity * fresh.laneBytes];
+		if (interleaved)
+			fresh.period = new char[periodFrames * fresh.laneBytes]();
+		else {
+			char **chans = new char *[fresh.lanes]();
+			fresh.period = chans;
+			for (int n = 0; n < fresh.lanes; ++n)
+				chans[n] = new char[periodFrames * fresh.laneBytes]();
+		}
+	}
+	catch (...) {
+		fresh.release(interleaved);
+		return -1;
+	}
+	if (ring != NULL && lanes == fresh.lanes && laneBytes == fresh.laneBytes) {
+		if (count > fresh.capacity) {
+			readPos = (readPos + count - fresh.capacity) % capacity;
+			count = fresh.capacity;
+		}
+		fresh.count = count;
+		// The ring is always an array of lanes, whatever the device's format.
+		read(fresh.ring, fresh.count, false);
+	}
+	release(interleaved);
+	*this = fresh;
+	fresh.ring = NULL;
+	fresh.period = NULL;
+	return 0;
+}
+
+void BlockAdapter::Fifo::release(bool interleaved)
+{
+	if (ring) {
+		for (int n = 0; n < lanes; ++n)
+			delete [] ring[n];
+		delete [] ring;
+		ring = NULL;
+	}
+	if (period) {
+		if (!interleaved) {
+			char **chans = (char **) period;
+			for (int n = 0; n < lanes; ++n)
+				delete [] chans[n];
+			delete [] chans;
+		}
+		else
+			delete [] (char *) period;
+		period = NULL;
+	}
+	lanes = laneBytes = capacity = readPos = count = 0;
+}
+
+// Puts <frames> of silence ahead of what is queued.
+
+void BlockAdapter::Fifo::prime(int frames)
+{
+	if (frames > capacity - count)
+		frames = capacity - count;
+	readPos = (readPos + capacity - frames) % capacity;
+	count += frames;
+	int pos = readPos;
+	while (frames > 0) {
+		const int span = (capacity - pos < frames) ? capacity - pos : frames;
+		for (int n = 0; n < lanes; ++n)
+			memset(&ring[n][pos * laneBytes], 0, span * laneBytes);
+		frames -= span;
+		pos = (pos + span) % capacity;
+	}
+}
+
+// Writes that would overrun the ring drop the oldest frames, which can only
+// happen if the engine and host disagree about the sizes.
+
+void BlockAdapter::Fifo::write(const void *src, int frames, bool interleaved)
+{
+	if (frames > capacity - count) {
+		const int excess = frames - (capacity - count);
+		readPos = (readPos + excess) % capacity;
+		count -= excess;
+	}
+	int writePos = (readPos + count) % capacity;
+	int done = 0;
+	while (done < frames) {
+		const int span = (capacity - writePos < frames - done) ? capacity - writePos : frames - done;
+		for (int n = 0; n < lanes; ++n)
+			memcpy(&ring[n][writePos * laneBytes],
+				   lanePointer(src, n, interleaved) + done * laneBytes,
+				   span * laneBytes);
+		done += span;
+		writePos = (writePos + span) % capacity;
+	}
+	count += frames;
+}
+
+void BlockAdapter::Fifo::read(void *dest, int frames, bool interleaved)
+{
+	const int avail = (frames < count) ? frames : count;
+	int done = 0;
+	while (done < avail) {
+		const int span = (capacity - readPos < avail - done) ? capacity - readPos : avail - done;
+		for (int n = 0; n < lanes; ++n)
+			memcpy(lanePointer(dest, n, interleaved) + done * laneBytes,
+				   &ring[n][readPos * laneBytes],
+				   span * laneBytes);
+		done += span;
+		readPos = (readPos + span) % capacity;
+	}
+	count -= avail;
+	// Zero is silence in every device format.
+	if (avail < frames)
+		for (int n = 0; n < lanes; ++n)
+			memset(lanePointer(dest, n, interleaved) + avail * laneBytes, 0,
+				   (frames - avail) * laneBytes);
+}
+
+BlockAdapter::BlockAdapter(int sampleBytes, int inChans, int outChans, bool interleaved)
+	: _sampleBytes(sampleBytes), _inChans(inChans), _outChans(outChans),
+	  _interleaved(interleaved), _blockFrames(0), _hostFrames(0), _maxHostFrames(0)
+{
+}
+
+BlockAdapter::~BlockAdapter()
+{
+	_in.release(_interleaved);
+	_out.release(_interleaved);
+}
+
+// The rings hold twice a buffer and the longest period, which leaves room
+// for the priming and for one period arriving on top of what is queued.
+
+int BlockAdapter::configure(int blockFrames, int maxHostFrames)
+{
+	assert(blockFrames > 0 && maxHostFrames > 0);
+	if (blockFrames == _blockFrames && maxHostFrames <= _maxHostFrames)
+		return 0;
+	const int capacity = 2 * (blockFrames + maxHostFrames);
+	const int inLanes = _interleaved ? 1 : _inChans;
+	const int outLanes = _interleaved ? 1 : _outChans;
+	const int inBytes = _interleaved ? _sampleBytes * _inChans : _sampleBytes;
+	const int outBytes = _interleaved ? _sampleBytes * _outChans : _sampleBytes;
+	if (_inChans > 0 && _in.allocate(inLanes, inBytes, capacity, maxHostFrames, _interleaved) != 0)
+		return -1;
+	if (_outChans > 0 && _out.allocate(outLanes, outBytes, capacity, maxHostFrames, _interleaved) != 0)
+		return -1;
+	_blockFrames = blockFrames;
+	_maxHostFrames = maxHostFrames;
+	return 0;
+}
+
+// The input FIFO must hold a whole buffer each time the engine renders one.
+// If the period is a multiple of the buffer, each period's input is used up
+// exactly; if the buffer is a multiple of the period, the engine renders on
+// every (buffer / period)th period, after that many have arrived counting the
+// priming; otherwise one full buffer of priming is always enough.  When the
+// period changes, the input already queued counts toward the new priming.
+// The output side needs no priming, because the engine renders as the host
+// needs it.
+
+void BlockAdapter::setHostFrames(int hostFrames)
+{
+	assert(hostFrames > 0 && hostFrames <= _maxHostFrames);
+	_hostFrames = hostFrames;
+	if (_inChans > 0) {
+		const int prime = (hostFrames % _blockFrames == 0) ? 0
+						  : (_blockFrames % hostFrames == 0) ? _blockFrames - hostFrames
+						  : _blockFrames;
+		if (_in.count < prime)
+			_in.prime(prime - _in.count);
+	}
+}
+
+void BlockAdapter::pushInput(int frames)
+{
+	_in.write(_in.period, frames, _interleaved);
+}
+
+void BlockAdapter::pullOutput(int frames)
+{
+	_out.read(_out.period, frames, _interleaved);
+}
+
+void BlockAdapter::readBlock(void *dest, int frames)
+{
+	_in.read(dest, frames, _interleaved);
+}
+
+void BlockAdapter::writeBlock(const void *src, int frames)
+{
+	_out.write(src, frames, _interleaved);
+}
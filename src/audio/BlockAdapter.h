@@ -0,0 +1,70 @@
+// BlockAdapter.h -- FIFOs between a host's audio periods and RTcmix's buffers
+//
+// A device driven by a host callback (JACK, or an app through
+// RTcmix_runAudio) gets periods of whatever size the host likes, which may
+// be smaller or larger than RTcmix's buffer, and may change while running.
+// AudioDeviceImpl puts one of these between the device and the engine when
+// the two sizes differ:  each host period's input goes into one FIFO, the
+// engine renders as many buffers as it takes to fill the host period, and
+// its output comes out of the other.  Everything is in the device's format,
+// interleaved or not.  Nothing here allocates except configure(), which is
+// called outside the host callback and sizes everything for the longest
+// period the host may use.  Within that, setHostFrames() changes the period
+// from the host callback without dropping anything already queued.
+
+#ifndef _RT_BLOCKADAPTER_H_
+#define _RT_BLOCKADAPTER_H_
+
+#include <stddef.h>
+
+class BlockAdapter {
+public:
+	BlockAdapter(int sampleBytes, int inChans, int outChans, bool interleaved);
+	~BlockAdapter();
+	// Sets the engine's buffer size and the longest host period, keeping
+	// whatever is queued.  Call setHostFrames() after it.  Returns -1 if out
+	// of memory.
+	int		configure(int blockFrames, int maxHostFrames);
+	// Sets the host's period, no more than maxHostFrames(), and tops up the
+	// input FIFO's priming for it.
+	void	setHostFrames(int hostFrames);
+	int		blockFrames() const { return _blockFrames; }
+	int		hostFrames() const { return _hostFrames; }
+	int		maxHostFrames() const { return _maxHostFrames; }
+
+	// Host side.  These buffers hold one host period in the device format.
+	void	*hostInput() { return _in.period; }
+	void	*hostOutput() { return _out.period; }
+	void	pushInput(int frames);			// from hostInput()
+	void	pullOutput(int frames);			// into hostOutput()
+
+	// Engine side.  Reading more than is there pads with silence.
+	int		inputFrames() const { return _in.count; }
+	int		outputFrames() const { return _out.count; }
+	void	readBlock(void *dest, int frames);
+	void	writeBlock(const void *src, int frames);
+
+private:
+	// A ring of frames with one lane per channel, or a single lane of whole
+	// frames when interleaved, plus a buffer of one host period.
+	struct Fifo {
+		Fifo() : ring(NULL), period(NULL), lanes(0), laneBytes(0), capacity(0),
+				 readPos(0), count(0) {}
+		int		allocate(int lanes, int laneBytes, int capacity, int periodFrames, bool interleaved);
+		void	release(bool interleaved);
+		void	prime(int frames);
+		void	write(const void *src, int frames, bool interleaved);
+		void	read(void *dest, int frames, bool interleaved);
+		char	**ring;
+		void	*period;
+		int		lanes, laneBytes, capacity;
+		int		readPos, count;
+	};
+
+	Fifo	_in, _out;
+	int		_sampleBytes, _inChans, _outChans;
+	bool	_interleaved;
+	int		_blockFrames, _hostFrames, _maxHostFrames;
+};
+
+#endif	// _RT_BLOCKADAPTER_H_
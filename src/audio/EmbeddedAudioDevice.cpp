@@ -55,11 +55,26 @@ EmbeddedAudioDevice::~EmbeddedAudioDevice()
 	delete _impl;
 }
 
+// The app's frame count need not match RTcmix's buffer size, and may change
+// from call to call.  The adapter between them is set up in doSetQueueSize()
+// for counts up to kMaxAppFrames, or RTcmix's buffer size if that is more,
+// and longer calls are run in pieces of that size.
+
+static const int kMaxAppFrames = 4096;
+
 bool EmbeddedAudioDevice::run(void *inputFrameBuffer, void *outputFrameBuffer, int frameCount)
 {
-	_impl->inputAudio = inputFrameBuffer;
-	_impl->outputAudio = outputFrameBuffer;
-	return runCallback();
+	const int bytesPerFrame = _impl->sampleSize * _impl->audioChannels;
+	const int maxFrames = (maxHostPeriod() > 0) ? maxHostPeriod() : frameCount;
+	bool keepGoing = true;
+	for (int done = 0; keepGoing && done < frameCount; ) {
+		const int frames = (frameCount - done < maxFrames) ? frameCount - done : maxFrames;
+		_impl->inputAudio = inputFrameBuffer ? (char *) inputFrameBuffer + done * bytesPerFrame : NULL;
+		_impl->outputAudio = outputFrameBuffer ? (char *) outputFrameBuffer + done * bytesPerFrame : NULL;
+		keepGoing = runHostPeriod(frames);
+		done += frames;
+	}
+	return keepGoing;
 }
 
 int EmbeddedAudioDevice::doOpen(int mode)
@@ -163,7 +178,7 @@ int EmbeddedAudioDevice::doSetFormat(int sampfmt, int chans, double srate)
 
 int EmbeddedAudioDevice::doSetQueueSize(int *pWriteSize, int *pCount)
 {
-	return 0;
+	return setHostPeriod(*pWriteSize, kMaxAppFrames);
 }
 
 int EmbeddedAudioDevice::doGetFrameCount() const
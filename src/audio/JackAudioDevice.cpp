@@ -80,8 +80,10 @@ int JackAudioDevice::Impl::runProcess(jack_nframes_t nframes, void *object)
 		out[i] = (jack_default_audio_sample_t *)
 		                        jack_port_get_buffer(impl->outPorts[i], nframes);
 
-	// process sound, resulting in one call each to doGetFrames and doSendFrames
-	bool keepGoing = device->runCallback();
+	// process sound, resulting in one call each to doGetFrames and doSendFrames,
+	// which may be more or fewer calls to the callback if our buffer size is not
+	// JACK's.
+	bool keepGoing = device->runHostPeriod(nframes);
 	if (!keepGoing) {
 		PRINT0("runProcess: runCallback returned false; calling stopCallback\n");
 		device->stopCallback();
@@ -112,9 +114,10 @@ int JackAudioDevice::Impl::bufSizeChanged(jack_nframes_t nframes, void *object)
 	PRINT0("JackAudioDevice::Impl::bufSizeChanged()\n");
 	JackAudioDevice *device = (JackAudioDevice *) object;
 	int status = 0;
-	if (device->isRunning()) {
-		if (nframes != device->_impl->bufSize) {
-			device->error("JACK buffer size changed; we can't cope with this.");
+	if (nframes != device->_impl->bufSize) {
+		device->_impl->bufSize = nframes;
+		// JACK does not run the process callback while this one runs.
+		if (device->isOpen() && device->setHostPeriod(nframes) != 0) {
 			status = -1;
 			device->stopCallback();
 		}
@@ -318,7 +321,11 @@ int JackAudioDevice::doSetFormat(int sampfmt, int chans, double srate)
 
 int JackAudioDevice::doSetQueueSize(int *pWriteSize, int *pCount)
 {
-	*pWriteSize = _impl->bufSize = jack_get_buffer_size(_impl->client);
+	// Our buffer size need not match JACK's; AudioDeviceImpl adapts between
+	// them, and copes with JACK changing its size later.
+	_impl->bufSize = jack_get_buffer_size(_impl->client);
+	if (setHostPeriod(_impl->bufSize) != 0)
+		return -1;
 
 	// NB: We ignore pCount, pretending it's always 1.  We don't change it
 	// to 1 for the caller, though, because this would screw up caller's
@@ -0,0 +1,285 @@
+// OutputKernels.h -- the fused playback stage for AudioDeviceImpl.
+//
+// outputChannel() makes one pass over a channel of full-range float frames,
+// clipping them, tracking their peak, adding TPDF dither if asked and writing
+// them into an interleaved little-endian 16-bit, 24-bit or float device
+// buffer.  This replaces limitFrame() followed by convertFrame() for those
+// device formats, which are most sound cards and all WAV files.  The frames
+// may be interleaved or not.  The scans and the conversion get SSE2 or NEON
+// versions when the compiler targets those.
+
+#ifndef _RT_OUTPUTKERNELS_H_
+#define _RT_OUTPUTKERNELS_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define OUTPUT_SSE
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define OUTPUT_NEON
+#endif
+
+// The device formats handled here.  The values match the sndlib formats.
+enum OutputFormat {
+	OutputShort = MUS_LSHORT,
+	Output24Bit = MUS_L24INT,
+	OutputFloat = MUS_LFLOAT
+};
+
+struct OutputParams {
+	bool	clip;			// clamp to [-32768, 32767], counting clipped samples
+	bool	checkPeaks;
+	bool	dither;			// TPDF dither at the device's LSB (int formats)
+	float	floatScale;		// OutputFloat only:  1, or 1/32768 to normalize
+	long	startFrame;		// for the peak locations
+};
+
+struct OutputClipStats {
+	int		numClipped;
+	float	clipMax;
+};
+
+// Dither noise is the difference of two 16-bit uniform numbers, drawn from
+// four interleaved xorshift generators so that the vector code can run them
+// side by side.  <state> must not be all zero.
+
+inline void outputSeedDither(uint32_t state[4])
+{
+	state[0] = 0x9e3779b9;
+	state[1] = 0x7f4a7c15;
+	state[2] = 0x85ebca6b;
+	state[3] = 0xc2b2ae35;
+}
+
+inline void outputFillDither(uint32_t state[4], float *noise, int count, float lsb)
+{
+	const float scale = lsb * (1.0f / 65536.0f);
+	int n = 0;
+#if defined(OUTPUT_SSE)
+	__m128i s = _mm_loadu_si128((const __m128i *) state);
+	const __m128i low16 = _mm_set1_epi32(0xffff);
+	const __m128 vscale = _mm_set1_ps(scale);
+	for (; n + 4 <= count; n += 4) {
+		s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+		s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+		s = _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+		const __m128i tri = _mm_sub_epi32(_mm_srli_epi32(s, 16), _mm_and_si128(s, low16));
+		_mm_storeu_ps(&noise[n], _mm_mul_ps(_mm_cvtepi32_ps(tri), vscale));
+	}
+	_mm_storeu_si128((__m128i *) state, s);
+#elif defined(OUTPUT_NEON)
+	uint32x4_t s = vld1q_u32(state);
+	const uint32x4_t low16 = vdupq_n_u32(0xffff);
+	const float32x4_t vscale = vdupq_n_f32(scale);
+	for (; n + 4 <= count; n += 4) {
+		s = veorq_u32(s, vshlq_n_u32(s, 13));
+		s = veorq_u32(s, vshrq_n_u32(s, 17));
+		s = veorq_u32(s, vshlq_n_u32(s, 5));
+		const int32x4_t tri = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(s, 16)),
+										vreinterpretq_s32_u32(vandq_u32(s, low16)));
+		vst1q_f32(&noise[n], vmulq_f32(vcvtq_f32_s32(tri), vscale));
+	}
+	vst1q_u32(state, s);
+#endif
+	for (; n < count; ++n) {
+		uint32_t &x = state[n & 3];
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		noise[n] = (float) ((int32_t) (x >> 16) - (int32_t) (x & 0xffff)) * scale;
+	}
+}
+
+// Smallest and largest of <count> samples.
+
+inline void outputRange(const float *in, int count, float *pMin, float *pMax)
+{
+	float lo = 0.0f, hi = 0.0f;
+	int n = 0;
+#if defined(OUTPUT_SSE)
+	__m128 vlo = _mm_setzero_ps(), vhi = _mm_setzero_ps();
+	for (; n + 4 <= count; n += 4) {
+		const __m128 v = _mm_loadu_ps(&in[n]);
+		vlo = _mm_min_ps(vlo, v);
+		vhi = _mm_max_ps(vhi, v);
+	}
+	float l[4], h[4];
+	_mm_storeu_ps(l, vlo);
+	_mm_storeu_ps(h, vhi);
+	for (int i = 0; i < 4; ++i) {
+		lo = (l[i] < lo) ? l[i] : lo;
+		hi = (h[i] > hi) ? h[i] : hi;
+	}
+#elif defined(OUTPUT_NEON)
+	float32x4_t vlo = vdupq_n_f32(0.0f), vhi = vdupq_n_f32(0.0f);
+	for (; n + 4 <= count; n += 4) {
+		const float32x4_t v = vld1q_f32(&in[n]);
+		vlo = vminq_f32(vlo, v);
+		vhi = vmaxq_f32(vhi, v);
+	}
+	lo = vminvq_f32(vlo);
+	hi = vmaxvq_f32(vhi);
+#endif
+	for (; n < count; ++n) {
+		lo = (in[n] < lo) ? in[n] : lo;
+		hi = (in[n] > hi) ? in[n] : hi;
+	}
+	*pMin = lo;
+	*pMax = hi;
+}
+
+// (in[n] * scale + noise[n]), limited to [lo, hi] and rounded to the nearest
+// integer.  <noise> may be NULL.
+
+inline void outputToInt(const float *in, const float *noise, int32_t *out, int count,
+						float scale, float lo, float hi)
+{
+	int n = 0;
+#if defined(OUTPUT_SSE)
+	const __m128 vscale = _mm_set1_ps(scale);
+	const __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+	for (; n + 4 <= count; n += 4) {
+		__m128 v = _mm_mul_ps(_mm_loadu_ps(&in[n]), vscale);
+		if (noise)
+			v = _mm_add_ps(v, _mm_loadu_ps(&noise[n]));
+		v = _mm_min_ps(_mm_max_ps(v, vlo), vhi);
+		_mm_storeu_si128((__m128i *) &out[n], _mm_cvtps_epi32(v));
+	}
+#elif defined(OUTPUT_NEON)
+	const float32x4_t vscale = vdupq_n_f32(scale);
+	const float32x4_t vlo = vdupq_n_f32(lo), vhi = vdupq_n_f32(hi);
+	for (; n + 4 <= count; n += 4) {
+		float32x4_t v = vmulq_f32(vld1q_f32(&in[n]), vscale);
+		if (noise)
+			v = vaddq_f32(v, vld1q_f32(&noise[n]));
+		v = vminq_f32(vmaxq_f32(v, vlo), vhi);
+		vst1q_s32(&out[n], vcvtnq_s32_f32(v));
+	}
+#endif
+	for (; n < count; ++n) {
+		float v = in[n] * scale;
+		if (noise)
+			v += noise[n];
+		v = (v < lo) ? lo : (v > hi) ? hi : v;
+		out[n] = (int32_t) lrintf(v);
+	}
+}
+
+// Clips, peak-checks, dithers and converts <frames> samples of one channel.
+// <in> points to the channel's first sample and <inIncr> is the distance
+// between its samples.  Clipped samples are written back to <in>, as
+// limitFrame() does, so that a second device sharing the frames gets them
+// clipped.  <out> points to the channel's first sample in the device buffer,
+// which has <outChans> channels, or is NULL to skip the conversion.
+
+template <int Format>
+void outputChannel(float *in, int inIncr, unsigned char *out, int outChans,
+				   int frames, const OutputParams &params, uint32_t dither[4],
+				   float *pPeak, long *pPeakLoc, OutputClipStats *stats)
+{
+	enum { kChunk = 64 };
+	const int bytesPerSamp = (Format == Output24Bit) ? 3 : (Format == OutputShort) ? 2 : 4;
+	const int outIncr = outChans * bytesPerSamp;
+	float gather[kChunk];
+	float noise[kChunk];
+	int32_t conv[kChunk];
+
+	for (int start = 0; start < frames; start += kChunk) {
+		const int count = (frames - start < kChunk) ? frames - start : kChunk;
+		float *src;
+		if (inIncr == 1)
+			src = &in[start];
+		else {
+			const float *fp = &in[start * inIncr];
+			for (int n = 0; n < count; ++n, fp += inIncr)
+				gather[n] = *fp;
+			src = gather;
+		}
+
+		float lo, hi;
+		outputRange(src, count, &lo, &hi);
+		if (params.clip && (lo < -32768.0f || hi > 32767.0f)) {
+			for (int n = 0; n < count; ++n) {
+				const float samp = src[n];
+				float clipped;
+				if (samp < -32768.0f)
+					clipped = -32768.0f;
+				else if (samp > 32767.0f)
+					clipped = 32767.0f;
+				else
+					continue;
+				const float fabsamp = fabsf(samp);
+				if (fabsamp > stats->clipMax)
+					stats->clipMax = fabsamp;
+				++stats->numClipped;
+				src[n] = clipped;
+				in[(start + n) * inIncr] = clipped;
+			}
+			lo = (lo < -32768.0f) ? -32768.0f : lo;
+			hi = (hi > 32767.0f) ? 32767.0f : hi;
+		}
+
+		if (params.checkPeaks) {
+			const float peak = (-lo > hi) ? -lo : hi;
+			if (peak > *pPeak) {
+				// The first sample that reaches it, as in a sample-by-sample scan.
+				int n = 0;
+				while (n < count - 1 && fabsf(src[n]) != peak)
+					++n;
+				*pPeak = peak;
+				*pPeakLoc = params.startFrame + start + n;
+			}
+		}
+
+		if (out == NULL)
+			continue;
+		unsigned char *cp = &out[start * outIncr];
+		if (Format == OutputFloat) {
+			for (int n = 0; n < count; ++n, cp += outIncr) {
+				union { float f; uint32_t u; } bits;
+				bits.f = src[n] * params.floatScale;
+				cp[0] = (unsigned char) bits.u;
+				cp[1] = (unsigned char) (bits.u >> 8);
+				cp[2] = (unsigned char) (bits.u >> 16);
+				cp[3] = (unsigned char) (bits.u >> 24);
+			}
+		}
+		else if (Format == OutputShort) {
+			if (params.dither)
+				outputFillDither(dither, noise, count, 1.0f);
+			outputToInt(src, params.dither ? noise : NULL, conv, count,
+						1.0f, -32768.0f, 32767.0f);
+			for (int n = 0; n < count; ++n, cp += outIncr) {
+				cp[0] = (unsigned char) conv[n];
+				cp[1] = (unsigned char) (conv[n] >> 8);
+			}
+		}
+		else /* Output24Bit */ {
+			if (params.dither)
+				outputFillDither(dither, noise, count, 1.0f);
+			outputToInt(src, params.dither ? noise : NULL, conv, count,
+						256.0f, -8388608.0f, 8388607.0f);
+			for (int n = 0; n < count; ++n, cp += outIncr) {
+				cp[0] = (unsigned char) conv[n];
+				cp[1] = (unsigned char) (conv[n] >> 8);
+				cp[2] = (unsigned char) (conv[n] >> 16);
+			}
+		}
+	}
+}
+
+// Zeroes one channel of the device buffer, for device channels beyond the
+// frame's.
+
+inline void outputSilence(unsigned char *out, int outChans, int bytesPerSamp, int frames)
+{
+	const int outIncr = outChans * bytesPerSamp;
+	for (int n = 0; n < frames; ++n, out += outIncr)
+		memset(out, 0, bytesPerSamp);
+}
+
+#endif	// _RT_OUTPUTKERNELS_H_
@@ -102,6 +102,8 @@ create_audio_devices(int record, int play, int chans, float *ioSrate, int *buffe
 		openMode |= AudioDevice::CheckPeaks;
 	if (RTOption::reportClipping())
 		openMode |= AudioDevice::ReportClipping;
+	if (RTOption::dither())
+		openMode |= AudioDevice::Dither;
 
 #if DEBUG > 0
 	printf("DEBUG: audio device: peak check: %d report clip: %d\n",
@@ -178,6 +180,8 @@ create_audio_file_device(AudioDevice *inDevice,
 		openMode |= AudioDevice::CheckPeaks;	// Dont check peaks if HW already doing so.
 	if (RTOption::reportClipping() && !playing)
 		openMode |= AudioDevice::ReportClipping;	// Ditto for reporting of clipping
+	if (RTOption::dither())
+		openMode |= AudioDevice::Dither;
 
 #if DEBUG > 0
 	printf("DEBUG: file device: peak check: %d report clip: %d\n",
@@ -205,6 +209,7 @@ create_audio_file_device(AudioDevice *inDevice,
 		delete fileDevice;
 		return NULL;
 	}
+	fileDevice->setWriteQueue(RTOption::outputWriteQueue(), RTOption::outputWriteDrop());
 	// Cheating -- should hand in queue size as argument!
 	int queueSize = RTcmix::bufsamps();
 	int count = 1;
@@ -49,6 +49,7 @@
 #include "Scope.h"
 #include "Symbol.h"
 #include <RTOption.h>
+#include <RTcmix.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
@@ -65,12 +66,16 @@ extern "C" {
 /* builtin.cpp */
 extern int call_builtin_function(const char *funcname, const MincValue arglist[],
                           const int nargs, MincValue *retval);
+extern int find_builtin_function(const char *funcname);
+extern int call_builtin_function_index(int index, const MincValue arglist[],
+                          int nargs, MincValue *retval);
 extern int call_object_method(MincValue &object, const char *methodName, const MincValue arglist[],
                               int nargs, MincValue *retval);
 
 /* callextfunc.cpp */
 extern int call_external_function(const char *funcname, const MincValue arglist[],
-                           const int nargs, MincValue *return_value);
+                           const int nargs, MincValue *return_value,
+                           DispatchHandle *handle = NULL);
 extern MincHandle minc_binop_handle_float(const MincHandle handle, const MincFloat val, OpKind op);
 extern MincHandle minc_binop_float_handle(const MincFloat val, const MincHandle handle, OpKind op);
 extern MincHandle minc_binop_handles(const MincHandle handle1, const MincHandle handle2, OpKind op);
@@ -1220,17 +1225,33 @@ bool NodeFunctionCall::callConstructor(const char *functionName)
     return false;
 }
 
+NodeFunctionCall::~NodeFunctionCall()
+{
+    delete _dispatchHandle;
+}
+
+// The first call from this node resolves the name; after that we go straight
+// to the builtin or RTcmix function, so a call in a loop skips the lookups.
+
 void NodeFunctionCall::callBuiltinFunction(const char *functionName)
 {
     if (!functionName) {
         minc_die("string variable called as function is NULL");
     }
     MincValue retval;
-    int result = call_builtin_function(functionName, sMincList, sMincListLen,
-                                       &retval);
-    if (result == FUNCTION_NOT_FOUND) {
+    int result;
+    if (_builtinIndex == kUnresolved) {
+        _builtinIndex = find_builtin_function(functionName);
+    }
+    if (_builtinIndex >= 0) {
+        result = call_builtin_function_index(_builtinIndex, sMincList, sMincListLen, &retval);
+    }
+    else {
+        if (_dispatchHandle == NULL) {
+            _dispatchHandle = new DispatchHandle;
+        }
         result = call_external_function(functionName, sMincList, sMincListLen,
-                                        &retval);
+                                        &retval, _dispatchHandle);
     }
     this->setValue(retval);
     switch (result) {
@@ -13,6 +13,8 @@
 #include "MincValue.h"
 #include "RefCounted.h"
 
+struct DispatchHandle;
+
 // NODE_DEBUG enables logging of Node creation and destruction
 #undef NODE_DEBUG
 
@@ -396,15 +398,20 @@ public:
 class NodeFunctionCall : public Node2Children, private MincFunctionHandler
 {
 public:
-    NodeFunctionCall(Node *func, Node *args) : Node2Children(OpFree, eNodeFuncCall, func, args) {
+    NodeFunctionCall(Node *func, Node *args) : Node2Children(OpFree, eNodeFuncCall, func, args),
+        _builtinIndex(kUnresolved), _dispatchHandle(NULL) {
 		NPRINT("NodeFunctionCall(%p, %p) => %p\n", func, args, this);
 	}
 protected:
+    virtual             ~NodeFunctionCall();
 	virtual Node*		doExct();
 private:
     bool                callConstructor(const char *functionName);
     void                callBuiltinFunction(const char *functionName);
     void                callInitMethodIfPresent(MincStruct *theStruct, Symbol *thisSymbol);
+    enum { kUnresolved = -2 };
+    int                 _builtinIndex;      // into the builtin table, or -1 if not a builtin
+    DispatchHandle *    _dispatchHandle;    // cached RTcmix function or instrument lookup
 };
 
 //  Method call node
@@ -36,12 +36,11 @@ static MincString _minc_tostring(const MincValue args[], int nargs);
 static MincString _minc_substring(const MincValue args[], int nargs);
 
 /* other prototypes */
-static int _find_builtin(const char *funcname);
 static void _do_print(const MincValue args[], int nargs);
 static MincString _make_type_string(MincDataType type);
 
 
-/* list of builtin functions, searched by _find_builtin */
+/* list of builtin functions, searched by find_builtin_function */
 static struct _builtins {
    const char *label;
    MincFloat (*number_return)(const MincValue *, int); /* func name for those returning MincFloat */
@@ -65,8 +64,12 @@ static struct _builtins {
 
 
 /* -------------------------------------- call_builtin_function and helper -- */
-static int
-_find_builtin(const char *funcname)
+/* Returns the index of <funcname> in builtin_funcs, or -1.  Callers that
+   call the same builtin repeatedly can keep the index and use
+   call_builtin_function_index.
+*/
+int
+find_builtin_function(const char *funcname)
 {
    int i = 0;
    while (true) {
@@ -80,12 +83,9 @@ _find_builtin(const char *funcname)
 }
 
 int
-call_builtin_function(const char *funcname, const MincValue arglist[],
+call_builtin_function_index(int index, const MincValue arglist[],
    int nargs, MincValue *retval)
 {
-   int index = _find_builtin(funcname);
-   if (index < 0)
-      return FUNCTION_NOT_FOUND;
    if (builtin_funcs[index].number_return) {
       *retval = (MincFloat) (*(builtin_funcs[index].number_return))
                                                          (arglist, nargs);
@@ -97,6 +97,16 @@ call_builtin_function(const char *funcname, const MincValue arglist[],
    return 0;
 }
 
+int
+call_builtin_function(const char *funcname, const MincValue arglist[],
+   int nargs, MincValue *retval)
+{
+   int index = find_builtin_function(funcname);
+   if (index < 0)
+      return FUNCTION_NOT_FOUND;
+   return call_builtin_function_index(index, arglist, nargs, retval);
+}
+
 
 /* ============================================= print, printf and friends == */
 
@@ -67,9 +67,12 @@ static Arg * minc_list_to_arglist(const char *funcname, const MincValue *inList,
 	return newArgs;
 }
 
+/* If <handle> is non-NULL, it caches the lookup of <funcname> for the next
+   call from the same place (see NodeFunctionCall).
+*/
 int
 call_external_function(const char *funcname, const MincValue arglist[],
-	const int nargs, MincValue *return_value)
+	const int nargs, MincValue *return_value, DispatchHandle *handle)
 {
 	int result, numArgs = nargs;
 	Arg retval;
@@ -153,7 +156,14 @@ call_external_function(const char *funcname, const MincValue arglist[],
 	}
     } minc_catch(delete [] rtcmixargs;)
 
-	result = RTcmix::dispatch(funcname, rtcmixargs, numArgs, &retval);
+	if (handle == NULL)
+		result = RTcmix::dispatch(funcname, rtcmixargs, numArgs, &retval);
+	else if (RTcmix::isCurrent(*handle) || RTcmix::resolve(funcname, handle))
+		result = RTcmix::dispatch(funcname, *handle, rtcmixargs, numArgs, &retval);
+	else {
+		rtcmix_advise(NULL, "Note: \"%s\" is an undefined function or instrument.", funcname);
+		result = FUNCTION_NOT_FOUND;
+	}
    
 	// Convert return value from RTcmix function.
 	switch (retval.type()) {
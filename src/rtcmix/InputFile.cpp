@@ -5,13 +5,18 @@
 //
 
 #include "InputFile.h"
+#include "ReadAheadCache.h"
+#include "InputResampler.h"
 #include "RTcmix.h"
+#include "RTOption.h"
 #include <sndlib.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sndlibsupport.h>
 #include <ugens.h>
 #include "byte_routines.h"
@@ -64,37 +69,33 @@
 static inline long lmin(long a, long b) { return a < b ? a : b; }
 static inline long lmax(long a, long b) { return a > b ? a : b; }
 
+static const long kMapAdviseBytes = 1024 * 1024;	// MappedType read-ahead hint
+static const long kLoadFramesPerPass = 65536;		// keeps convert_*_samps in int range
 
-/* ----------------------------------------------------- read_float_samps --- */
+
+/* ----------------------------------------------------- read_file_bytes --- */
+/* Read <bytes_requested> bytes at the current file position into
+   <read_buffer>, or as many as remain before <endbyte>.  If we reach EOF,
+   zero out the remaining part of the buffer that we expected to fill.
+*/
 static int
-read_float_samps(
+read_file_bytes(
       int         fd,               /* file descriptor for open input file */
-      int         data_format,      /* sndlib data format of input file */
-      int         file_chans,       /* total chans in input file */
       off_t       cur_offset,       /* current file position before read */
       long        endbyte,          /* first byte following last file sample */
-      BufPtr      dest,             /* interleaved buffer from inst */
-      int         dest_chans,       /* number of chans interleaved */
-      int         dest_frames,      /* frames in interleaved buffer */
-      const short src_chan_list[],  /* list of in-bus chan numbers from inst */
-                 /* (or NULL to fill all chans) */
-      short       src_chans,         /* number of in-bus chans to copy */
-      void *      read_buffer        /* block to read from disk into */
+      long        bytes_requested,  /* bytes to place in read_buffer */
+      void *      read_buffer       /* block to read from disk into */
       )
-{    
-    const int bytes_per_samp = sizeof(float);
+{
     char *bufp = (char *) read_buffer;
-    
-    const int bytes_requested = dest_frames * file_chans * bytes_per_samp;
     const long bytes_remaining = endbyte - cur_offset;
-    const long extra_bytes = (bytes_requested > bytes_remaining)
-    ? bytes_requested - bytes_remaining : 0;
-    ssize_t bytes_to_read = lmin(bytes_remaining, bytes_requested);
+    ssize_t bytes_to_read = lmax(0L, lmin(bytes_remaining, bytes_requested));
+    const long extra_bytes = bytes_requested - bytes_to_read;
     
     while (bytes_to_read > 0) {
         ssize_t bytes_read = read(fd, bufp, bytes_to_read);
         if (bytes_read == -1) {
-            perror("read_float_samps (read)");
+            perror("read_file_bytes (read)");
             return FILE_ERROR;
         }
         if (bytes_read == 0)          /* EOF */
@@ -104,21 +105,40 @@ read_float_samps(
         bytes_to_read -= bytes_read;
     }
     
-    /* If we reached EOF, zero out remaining part of buffer that we
-     expected to fill.
-     */
-    bytes_to_read += extra_bytes;
-    while (bytes_to_read > 0) {
-        (* (float *) bufp) = 0.0;
-        bufp += bytes_per_samp;
-        bytes_to_read -= bytes_per_samp;
+    memset(bufp, 0, bytes_to_read + extra_bytes);
+    return 0;
+}
+
+
+/* -------------------------------------------------- convert_float_samps --- */
+static int
+convert_float_samps(
+      int         data_format,      /* sndlib data format of input file */
+      int         file_chans,       /* total chans in input file */
+      BufPtr      dest,             /* interleaved buffer from inst */
+      int         dest_chans,       /* number of chans interleaved */
+      int         dest_frames,      /* frames in interleaved buffer */
+      const short src_chan_list[],  /* list of in-bus chan numbers from inst */
+                 /* (or NULL to fill all chans) */
+      short       src_chans,         /* number of in-bus chans to copy */
+      void *      read_buffer        /* block read from disk */
+      )
+{    
+    const int src_samps = dest_frames * file_chans;
+    float *fbuf = (float *) read_buffer;
+    
+#if MUS_LITTLE_ENDIAN
+    const bool swap = IS_BIG_ENDIAN_FORMAT(data_format);
+#else
+    const bool swap = IS_LITTLE_ENDIAN_FORMAT(data_format);
+#endif
+    if (swap) {
+        for (int i = 0; i < src_samps; i++)
+            byte_reverse4(&fbuf[i]);
     }
     
     /* Copy interleaved file buffer to dest buffer, with bus mapping. */
     
-    const int src_samps = dest_frames * file_chans;
-    float *fbuf = (float *) read_buffer;
-    
     for (int n = 0; n < dest_chans; n++) {
 #ifdef IGNORE_BUS_COUNT_FOR_FILE_INPUT
         const int chan = n;
@@ -130,68 +150,25 @@ read_float_samps(
             dest[j] = (BUFTYPE) fbuf[i];
     }
     
-#if MUS_LITTLE_ENDIAN
-    const bool swap = IS_BIG_ENDIAN_FORMAT(data_format);
-#else
-    const bool swap = IS_LITTLE_ENDIAN_FORMAT(data_format);
-#endif
-    if (swap) {
-        for (int i = 0; i < src_samps; i++)
-            byte_reverse4(&dest[i]);
-    }
-    
     return 0;
 }
 
 
-/* ----------------------------------------------------- read_24bit_samps --- */
+/* -------------------------------------------------- convert_24bit_samps --- */
 static int
-read_24bit_samps(
-      int         fd,               /* file descriptor for open input file */
+convert_24bit_samps(
       int         data_format,      /* sndlib data format of input file */
       int         file_chans,       /* total chans in input file */
-      off_t       cur_offset,       /* current file position before read */
-      long        endbyte,          /* first byte following last file sample */
       BufPtr      dest,             /* interleaved buffer from inst */
       int         dest_chans,       /* number of chans interleaved */
       int         dest_frames,      /* frames in interleaved buffer */
       const short src_chan_list[],  /* list of in-bus chan numbers from inst */
                  /* (or NULL to fill all chans) */
       short       src_chans,         /* number of in-bus chans to copy */
-      void *      read_buffer        /* block to read from disk into */
+      void *      read_buffer        /* block read from disk */
       )
 {
-    
     const int bytes_per_samp = 3;         /* 24-bit int */
-    unsigned char *bufp = (unsigned char *) read_buffer;
-    
-    const int bytes_requested = dest_frames * file_chans * bytes_per_samp;
-    const long bytes_remaining = endbyte - cur_offset;
-    const long extra_bytes = (bytes_requested > bytes_remaining)
-    ? bytes_requested - bytes_remaining : 0;
-    ssize_t bytes_to_read = lmin(bytes_remaining, bytes_requested);
-    
-    while (bytes_to_read > 0) {
-        ssize_t bytes_read = read(fd, bufp, bytes_to_read);
-        if (bytes_read == -1) {
-            perror("read_24bit_samps (read)");
-            return FILE_ERROR;
-        }
-        if (bytes_read == 0)          /* EOF */
-            break;
-        
-        bufp += bytes_read;
-        bytes_to_read -= bytes_read;
-    }
-    
-    /* If we reached EOF, zero out remaining part of buffer that we
-     expected to fill.
-     */
-    bytes_to_read += extra_bytes;
-    while (bytes_to_read > 0) {
-        *bufp++ = 0;
-        bytes_to_read--;
-    }
     
     /* Copy interleaved file buffer to dest buffer, with bus mapping. */
     
@@ -229,55 +206,20 @@ read_24bit_samps(
     return 0;
 }
 
-/* ----------------------------------------------------- read_32bit_samps --- */
+/* -------------------------------------------------- convert_32bit_samps --- */
 static int
-read_32bit_samps(
-                 int         fd,               /* file descriptor for open input file */
+convert_32bit_samps(
                  int         data_format,      /* sndlib data format of input file */
                  int         file_chans,       /* total chans in input file */
-                 off_t       cur_offset,       /* current file position before read */
-                 long        endbyte,          /* first byte following last file sample */
                  BufPtr      dest,             /* interleaved buffer from inst */
                  int         dest_chans,       /* number of chans interleaved */
                  int         dest_frames,      /* frames in interleaved buffer */
                  const short src_chan_list[],  /* list of in-bus chan numbers from inst */
                  /* (or NULL to fill all chans) */
                  short       src_chans,         /* number of in-bus chans to copy */
-                 void *      read_buffer        /* block to read from disk into */
+                 void *      read_buffer        /* block read from disk */
 )
 {
-    
-    const int bytes_per_samp = 4;         /* 24-bit int */
-    unsigned char *bufp = (unsigned char *) read_buffer;
-    
-    const int bytes_requested = dest_frames * file_chans * bytes_per_samp;
-    const long bytes_remaining = endbyte - cur_offset;
-    const long extra_bytes = (bytes_requested > bytes_remaining)
-    ? bytes_requested - bytes_remaining : 0;
-    ssize_t bytes_to_read = lmin(bytes_remaining, bytes_requested);
-    
-    while (bytes_to_read > 0) {
-        ssize_t bytes_read = read(fd, bufp, bytes_to_read);
-        if (bytes_read == -1) {
-            perror("read_24bit_samps (read)");
-            return FILE_ERROR;
-        }
-        if (bytes_read == 0)          /* EOF */
-            break;
-        
-        bufp += bytes_read;
-        bytes_to_read -= bytes_read;
-    }
-    
-    /* If we reached EOF, zero out remaining part of buffer that we
-     expected to fill.
-     */
-    bytes_to_read += extra_bytes;
-    while (bytes_to_read > 0) {
-        *bufp++ = 0;
-        bytes_to_read--;
-    }
-    
     /* Copy interleaved file buffer to dest buffer, with bus mapping. */
     
 #if MUS_LITTLE_ENDIAN
@@ -315,55 +257,20 @@ read_32bit_samps(
     return 0;
 }
 
-/* ----------------------------------------------------- read_short_samps --- */
+/* -------------------------------------------------- convert_short_samps --- */
 static int
-read_short_samps(
-      int         fd,               /* file descriptor for open input file */
+convert_short_samps(
       int         data_format,      /* sndlib data format of input file */
       int         file_chans,       /* total chans in input file */
-      off_t       cur_offset,       /* current file position before read */
-      long        endbyte,          /* first byte following last file sample */
       BufPtr      dest,             /* interleaved buffer from inst */
       int         dest_chans,       /* number of chans interleaved */
       int         dest_frames,      /* frames in interleaved buffer */
       const short src_chan_list[],  /* list of in-bus chan numbers from inst */
                  /* (or NULL to fill all chans) */
       short       src_chans,         /* number of in-bus chans to copy */
-      void *      read_buffer        /* block to read from disk into */
+      void *      read_buffer        /* block read from disk */
       )
 {
-    const int bytes_per_samp = 2;         /* short int */
-    char *bufp = (char *) read_buffer;
-    
-    const int bytes_requested = dest_frames * file_chans * bytes_per_samp;
-    const long bytes_remaining = endbyte - cur_offset;
-    const long extra_bytes = (bytes_requested > bytes_remaining)
-    ? bytes_requested - bytes_remaining : 0;
-    ssize_t bytes_to_read = lmin(bytes_remaining, bytes_requested);
-    
-    while (bytes_to_read > 0) {
-        ssize_t bytes_read = read(fd, bufp, bytes_to_read);
-        if (bytes_read == -1) {
-            perror("read_short_samps (read)");
-            return FILE_ERROR;
-        }
-        if (bytes_read == 0)          /* EOF */
-            break;
-        
-        bufp += bytes_read;
-        bytes_to_read -= bytes_read;
-    }
-    
-    /* If we reached EOF, zero out remaining part of buffer that we
-     expected to fill.
-     */
-    bytes_to_read += extra_bytes;
-    while (bytes_to_read > 0) {
-        (* (short *) bufp) = 0;
-        bufp += bytes_per_samp;
-        bytes_to_read -= bytes_per_samp;
-    }
-    
     /* Copy interleaved file buffer to dest buffer, with bus mapping. */
     
 #if MUS_LITTLE_ENDIAN
@@ -398,31 +305,38 @@ read_short_samps(
     return 0;
 }
 
+
 char InputFile::sScratchBuffer[sScratchBufferSize];
 
 #ifdef MULTI_THREAD
 
-char *		InputFile::sConversionBuffers[RT_THREAD_COUNT];
+char **		InputFile::sConversionBuffers = NULL;
+int			InputFile::sConversionBufferCount = 0;
 
-void InputFile::createConversionBuffers(int inBufSamps)
+void InputFile::createConversionBuffers(int inBufSamps, int inThreadCount)
 {
+	destroyConversionBuffers();
 	/* Allocate buffers needed to convert input audio files as they are read */
-	for (int i = 0; i < RT_THREAD_COUNT; ++i) {
+	sConversionBuffers = new char *[inThreadCount];
+	sConversionBufferCount = inThreadCount;
+	for (int i = 0; i < inThreadCount; ++i) {
 		sConversionBuffers[i] = new char[sizeof(BUFTYPE) * MAXCHANS * inBufSamps];
 	}
 }
 
 void InputFile::destroyConversionBuffers()
 {
-	for (int i = 0; i < RT_THREAD_COUNT; ++i) {
+	for (int i = 0; i < sConversionBufferCount; ++i) {
         delete [] sConversionBuffers[i];
-		sConversionBuffers[i] = NULL;
 	}
+	delete [] sConversionBuffers;
+	sConversionBuffers = NULL;
+	sConversionBufferCount = 0;
 }
 
 #endif
 
-InputFile::InputFile() : _filename(NULL), _fd(NO_FD), _readBuffer(NULL), _memBuffer(NULL), _refcount(0), _gainScale(1.0f)
+InputFile::InputFile() : _filename(NULL), _fd(NO_FD), _readBuffer(NULL), _memBuffer(NULL), _mappedFile(NULL), _mappedLength(0), _adviseOffset(0), _refcount(0), _readAhead(NULL), _gainScale(1.0f)
 {
 }
 
@@ -461,13 +375,13 @@ int InputFile::init(int inFd, const char *inFileName, Type inType, int inHeaderT
     }
 
 	if (_is_float_format)
-		_readFunction = &read_float_samps;
+		_convertFunction = &convert_float_samps;
 	else if (IS_24BIT_FORMAT(_data_format))
-		_readFunction = &read_24bit_samps;
+		_convertFunction = &convert_24bit_samps;
     else if (IS_32BIT_FORMAT(_data_format))
-        _readFunction = &read_32bit_samps;
+        _convertFunction = &convert_32bit_samps;
 	else
-		_readFunction = &read_short_samps;
+		_convertFunction = &convert_short_samps;
 
 #ifndef MULTI_THREAD
 	_readBuffer = (void *) malloc((size_t) RTcmix::bufsamps() * MAXCHANS * bytes_per_samp);
@@ -480,13 +394,35 @@ int InputFile::init(int inFd, const char *inFileName, Type inType, int inHeaderT
 	if (_fileType == InMemoryType) {
 		_endbyte = inFrames * bytes_per_samp * _chans;
     	if (loadSamps(inFrames) != 0) {
-			rtcmix_warn("InputFile", "File '%s' cannot be loaded into memory -- defaulting to regular load");
+			rtcmix_warn("InputFile", "File '%s' cannot be loaded into memory -- defaulting to regular load", _filename);
 			_fileType = FileType;
 			_endbyte += _data_location;
 		}
 	}
 	else
 		_endbyte = _data_location + (inFrames * bytes_per_samp * _chans);
+
+	// Files already in our native float or short format can be read in place.
+	if (_fileType == MappedType) {
+		const bool native = (_data_format == NATIVE_FLOAT_FMT || _data_format == NATIVE_SHORT_FMT);
+		if (native && (_data_location % bytes_per_samp) == 0)
+			_mappedFile = mapFile(_endbyte, false, &_mappedLength);
+		if (_mappedFile == NULL) {
+			rtcmix_warn("InputFile", "File '%s' cannot be mapped into memory -- defaulting to regular load", _filename);
+			_fileType = FileType;
+		}
+		else {
+			posix_madvise(_mappedFile, _mappedLength, POSIX_MADV_SEQUENTIAL);
+			_adviseOffset = _data_location;
+		}
+	}
+
+	// Streamed files get a read-ahead cache, filled by the disk I/O thread.
+	if (_fileType == FileType && _fd > 0 && RTOption::inputReadAhead() > 0) {
+		const long requestBytes = (long) RTcmix::bufsamps() * _chans * bytes_per_samp;
+		_readAhead = new ReadAheadCache(_fd, _data_location, _endbyte, requestBytes,
+										RTOption::inputReadAhead() * 1024L);
+	}
     return 0;
 }
 
@@ -513,7 +449,7 @@ int InputFile::init(BufPtr inBuffer, const char *inBufferName, long inFrames, fl
         return PARAM_ERROR;
     }
 	
-	_readFunction = &read_float_samps;
+	_convertFunction = &convert_float_samps;
 	_endbyte = inFrames * bytes_per_samp * _chans;
 
 	_memBuffer = inBuffer;
@@ -541,6 +477,16 @@ int InputFile::reinit(BufPtr inBuffer, long inFrames, int inChannels)
     return 0;
 }
 
+long InputFile::readAheadHits() const
+{
+	return _readAhead ? _readAhead->hits() : 0;
+}
+
+long InputFile::readAheadMisses() const
+{
+	return _readAhead ? _readAhead->misses() : 0;
+}
+
 void InputFile::reference()
 {
 	if (++_refcount == 1) {
@@ -564,6 +510,18 @@ void InputFile::unreference()
 
 void InputFile::close()
 {
+	if (_mappedFile) {
+		munmap(_mappedFile, _mappedLength);
+		_mappedFile = NULL;
+		_mappedLength = 0;
+	}
+	if (_readAhead) {
+		// Must go before the file does, since its thread reads from _fd.
+		rtcmix_debug("InputFile::close", "'%s' read-ahead: %ld hits, %ld misses",
+					 _filename, _readAhead->hits(), _readAhead->misses());
+		delete _readAhead;
+		_readAhead = NULL;
+	}
 	if (_fd != USE_MM_BUF) {	// MM buffers are not owned by us
 		if (_memBuffer) {
 #ifdef FILE_DEBUG
@@ -598,7 +556,23 @@ void InputFile::close()
 	_dur = 0.0;
 }
 
+// An instrument reading a file at another rate passes its resampler, which
+// reads the file through readFrames() below.
+
 off_t InputFile::readSamps(off_t cur_offset,
+                         BufPtr dest,
+                         int dest_chans,
+                         int dest_frames,
+                         const short src_chan_list[],
+                         short src_chans,
+                         InputResampler *resampler)
+{
+	if (resampler != NULL)
+		return resampler->read(cur_offset, dest, dest_chans, dest_frames);
+	return readFrames(cur_offset, dest, dest_chans, dest_frames, src_chan_list, src_chans);
+}
+
+off_t InputFile::readFrames(off_t cur_offset,
                          BufPtr dest,
                          int dest_chans,
                          int dest_frames,
@@ -612,26 +586,33 @@ off_t InputFile::readSamps(off_t cur_offset,
 	if (_fileType == InMemoryType) {
 		(void)copySamps(cur_offset, dest, dest_chans, dest_frames, src_chan_list, src_chans);
 	}
+	else if (_fileType == MappedType) {
+		(void)readMappedSamps(cur_offset, dest, dest_chans, dest_frames, src_chan_list, src_chans);
+	}
 	else {
-		{
-			AutoLock fileLock(this);
+		const int bytes_per_samp = ::mus_data_format_to_bytes_per_sample(_data_format);
+		const long bytes_requested = (long) dest_frames * _chans * bytes_per_samp;
 #ifdef MULTI_THREAD
-            _readBuffer = sConversionBuffers[RTThread::GetIndexForThread()];
+		// Each thread has its own conversion buffer, so only the synchronous
+		// read below needs the lock.
+		void *readBuffer = sConversionBuffers[RTThread::GetIndexForThread()];
+#else
+		void *readBuffer = _readBuffer;
 #endif
+		if (_readAhead == NULL || !_readAhead->read(cur_offset, bytes_requested, readBuffer)) {
+			AutoLock fileLock(this);
             if (lseek(_fd, cur_offset, SEEK_SET) == -1) {
 				perror("RTcmix::readFromInputFile (lseek)");
                 return FILE_ERROR;
 			}
-			
-			int status = (*this->_readFunction)(_fd,
-										 _data_format,
-										 _chans,
-										 cur_offset,
-										 _endbyte,
-										 dest, dest_chans, dest_frames,
-										 src_chan_list, src_chans,
-										 _readBuffer);
-        }
+			if (read_file_bytes(_fd, cur_offset, _endbyte, bytes_requested, readBuffer) != 0)
+				return FILE_ERROR;
+		}
+		(*this->_convertFunction)(_data_format,
+								  _chans,
+								  dest, dest_chans, dest_frames,
+								  src_chan_list, src_chans,
+								  readBuffer);
 	}
     int bytes_per_samp = ::mus_data_format_to_bytes_per_sample(_data_format);
     return dest_frames * _chans * bytes_per_samp;
@@ -647,15 +628,38 @@ int InputFile::loadSamps(long inFrames)
 		perror("malloc");
 		return -1;
 	}
-	if (lseek(_fd, _data_location, SEEK_SET) == -1) {
-		perror("RTcmix::readFromInputFile (lseek)");
-        return FILE_ERROR;
-	}
 	const short src_chan_list[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
 	long framesRead = 0;
 	long bytesRead = 0;
 	int status = 0;
-    const int bytesPerFrame = ::mus_data_format_to_bytes_per_sample(_data_format) * _chans;
+    const int bytesPerSamp = ::mus_data_format_to_bytes_per_sample(_data_format);
+    const int bytesPerFrame = bytesPerSamp * _chans;
+
+	// Convert straight out of a private (copy-on-write) mapping of the file,
+	// if possible, rather than reading it through sScratchBuffer.
+	const int alignment = IS_24BIT_FORMAT(_data_format) ? 1 : bytesPerSamp;
+	off_t mappedLength = 0;
+	char *mapped = (_data_location % alignment == 0) ? mapFile(_data_location + (off_t)inFrames * bytesPerFrame, true, &mappedLength) : NULL;
+	if (mapped != NULL) {
+		posix_madvise(mapped, mappedLength, POSIX_MADV_SEQUENTIAL);
+		const long framesMapped = lmin(inFrames, long((mappedLength - _data_location) / bytesPerFrame));
+		while (framesRead < framesMapped && status == 0) {
+			const long frameCount = lmin(framesMapped - framesRead, kLoadFramesPerPass);
+			status = (*this->_convertFunction)(_data_format,
+											   _chans,
+											   &_memBuffer[framesRead*_chans], _chans, (int)frameCount,
+											   src_chan_list, _chans,
+											   mapped + _data_location + (off_t)framesRead * bytesPerFrame);
+			framesRead += frameCount;
+		}
+		munmap(mapped, mappedLength);
+		return status;		// anything past the end of a short file stays zeroed
+	}
+
+	if (lseek(_fd, _data_location, SEEK_SET) == -1) {
+		perror("RTcmix::readFromInputFile (lseek)");
+        return FILE_ERROR;
+	}
 	const int framesPerRead = sScratchBufferSize / bytesPerFrame;
 	while (framesRead < inFrames) {
 		long frameCount = inFrames - framesRead;
@@ -663,14 +667,13 @@ int InputFile::loadSamps(long inFrames)
 			frameCount = framesPerRead;
 		const long byteCount = bytesPerFrame * frameCount;
 //		printf("reading %d frames (%d-channel) at offset %d via scratch buffer, into _memBuffer[%d*%d]\n", frameCount, _chans, lseek(_fd, 0, SEEK_CUR), framesRead, _chans);
-		status = (*this->_readFunction)(_fd,
-										_data_format,
-										_chans,
-										_data_location + bytesRead,
-										_endbyte,
-										&_memBuffer[framesRead*_chans], _chans, (int)frameCount,
-										src_chan_list, _chans,
-										sScratchBuffer);
+		status = read_file_bytes(_fd, _data_location + bytesRead, _endbyte, byteCount, sScratchBuffer);
+		if (status == 0)
+			status = (*this->_convertFunction)(_data_format,
+											   _chans,
+											   &_memBuffer[framesRead*_chans], _chans, (int)frameCount,
+											   src_chan_list, _chans,
+											   sScratchBuffer);
 		if (status != 0)
 			break;
 		framesRead += frameCount;
@@ -679,6 +682,71 @@ int InputFile::loadSamps(long inFrames)
 	return status;
 }
 
+// Map our file up to <inEndByte>, header and all.  A writable
+// mapping is private, so in-place byte swapping never reaches the file.
+// Returns NULL if the file cannot be mapped.
+
+char *InputFile::mapFile(off_t inEndByte, bool inWritable, off_t *outLength)
+{
+	struct stat st;
+	if (fstat(_fd, &st) == -1) {
+		perror("InputFile::mapFile (fstat)");
+		return NULL;
+	}
+	const off_t length = (st.st_size < inEndByte) ? st.st_size : inEndByte;
+	if (length <= _data_location)
+		return NULL;
+	const int prot = inWritable ? PROT_READ | PROT_WRITE : PROT_READ;
+	void *mapped = mmap(NULL, (size_t) length, prot, MAP_PRIVATE, _fd, 0);
+	if (mapped == MAP_FAILED) {
+		perror("InputFile::mapFile (mmap)");
+		return NULL;
+	}
+	*outLength = length;
+	return (char *) mapped;
+}
+
+// MappedType: de-interleave straight from the mapped file.  Native formats
+// need no swapping, so the converters only read from the mapping.
+
+off_t InputFile::readMappedSamps(off_t cur_offset,
+								 BufPtr dest,
+								 int dest_chans,
+								 int dest_frames,
+								 const short src_chan_list[],
+								 short src_chans)
+{
+	const int bytes_per_frame = ::mus_data_format_to_bytes_per_sample(_data_format) * _chans;
+	const long frames_remaining = lmax(0L, long((_mappedLength - cur_offset) / bytes_per_frame));
+	const int frames = (int) lmin(dest_frames, frames_remaining);
+
+	// Ask the kernel to fault in the next stretch before we get there.  Readers
+	// at other positions (or a rtinrepos) just move the hint; it is only advice.
+	static const long pageSize = sysconf(_SC_PAGESIZE);
+	const off_t advised = _adviseOffset.load(std::memory_order_relaxed);
+	const bool nearEnd = (cur_offset + kMapAdviseBytes / 2 > advised && advised < _mappedLength);
+	if (nearEnd || cur_offset + kMapAdviseBytes < advised) {
+		const off_t start = (cur_offset / pageSize) * pageSize;
+		const off_t end = lmin(long(start + kMapAdviseBytes), long(_mappedLength));
+		if (end > start) {
+			posix_madvise(_mappedFile + start, (size_t) (end - start), POSIX_MADV_WILLNEED);
+			_adviseOffset.store(end, std::memory_order_relaxed);
+		}
+	}
+	if (frames > 0) {
+		(*this->_convertFunction)(_data_format,
+								  _chans,
+								  dest, dest_chans, frames,
+								  src_chan_list, src_chans,
+								  _mappedFile + cur_offset);
+	}
+	/* If we reached EOF, zero out remaining part of buffer that we expected to fill. */
+	const long dest_samps = (long) dest_frames * dest_chans;
+	for (long n = lmax(0L, (long) frames * dest_chans); n < dest_samps; ++n)
+		dest[n] = 0.0;
+	return 0;
+}
+
 off_t InputFile::copySamps(off_t     cur_offset,       /* current file position - used to offset into cached waveform */
 				BufPtr      dest,             /* interleaved buffer from inst */
 				int         dest_chans,       /* number of chans interleaved */
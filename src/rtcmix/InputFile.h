@@ -12,15 +12,19 @@
 #include "rtdefs.h"
 #include <sys/types.h>
 #include <string.h>
+#include <atomic>
 
-typedef int (*ReadFun)(int,int,int,off_t,long,BufPtr,int,int,const short[],short,void*);
+typedef int (*ConvertFun)(int,int,BufPtr,int,int,const short[],short,void*);
+
+class ReadAheadCache;
+class InputResampler;
 
 /* definition of input file struct used by rtinput */
 struct InputFile : public Lockable {
 public:
-	enum Type { FileType = 0, AudioDeviceType = 1, InMemoryType = 2 };
+	enum Type { FileType = 0, AudioDeviceType = 1, InMemoryType = 2, MappedType = 3 };
 #ifdef MULTI_THREAD
-	static void createConversionBuffers(int inBufSamps);
+	static void createConversionBuffers(int inBufSamps, int inThreadCount);
 	static void destroyConversionBuffers();
 #endif
 	InputFile();
@@ -43,6 +47,9 @@ public:
 	short dataFormat() const { return _data_format; }
 	int dataLocation() const { return _data_location; }
 	double duration() const { return _dur; }
+	// Read-ahead cache statistics for streamed files (0 if there is no cache).
+	long readAheadHits() const;
+	long readAheadMisses() const;
 	
     off_t readSamps(off_t     cur_offset,       /* current file position before read */
                   BufPtr      dest,             /* interleaved buffer from inst */
@@ -50,14 +57,33 @@ public:
                   int         dest_frames,      /* frames in interleaved buffer */
                   const short src_chan_list[],  /* list of in-bus chan numbers from inst */
                   /* (or NULL to fill all chans) */
-                  short       src_chans         /* number of in-bus chans to copy */
+                  short       src_chans,        /* number of in-bus chans to copy */
+                  InputResampler *resampler = NULL  /* the inst's, if converting rate */
     );
 	bool isOpen() const { return _fd > 0 || _fd == USE_MM_BUF; }
 	int modTime() const { return _modTime; }
 	void setModTime(int inModTime) { _modTime = inModTime; }
 
 protected:
+	friend class InputResampler;
+	off_t readFrames(off_t     cur_offset,       /* current file position before read */
+				BufPtr      dest,             /* interleaved buffer from inst */
+				int         dest_chans,       /* number of chans interleaved */
+				int         dest_frames,      /* frames in interleaved buffer */
+				const short src_chan_list[],  /* list of in-bus chan numbers from inst */
+				/* (or NULL to fill all chans) */
+				short       src_chans         /* number of in-bus chans to copy */
+    );
 	int  loadSamps(long inFrames);
+	char *mapFile(off_t inEndByte, bool inWritable, off_t *outLength);
+	off_t readMappedSamps(off_t     cur_offset,       /* current file position before read */
+				BufPtr      dest,             /* interleaved buffer from inst */
+				int         dest_chans,       /* number of chans interleaved */
+				int         dest_frames,      /* frames in interleaved buffer */
+				const short src_chan_list[],  /* list of in-bus chan numbers from inst */
+				/* (or NULL to fill all chans) */
+				short       src_chans         /* number of in-bus chans to copy */
+    );
 	off_t copySamps(off_t     cur_offset,       /* current file position before read */
 				BufPtr      dest,             /* interleaved buffer from inst */
 				int         dest_chans,       /* number of chans interleaved */
@@ -72,7 +98,7 @@ protected:
 private:
 	char     *_filename;         /* allocated by rtinput() */
 	int      _fd;                /* file descriptor, or NO_FD, or AUDIO_DEVICE */
-	Type     _fileType;         /* FileType, AudioDeviceType, InMemoryType */
+	Type     _fileType;         /* FileType, AudioDeviceType, InMemoryType, MappedType */
 	short    _header_type;       /* e.g., AIFF_sound_file (in sndlib.h) */
 	short    _data_format;       /* e.g., snd_16_linear (in sndlib.h) */
 	short    _is_float_format;   /* true if data format is 32-bit float */
@@ -83,14 +109,19 @@ private:
 	double   _dur;
     void *	 _readBuffer;
     BufPtr 	 _memBuffer;
+	char *	 _mappedFile;		/* MappedType: whole file, mapped read-only */
+	off_t	 _mappedLength;
+	std::atomic<off_t> _adviseOffset;	/* MappedType: end of last MADV_WILLNEED range */
 	int      _refcount;
-    ReadFun  _readFunction;
+    ConvertFun _convertFunction;
+	ReadAheadCache *_readAhead;	/* for FileType only */
 	int		 _modTime;			/* used for live buffer mode */
 	float	 _gainScale;		/* same */
 	static const int	sScratchBufferSize = 4096;
 	static char			sScratchBuffer[];
 #ifdef MULTI_THREAD
-	static char *		sConversionBuffers[];
+	static char **		sConversionBuffers;		// one per thread
+	static int			sConversionBufferCount;
 #endif
 };
 
@@ -0,0 +1,89 @@
+// InputFileTable.cpp -- slots and name lookup for rtinput()'s InputFiles.
+//
+
+#include "InputFileTable.h"
+#include <ugens.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+InputFileTable::InputFileTable() : _chunks(NULL), _maxSlots(0), _slots(0)
+{
+}
+
+void InputFileTable::init(long inMaxSlots)
+{
+	clear();
+	_maxSlots = inMaxSlots;
+	// The chunk pointers are all made now, so that they never move.
+	_chunks = new InputFile *[(_maxSlots + kChunkSize - 1) / kChunkSize]();
+}
+
+void InputFileTable::clear()
+{
+	if (_chunks) {
+		for (int n = 0; n < _slots; n += kChunkSize)
+			delete [] _chunks[n >> kChunkShift];
+		delete [] _chunks;
+		_chunks = NULL;
+	}
+	_maxSlots = 0;
+	_slots = 0;
+	_entries.clear();
+}
+
+int InputFileTable::find(const char *inName)
+{
+	EntryMap::iterator it = _entries.find(inName);
+	if (it == _entries.end())
+		return -1;
+	const Entry &entry = it->second;
+	InputFile &inputFile = (*this)[entry.index];
+	// The file may have been closed, and its slot reused, since it was added.
+	if (!inputFile.isOpen() || !inputFile.hasFile(inName)) {
+		_entries.erase(it);
+		return -1;
+	}
+	if (entry.modTime != 0) {
+		struct stat st;
+		if (stat(inName, &st) == 0
+				&& (st.st_mtime != entry.modTime || st.st_size != entry.size)) {
+			rtcmix_advise("rtinput", "'%s' has changed since it was opened; opening it again", inName);
+			_entries.erase(it);
+			return -1;
+		}
+	}
+	return entry.index;
+}
+
+// Slots are given up when their last reference goes, without telling us, so
+// this looks through the slots made so far before making another.  That is
+// only a check of each slot's descriptor, and there are only as many slots
+// as files a score has had open at once.
+
+int InputFileTable::allocate()
+{
+	for (int i = 0; i < _slots; ++i) {
+		if (!(*this)[i].isOpen())
+			return i;
+	}
+	if (_slots >= _maxSlots)
+		return -1;
+	if ((_slots & kChunkMask) == 0)
+		_chunks[_slots >> kChunkShift] = new InputFile[kChunkSize];
+	return _slots++;
+}
+
+void InputFileTable::add(int index, const char *inName)
+{
+	Entry entry;
+	entry.index = index;
+	entry.modTime = 0;
+	entry.size = 0;
+	struct stat st;
+	if (stat(inName, &st) == 0) {
+		entry.modTime = st.st_mtime;
+		entry.size = st.st_size;
+	}
+	_entries[inName] = entry;
+}
@@ -0,0 +1,52 @@
+// InputFileTable.h
+//
+// The InputFiles opened by rtinput() and setInputBuffer(), by index.  Slots
+// are allocated in chunks as they are needed, up to a limit set from the
+// number of files the process may open, and a slot never moves once it
+// exists, so instruments can read through their index while the parser opens
+// more files.  A hash of names gives the slot already holding a file or
+// buffer.  Files are also keyed by their modification time and size, so a
+// file that has been rewritten since it was opened is opened again rather
+// than read through the stale header.
+//
+
+#ifndef _RT_INPUTFILETABLE_H_
+#define _RT_INPUTFILETABLE_H_
+
+#include "InputFile.h"
+#include <sys/types.h>
+#include <string>
+#include <unordered_map>
+
+class InputFileTable {
+public:
+	InputFileTable();
+	// Sets the most slots that will be handed out.
+	void		init(long inMaxSlots);
+	// Closes every file and frees all slots.
+	void		clear();
+	long		maxSlots() const { return _maxSlots; }
+	InputFile &	operator [] (int index) { return _chunks[index >> kChunkShift][index & kChunkMask]; }
+	// Returns the index of the open slot for <inName>, or -1.
+	int			find(const char *inName);
+	// Returns the index of a slot that is not open, or -1 if all
+	// maxSlots() are in use.
+	int			allocate();
+	// Records that slot <index> now holds <inName>.
+	void		add(int index, const char *inName);
+private:
+	enum { kChunkShift = 6, kChunkSize = 1 << kChunkShift, kChunkMask = kChunkSize - 1 };
+	struct Entry {
+		int		index;
+		time_t	modTime;		// 0 for buffers and audio devices
+		off_t	size;
+	};
+	typedef std::unordered_map<std::string, Entry> EntryMap;
+
+	InputFile **	_chunks;
+	long			_maxSlots;
+	int				_slots;			// slots allocated so far
+	EntryMap		_entries;
+};
+
+#endif	// _RT_INPUTFILETABLE_H_
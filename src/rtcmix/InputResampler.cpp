@@ -0,0 +1,285 @@
+// InputResampler.cpp -- polyphase sample rate conversion for input files.
+//
+
+#include "InputResampler.h"
+#include "InputFile.h"
+#include "RTcmix.h"
+#include <sndlibsupport.h>
+#include <ugens.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define RESAMPLE_SSE
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define RESAMPLE_NEON
+#endif
+
+typedef short HWORD;
+#include "../../utils/resample/smallfilter.h"
+#include "../../utils/resample/largefilter.h"
+
+using namespace std;
+
+// The utils/resample tables hold one wing of the impulse response, with 256
+// entries per zero crossing.
+static const int kTableSamplesPerZero = 256;
+
+static const int kPhaseBits = 8;
+static const int kPhases = 1 << kPhaseBits;
+static const int kFracShift = 32 - kPhaseBits;
+static const uint32_t kFracMask = (1U << kFracShift) - 1;
+static const float kFracScale = 1.0f / (1 << kFracShift);
+
+struct InputResampler::Filter {
+	int			quality;
+	uint64_t	step;
+	int			taps;		// a multiple of 4
+	int			left;		// taps before the source frame being read
+	float *		rows;		// kPhases + 1 rows of <taps> coefficients
+	float *		deltas;		// kPhases rows, each the next row minus this one
+};
+
+vector<InputResampler::Filter *>	InputResampler::sFilters;
+pthread_mutex_t						InputResampler::sFilterLock = PTHREAD_MUTEX_INITIALIZER;
+
+// The impulse response <zeros> zero crossings from its center.
+
+static double impulse(const HWORD *imp, int nwing, double zeros)
+{
+	const double x = fabs(zeros) * kTableSamplesPerZero;
+	const int i = (int) x;
+	if (i >= nwing - 1)
+		return 0.0;
+	return imp[i] + (x - i) * (imp[i + 1] - imp[i]);
+}
+
+// For downsampling, <inCutoff> is the output rate over the input rate, and
+// the filter is stretched by its inverse to cut off below the new Nyquist.
+// Each row is normalized to unity gain at DC.
+
+InputResampler::Filter *InputResampler::getFilter(int inQuality, uint64_t inStep, double inCutoff)
+{
+	pthread_mutex_lock(&sFilterLock);
+	for (size_t n = 0; n < sFilters.size(); ++n) {
+		if (sFilters[n]->quality == inQuality && sFilters[n]->step == inStep) {
+			Filter *filter = sFilters[n];
+			pthread_mutex_unlock(&sFilterLock);
+			return filter;
+		}
+	}
+
+	const HWORD *imp = (inQuality >= 2) ? LARGE_FILTER_IMP : SMALL_FILTER_IMP;
+	const int nwing = (inQuality >= 2) ? LARGE_FILTER_NWING : SMALL_FILTER_NWING;
+	const int wing = (int) ceil((double) (nwing / kTableSamplesPerZero) / inCutoff);
+
+	Filter *filter = new Filter;
+	filter->quality = inQuality;
+	filter->step = inStep;
+	filter->taps = (2 * wing + 3) & ~3;
+	filter->left = wing - 1;
+	const int taps = filter->taps;
+	filter->rows = new float[(kPhases + 1) * taps];
+	filter->deltas = new float[kPhases * taps];
+	for (int p = 0; p <= kPhases; ++p) {
+		const double frac = (double) p / kPhases;
+		double *row = new double[taps];
+		double sum = 0.0;
+		for (int j = 0; j < taps; ++j) {
+			row[j] = impulse(imp, nwing, (j - filter->left - frac) * inCutoff);
+			sum += row[j];
+		}
+		for (int j = 0; j < taps; ++j)
+			filter->rows[p * taps + j] = (float) (row[j] / sum);
+		delete [] row;
+	}
+	for (int p = 0; p < kPhases; ++p)
+		for (int j = 0; j < taps; ++j)
+			filter->deltas[p * taps + j] = filter->rows[(p + 1) * taps + j] - filter->rows[p * taps + j];
+	sFilters.push_back(filter);
+	pthread_mutex_unlock(&sFilterLock);
+	return filter;
+}
+
+void InputResampler::clearFilters()
+{
+	pthread_mutex_lock(&sFilterLock);
+	for (size_t n = 0; n < sFilters.size(); ++n) {
+		delete [] sFilters[n]->rows;
+		delete [] sFilters[n]->deltas;
+		delete sFilters[n];
+	}
+	sFilters.clear();
+	pthread_mutex_unlock(&sFilterLock);
+}
+
+// The filter <frac> of the way from <row> to the next one.
+
+static inline void interpolateRow(const float *row, const float *delta, float frac,
+								  float *out, int taps)
+{
+#if defined(RESAMPLE_SSE)
+	const __m128 vfrac = _mm_set1_ps(frac);
+	for (int j = 0; j < taps; j += 4)
+		_mm_storeu_ps(&out[j], _mm_add_ps(_mm_loadu_ps(&row[j]),
+										  _mm_mul_ps(_mm_loadu_ps(&delta[j]), vfrac)));
+#elif defined(RESAMPLE_NEON)
+	for (int j = 0; j < taps; j += 4)
+		vst1q_f32(&out[j], vmlaq_n_f32(vld1q_f32(&row[j]), vld1q_f32(&delta[j]), frac));
+#else
+	for (int j = 0; j < taps; ++j)
+		out[j] = row[j] + delta[j] * frac;
+#endif
+}
+
+static inline float dotProduct(const float *x, const float *c, int taps)
+{
+#if defined(RESAMPLE_SSE)
+	__m128 sum = _mm_setzero_ps();
+	for (int j = 0; j < taps; j += 4)
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&x[j]), _mm_loadu_ps(&c[j])));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+#elif defined(RESAMPLE_NEON)
+	float32x4_t sum = vdupq_n_f32(0.0f);
+	for (int j = 0; j < taps; j += 4)
+		sum = vmlaq_f32(sum, vld1q_f32(&x[j]), vld1q_f32(&c[j]));
+	return vaddvq_f32(sum);
+#else
+	float sum = 0.0f;
+	for (int j = 0; j < taps; ++j)
+		sum += x[j] * c[j];
+	return sum;
+#endif
+}
+
+InputResampler::InputResampler(InputFile *inFile, double inOutputRate, int inQuality)
+	: _file(inFile), _chans(inFile->channels()),
+	  _frameBytes(::mus_data_format_to_bytes_per_sample(inFile->dataFormat()) * inFile->channels()),
+	  _dataLocation(inFile->dataLocation()), _frame(0), _frac(0), _offset(-1),
+	  _base(0), _count(0)
+{
+	const double ratio = inFile->sampleRate() / inOutputRate;
+	_step = (uint64_t) llround(ratio * 4294967296.0);
+	_filter = getFilter(inQuality, _step, (ratio > 1.0) ? 1.0 / ratio : 1.0);
+	_readFrames = RTcmix::bufsamps();
+	// Enough for the frames under the filter for a whole buffer of output.
+	_capacity = (int) ceil(RTcmix::bufsamps() * ratio) + _filter->taps + 2;
+	_history = new float *[_chans];
+	for (int n = 0; n < _chans; ++n)
+		_history[n] = new float[_capacity];
+	_scratch = new float[_readFrames * _chans];
+	_coeffs = new float[_filter->taps];
+}
+
+InputResampler::~InputResampler()
+{
+	for (int n = 0; n < _chans; ++n)
+		delete [] _history[n];
+	delete [] _history;
+	delete [] _scratch;
+	delete [] _coeffs;
+}
+
+// The instrument's offset is not where we left it, so it seeked itself, or
+// this is its first read.  Start over at the frame it names.
+
+void InputResampler::sync(off_t cur_offset)
+{
+	_frame = (cur_offset - _dataLocation) / _frameBytes;
+	_frac = 0;
+	_offset = cur_offset;
+}
+
+// Makes the history hold the source frames [inFirst, inEnd), keeping those
+// it has.  Frames before the start of the file are silence; reads past the
+// end are zeroed by the InputFile.
+
+void InputResampler::fill(int64_t inFirst, int64_t inEnd)
+{
+	if (inFirst < _base || inFirst > _base + _count) {
+		_base = inFirst;
+		_count = 0;
+	}
+	else if (inFirst > _base) {
+		const int drop = (int) (inFirst - _base);
+		_count -= drop;
+		for (int n = 0; n < _chans; ++n)
+			memmove(_history[n], &_history[n][drop], _count * sizeof(float));
+		_base = inFirst;
+	}
+	int64_t next = _base + _count;
+	while (next < inEnd) {
+		int frames = (int) ((inEnd - next < _readFrames) ? inEnd - next : _readFrames);
+		if (next < 0) {
+			if (frames > -next)
+				frames = (int) -next;
+			for (int n = 0; n < _chans; ++n)
+				memset(&_history[n][_count], 0, frames * sizeof(float));
+		}
+		else {
+			const off_t offset = _dataLocation + next * _frameBytes;
+			if (_file->readFrames(offset, _scratch, _chans, frames, NULL, _chans) < 0)
+				memset(_scratch, 0, frames * _chans * sizeof(float));
+			for (int n = 0; n < _chans; ++n) {
+				float *hist = &_history[n][_count];
+				const float *src = &_scratch[n];
+				for (int i = 0; i < frames; ++i, src += _chans)
+					hist[i] = *src;
+			}
+		}
+		_count += frames;
+		next += frames;
+	}
+}
+
+off_t InputResampler::read(off_t cur_offset, BufPtr dest, int dest_chans, int dest_frames)
+{
+	if (cur_offset != _offset)
+		sync(cur_offset);
+	const int taps = _filter->taps;
+	const int left = _filter->left;
+	const int64_t startFrame = _frame;
+	const uint64_t lastPos = _frac + (uint64_t) (dest_frames - 1) * _step;
+	const int64_t lastFrame = _frame + (int64_t) (lastPos >> 32);
+	fill(_frame - left, lastFrame - left + taps);
+
+	const int chans = (dest_chans < _chans) ? dest_chans : _chans;
+	for (int i = 0; i < dest_frames; ++i) {
+		const int phase = _frac >> kFracShift;
+		interpolateRow(&_filter->rows[phase * taps], &_filter->deltas[phase * taps],
+					   (_frac & kFracMask) * kFracScale, _coeffs, taps);
+		const int index = (int) (_frame - left - _base);
+		BufPtr out = &dest[i * dest_chans];
+		for (int n = 0; n < chans; ++n)
+			out[n] = dotProduct(&_history[n][index], _coeffs, taps);
+		const uint64_t pos = (uint64_t) _frac + _step;
+		_frame += (int64_t) (pos >> 32);
+		_frac = (uint32_t) pos;
+	}
+	const off_t advance = (off_t) (_frame - startFrame) * _frameBytes;
+	_offset = cur_offset + advance;
+	return advance;
+}
+
+off_t InputResampler::seek(off_t cur_offset, int frames, int whence)
+{
+	if (cur_offset != _offset)
+		sync(cur_offset);
+	const double step = _step / 4294967296.0;
+	double pos = frames * step;
+	if (whence == SEEK_CUR)
+		pos += _frame + _frac / 4294967296.0;
+	if (pos < 0.0)
+		pos = 0.0;
+	_frame = (int64_t) pos;
+	_frac = (uint32_t) ((pos - _frame) * 4294967296.0);
+	_offset = _dataLocation + (off_t) _frame * _frameBytes;
+	return _offset;
+}
@@ -0,0 +1,72 @@
+// InputResampler.h
+//
+// Sample rate converter between an input file and an instrument reading it,
+// for files whose rate is not sr().  Each instrument reading such a file gets
+// its own, holding its position between samples and the source frames around
+// it, and InputFile::readSamps() hands its reads to it.  The instrument sees
+// the file as if it were at sr():  rtgetin() fills its buffer with converted
+// frames, and rtinrepos() moves by frames at sr().  The instrument's
+// fileOffset still follows the source frame it is reading, so the sound file
+// and read-ahead code see ordinary reads.
+//
+// The filters are the windowed sincs from utils/resample, turned into tables
+// of float coefficients at 256 positions between samples for each rate ratio,
+// and shared by every converter with that ratio and quality.  They are made
+// when an instrument attaches to the file, so nothing here allocates while
+// reading.
+//
+
+#ifndef _RT_INPUTRESAMPLER_H_
+#define _RT_INPUTRESAMPLER_H_
+
+#include <rt_types.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <pthread.h>
+#include <vector>
+
+struct InputFile;
+
+class InputResampler {
+public:
+	// <inQuality> is 1 for the short filter or 2 for the long one.
+	InputResampler(InputFile *inFile, double inOutputRate, int inQuality);
+	~InputResampler();
+	// Converts <dest_frames> frames starting at <cur_offset>, the reader's
+	// file offset, into <dest>.  Returns the bytes to advance the offset by.
+	off_t	read(off_t cur_offset, BufPtr dest, int dest_chans, int dest_frames);
+	// Moves the reader by <frames> at the output rate, from the start of the
+	// file for SEEK_SET or from where it is for SEEK_CUR.  Returns the new
+	// file offset.
+	off_t	seek(off_t cur_offset, int frames, int whence);
+	// Frees the filters, once no instruments are left.
+	static void	clearFilters();
+
+private:
+	struct Filter;
+	static Filter *	getFilter(int inQuality, uint64_t inStep, double inCutoff);
+	void	sync(off_t cur_offset);
+	void	fill(int64_t inFirst, int64_t inEnd);
+
+	static std::vector<Filter *>	sFilters;
+	static pthread_mutex_t			sFilterLock;
+
+	InputFile *	_file;
+	Filter *	_filter;
+	int			_chans;
+	int			_frameBytes;
+	off_t		_dataLocation;
+	uint64_t	_step;			// source frames per output frame, 32.32
+	int64_t		_frame;			// source frame we are at
+	uint32_t	_frac;			// and the fraction past it
+	off_t		_offset;		// file offset we expect to be called with
+	float **	_history;		// source frames [_base, _base + _count), per chan
+	int64_t		_base;
+	int			_count;
+	int			_capacity;
+	float *		_scratch;		// interleaved frames read from the file
+	int			_readFrames;	// most frames per read from the file
+	float *		_coeffs;		// filter for the current output frame
+};
+
+#endif	// _RT_INPUTRESAMPLER_H_
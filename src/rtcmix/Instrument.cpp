@@ -14,6 +14,7 @@
 #include <sndlibsupport.h>
 #include <bus.h>
 #include "BusSlot.h"
+#include "InputResampler.h"
 #include <assert.h>
 #include <ugens.h>
 #include "heap/heap.h"
@@ -21,6 +22,7 @@
 #include <PFieldSet.h>
 #include <maxdispargs.h>
 #include <PFBusData.h>
+#include <RTOption.h>
 
 #undef DEBUG_INST
 #define DEBUG_BUFFER 0  /* this turns it off */
@@ -28,10 +30,16 @@
 using namespace std;
 
 InputState::InputState()
-: fdIndex(NO_DEVICE_FDINDEX), fileOffset(0), inputsr(0.0), inputchans(0), inputNsamps(0)
+: fdIndex(NO_DEVICE_FDINDEX), fileOffset(0), inputsr(0.0), inputchans(0), inputNsamps(0),
+  resampler(NULL)
 {
 }
 
+InputState::~InputState()
+{
+	delete resampler;
+}
+
 int				Instrument::RTBUFSAMPS = 0;
 int				Instrument::NCHANS = 0;
 float			Instrument::SR     = 0;
@@ -40,7 +48,8 @@ float			Instrument::SR     = 0;
 Instrument::Instrument() : RefCounted(true),
 	  _start(0.0), _dur(0.0), cursamp(0), chunksamps(0), i_chunkstart(0),
 	  endsamp(0), output_offset(0), outputchans(0), _name(NULL),
-	  needs_to_run(true), _nsamps(0), inputChainBuf(NULL)
+	  needs_to_run(true), _nsamps(0), _finished(false), _audible(false),
+	  _silentBlocks(0), inputChainBuf(NULL)
 {
 #if defined(DEBUG_MEMORY) || defined(DEBUG_INST)
 	rtcmix_print("Instrument::Instrument(this = %p)\n", this);
@@ -208,6 +217,36 @@ double Instrument::update(int index, int totframes, int curFrame)
 }
 
 
+// Block-rate version of the first update():  fills p[n][0 .. frames-1] with
+// pfield n's value at each of the next <frames> frames, starting at
+// currentFrame().  Pfields past the ones given in the score are zeroed.  This
+// costs far less per value than calling update() every frame, but stateful
+// pfields (LFOs, randoms, smoothers) advance once per value, so keep using
+// update() at the control rate for those.
+
+int Instrument::updateBlock(double *p[], int nvalues, int frames, unsigned fields)
+{
+	int n, args = _pfields->size();
+	if (nvalues < args)
+		args = nvalues;
+	const double start = (double) currentFrame() / nSamps();
+	const double end = (double) (currentFrame() + frames) / nSamps();
+	_pfields->fill(p, args, frames, start, end, fields);
+	for (n = args; n < nvalues; ++n) {
+		for (int i = 0; i < frames; ++i)
+			p[n][i] = 0.0;
+	}
+
+	// my_pfbus is set using the bus_link() thing, check this bus for de-queing
+	if (my_pfbus != -1) {
+		if (PFBusData::dq_now[my_pfbus] == 1)
+			setendsamp(0);
+	}
+
+	return 0;
+}
+
+
 /* ------------------------------------------------------------ init() --- */
 
 // This function is now called by setup().
@@ -274,12 +313,53 @@ int Instrument::run(bool needsTo)
 	   int status = run();	// Class-specific run().
 
 	   needs_to_run = false;
+	   checkSilence();
 
 	   return status;
    }
    return 0;
 }
 
+/* --------------------------------------------------------------- finish --- */
+/* Ends the note with the chunk now being run.  inTraverse re-queues an
+   instrument only while its endsamp lies beyond the current buffer, so
+   pulling endsamp in to the end of this chunk retires it just as if its
+   duration had run out.  (Instruments run inside CHAIN aren't scheduled,
+   and CHAIN checks isDone() instead.)
+*/
+void Instrument::finish()
+{
+	_finished = true;
+	const FRAMETYPE chunkEnd = i_chunkstart + framesToRun();
+	if (chunkEnd < getendsamp())
+		setendsamp(chunkEnd);
+}
+
+/* --------------------------------------------------------- checkSilence --- */
+/* If the "silence_blocks" option is set, a note that has made sound and then
+   stays below -120 dB for that many buffers in a row is finished, so that
+   decayed tails stop costing CPU.  Notes that have not yet made a sound are
+   left alone, since they may be waiting for input or an envelope.
+*/
+static const BUFTYPE kSilenceThreshold = 32768.0 * 1.0e-6;	// -120 dB
+
+void Instrument::checkSilence()
+{
+	const int blocks = RTOption::silenceBlocks();
+	if (blocks <= 0 || _finished)
+		return;
+	const int samps = framesToRun() * outputchans;
+	for (int i = 0; i < samps; i++) {
+		if (outbuf[i] > kSilenceThreshold || outbuf[i] < -kSilenceThreshold) {
+			_audible = true;
+			_silentBlocks = 0;
+			return;
+		}
+	}
+	if (_audible && ++_silentBlocks >= blocks)
+		finish();
+}
+
 void Instrument::configureEndSamp(FRAMETYPE *pStartSamp)
 {
 	// Calculate variables for heap insertion
@@ -19,14 +19,17 @@ class heap;
 class PFieldSet;
 class PField;
 class BusSlot;
+class InputResampler;
 
 struct InputState {
    InputState();
+   ~InputState();
    int            fdIndex;         // index into unix input file desc. table
    off_t          fileOffset;      // current offset in file for this inst
    double         inputsr;		   // SR of input file
    int            inputchans;	   // Chans of input file
    int            inputNsamps;	   // length in samps of input file
+   InputResampler *resampler;      // if file SR is not sr(), else NULL
 };
 
 class Instrument : public RefCounted {
@@ -66,6 +69,9 @@ private:
    bool           needs_to_run;
    int            _skip;
    int            _nsamps;
+   bool           _finished;       // set by finish()
+   bool           _audible;        // for the silence check in run()
+   int            _silentBlocks;
 	// CHAINED INSTRUMENT SUPPORT
 	BUFTYPE *		inputChainBuf;			// buffer used as input by rtgetin()
 	// BGG -- for pfbus connection (dynamic PFields)
@@ -86,6 +92,10 @@ public:
 	// Use this to increment cursamp inside block-based run loops.
 	void	    	increment(int amount) { cursamp += amount; }
 	void			setendsamp(FRAMETYPE end) { endsamp = end; }
+	// Call this from run() when the note has nothing more to play.  The
+	// scheduler drops it after the current buffer, as if its duration had
+	// run out.
+	void			finish();
 	bool			needsToRun() const { return needs_to_run; }
 	// These inlines are declared at bottom of this header.
 	inline float	getstart() const;
@@ -105,10 +115,11 @@ public:
 	int				run(bool needsTo);
 	virtual int		update(double *, int , unsigned fields=0);	// Called by run()
 	double			update(int index, int totframes=0, int curFrame=-1);
+	int				updateBlock(double *p[], int nvalues, int frames, unsigned fields=0);
 
 	int				exec(BusType bus_type, int bus);
 	void			addout(BusType bus_type, int bus);
-	bool			isDone() const { return cursamp >= _nsamps; }
+	bool			isDone() const { return _finished || cursamp >= _nsamps; }
 	const char *	name() const { return _name; }
 
 	// These are called by the base class methods declared above.
@@ -145,6 +156,7 @@ protected:
 
 private:
    void				gone(); // decrements reference to input soundfile
+   void				checkSilence();
 };
 
 /* ------------------------------------------------------------- getstart --- */
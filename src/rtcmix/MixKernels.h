@@ -0,0 +1,111 @@
+/* RTcmix  - Copyright (C) 2000  The RTcmix Development Team
+   See ``AUTHORS'' for a list of contributors. See ``LICENSE'' for
+   the license to this software and for a DISCLAIMER OF ALL WARRANTIES.
+*/
+
+// MixKernels.h -- loops which add one channel of an instrument's interleaved
+// output buffer into a bus.  Mono and stereo instruments, which are most of
+// them, get SSE, AVX or NEON versions when the compiler targets those.
+
+#ifndef _MIXKERNELS_H_
+#define _MIXKERNELS_H_
+
+#include <rt_types.h>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+// Any channel count.  This is the original 4-way unrolled strided add.
+
+inline void mixStrided(BufPtr dest, const BUFTYPE *src, int frames, int chans)
+{
+	const int framesOverFour = frames >> 2;
+	const int framesRemaining = frames - (framesOverFour << 2);
+	const int chansx2 = chans << 1;
+	const int chansx3 = chansx2 + chans;
+	const int chansx4 = chansx2 + chansx2;
+	for (int n = 0; n < framesOverFour; ++n) {
+		dest[0] += src[0];
+		dest[1] += src[chans];
+		dest[2] += src[chansx2];
+		dest[3] += src[chansx3];
+		dest += 4;
+		src += chansx4;
+	}
+	for (int n = 0; n < framesRemaining; ++n) {
+		dest[n] += *src;
+		src += chans;
+	}
+}
+
+// One channel: a straight vector add.
+
+inline void mixMono(BufPtr dest, const BUFTYPE *src, int frames)
+{
+	int n = 0;
+#if defined(__AVX__)
+	for (; n + 8 <= frames; n += 8)
+		_mm256_storeu_ps(&dest[n], _mm256_add_ps(_mm256_loadu_ps(&dest[n]), _mm256_loadu_ps(&src[n])));
+#elif defined(__SSE2__)
+	for (; n + 4 <= frames; n += 4)
+		_mm_storeu_ps(&dest[n], _mm_add_ps(_mm_loadu_ps(&dest[n]), _mm_loadu_ps(&src[n])));
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; n + 4 <= frames; n += 4)
+		vst1q_f32(&dest[n], vaddq_f32(vld1q_f32(&dest[n]), vld1q_f32(&src[n])));
+#endif
+	for (; n < frames; ++n)
+		dest[n] += src[n];
+}
+
+// Two channels: add every other sample of <src>, starting with the first.
+// The vector loops load both samples of each frame, so they stop one frame
+// early to avoid reading past the end of the buffer when <src> is channel 1.
+
+inline void mixStereo(BufPtr dest, const BUFTYPE *src, int frames)
+{
+	int n = 0;
+#if defined(__AVX2__)
+	for (; n + 8 < frames; n += 8) {
+		const __m256 lo = _mm256_loadu_ps(&src[2 * n]);
+		const __m256 hi = _mm256_loadu_ps(&src[2 * n + 8]);
+		// Evens of each 128-bit lane, then put the 64-bit halves back in order.
+		const __m256 evens = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+		const __m256 ordered = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(evens), _MM_SHUFFLE(3, 1, 2, 0)));
+		_mm256_storeu_ps(&dest[n], _mm256_add_ps(_mm256_loadu_ps(&dest[n]), ordered));
+	}
+#elif defined(__SSE2__)
+	for (; n + 4 < frames; n += 4) {
+		const __m128 lo = _mm_loadu_ps(&src[2 * n]);
+		const __m128 hi = _mm_loadu_ps(&src[2 * n + 4]);
+		const __m128 evens = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+		_mm_storeu_ps(&dest[n], _mm_add_ps(_mm_loadu_ps(&dest[n]), evens));
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; n + 4 < frames; n += 4) {
+		const float32x4x2_t pair = vld2q_f32(&src[2 * n]);
+		vst1q_f32(&dest[n], vaddq_f32(vld1q_f32(&dest[n]), pair.val[0]));
+	}
+#endif
+	for (; n < frames; ++n)
+		dest[n] += src[2 * n];
+}
+
+inline void mixFrames(BufPtr dest, const BUFTYPE *src, int frames, int chans)
+{
+	switch (chans) {
+	case 1:
+		mixMono(dest, src, frames);
+		break;
+	case 2:
+		mixStereo(dest, src, frames);
+		break;
+	default:
+		mixStrided(dest, src, frames, chans);
+		break;
+	}
+}
+
+#endif	// _MIXKERNELS_H_
@@ -0,0 +1,39 @@
+// NameTable.h
+//
+// Hash table keyed by C string, for the function and instrument registries.
+// The table does not copy its keys, so each key must live at least as long
+// as its entry (the registries use static labels or strings owned by the
+// entry itself).
+//
+
+#ifndef _RT_NAMETABLE_H_
+#define _RT_NAMETABLE_H_
+
+#include <string.h>
+#include <stddef.h>
+#include <unordered_map>
+
+struct NameHash {
+	size_t operator()(const char *name) const {
+		size_t hash = 2166136261u;		// FNV-1a
+		while (*name)
+			hash = (hash ^ (unsigned char) *name++) * 16777619u;
+		return hash;
+	}
+};
+
+struct NameEqual {
+	bool operator()(const char *a, const char *b) const { return strcmp(a, b) == 0; }
+};
+
+template <typename T>
+class NameTable : public std::unordered_map<const char *, T, NameHash, NameEqual> {
+public:
+	// Returns T() (e.g., NULL) if <name> is not in the table.
+	T lookup(const char *name) const {
+		typename NameTable::const_iterator it = this->find(name);
+		return (it != this->end()) ? it->second : T();
+	}
+};
+
+#endif	// _RT_NAMETABLE_H_
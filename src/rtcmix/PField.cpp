@@ -66,6 +66,13 @@ int PField::copyValues(double *array) const
 	return len;
 }
 
+void PField::fill(double *values, int count, double start, double end) const
+{
+	const double step = (end - start) / count;
+	for (int n = 0; n < count; ++n)
+		values[n] = doubleValue(start + n * step);
+}
+
 // SingleValuePField
 
 double SingleValuePField::doubleValue(double) const
@@ -79,6 +86,13 @@ ConstPField::ConstPField(double value) : SingleValuePField(value) {}
 
 ConstPField::~ConstPField() {}
 
+void ConstPField::fill(double *values, int count, double, double) const
+{
+	const double value = SingleValuePField::doubleValue(0.0);
+	for (int n = 0; n < count; ++n)
+		values[n] = value;
+}
+
 
 // StringPField
 
@@ -137,6 +151,41 @@ double PFieldBinaryOperator::doubleValue(double frac) const
 	return (*_operator)(_pfield1->doubleValue(frac), _pfield2->doubleValue(frac));
 }
 
+// Operands are filled a chunk at a time, so each child is asked for a whole
+// chunk before the next child is evaluated.
+
+void PFieldBinaryOperator::fill(double *values, int count, double start, double end) const
+{
+	double operand[kFillChunk];
+	const double step = (end - start) / count;
+	for (int done = 0; done < count; done += kFillChunk) {
+		const int chunk = min(kFillChunk, count - done);
+		const double chunkStart = start + done * step;
+		const double chunkEnd = chunkStart + chunk * step;
+		_pfield1->fill(&values[done], chunk, chunkStart, chunkEnd);
+		_pfield2->fill(operand, chunk, chunkStart, chunkEnd);
+		combine(&values[done], operand, chunk);
+	}
+}
+
+void PFieldBinaryOperator::combine(double *values, const double *operand, int count) const
+{
+	for (int n = 0; n < count; ++n)
+		values[n] = (*_operator)(values[n], operand[n]);
+}
+
+void AddPField::combine(double *values, const double *operand, int count) const
+{
+	for (int n = 0; n < count; ++n)
+		values[n] += operand[n];
+}
+
+void MultPField::combine(double *values, const double *operand, int count) const
+{
+	for (int n = 0; n < count; ++n)
+		values[n] *= operand[n];
+}
+
 int PFieldBinaryOperator::values() const
 {
 	const int len1 = _pfield1->values();
@@ -271,22 +320,37 @@ double RandomPField::doubleValue(double percent) const
 TablePField::TablePField(double *tableArray,
 						 int length,
 						 TablePField::InterpFunction ifun)
-	: _table(tableArray), _len(length), _interpolator(ifun)
+	: _table(tableArray), _floatTable(NULL), _doubleView(NULL), _len(length),
+	  _interpolator(ifun)
+{
+}
+
+TablePField::TablePField(float *tableArray,
+						 int length,
+						 TablePField::InterpFunction ifun)
+	: _table(NULL), _floatTable(tableArray), _doubleView(NULL), _len(length),
+	  _interpolator(ifun)
 {
 }
 
 TablePField::~TablePField()
 {
 	delete [] _table;
+	delete [] _floatTable;
+	delete [] _doubleView.load();
 }
 
-double TablePField::Truncate(double *tab, int len, double didx)
+// The interpolators are written once for both storage types.
+
+template <typename T>
+static inline double tableTruncate(const T *tab, int len, double didx)
 {
 	const int idx = int(didx);
 	return tab[idx];
 }
 
-double TablePField::Interpolate1stOrder(double *tab, int len, double didx)
+template <typename T>
+static inline double tableInterp1stOrder(const T *tab, int len, double didx)
 {
 	const int idx = int(didx);
 	const int idx2 = min(idx + 1, len - 1);
@@ -294,7 +358,8 @@ double TablePField::Interpolate1stOrder(double *tab, int len, double didx)
 	return tab[idx] + frac * (tab[idx2] - tab[idx]);
 }
 
-double TablePField::Interpolate2ndOrder(double *tab, int len, double didx)
+template <typename T>
+static inline double tableInterp2ndOrder(const T *tab, int len, double didx)
 {
 	const int idx = int(didx);
 	const int idx2 = min(idx + 1, len - 1);
@@ -308,9 +373,44 @@ double TablePField::Interpolate2ndOrder(double *tab, int len, double didx)
 	return a + (b * frac) + (c * frac * frac);
 }
 
+double TablePField::Truncate(double *tab, int len, double didx)
+{
+	return tableTruncate(tab, len, didx);
+}
+
+double TablePField::Interpolate1stOrder(double *tab, int len, double didx)
+{
+	return tableInterp1stOrder(tab, len, didx);
+}
+
+double TablePField::Interpolate2ndOrder(double *tab, int len, double didx)
+{
+	return tableInterp2ndOrder(tab, len, didx);
+}
+
+// Make the double copy of a float table.  Two threads may race to do this;
+// the loser throws its copy away.
+
+TablePField::operator double *() const
+{
+	double *table = doubleTable();
+	if (table == NULL && _floatTable != NULL) {
+		double *view = new double[_len];
+		for (int n = 0; n < _len; ++n)
+			view[n] = _floatTable[n];
+		if (_doubleView.compare_exchange_strong(table, view, std::memory_order_acq_rel))
+			table = view;
+		else
+			delete [] view;
+	}
+	return table;
+}
+
 double TablePField::doubleValue(int indx) const
 {
-	return _table[min(indx, values() - 1)];
+	const double *table = doubleTable();
+	const int idx = min(indx, values() - 1);
+	return table ? table[idx] : _floatTable[idx];
 }
 
 double TablePField::doubleValue(double percent) const
@@ -319,28 +419,87 @@ double TablePField::doubleValue(double percent) const
 		percent = 1.0;
 	const int len = values();
 	double didx = (len - 1) * percent;
-	return (*_interpolator)(_table, len, didx);
+	double *table = doubleTable();
+	if (table)
+		return (*_interpolator)(table, len, didx);
+	if (_interpolator == Interpolate1stOrder)
+		return tableInterp1stOrder(_floatTable, len, didx);
+	if (_interpolator == Interpolate2ndOrder)
+		return tableInterp2ndOrder(_floatTable, len, didx);
+	if (_interpolator == Truncate)
+		return tableTruncate(_floatTable, len, didx);
+	return (*_interpolator)((double *) *this, len, didx);
 }
 
 int TablePField::print(FILE *file) const
 {
 	int chars = 0;
 	for (int i = 0; i < values(); i++) {
-		chars += fprintf(file, "%.6f\n", _table[i]);
+		chars += fprintf(file, "%.6f\n", doubleValue(i));
 	}
 	return chars;
 }
 
-// Optimized version for table
+// Block fill with the interpolator known at compile time, so it inlines.
+
+template <typename T, double (*Interpolator)(const T *, int, double)>
+static void fillFromTable(const T *table, int len, double *values, int count, double start, double step)
+{
+	const double scale = len - 1;
+	for (int n = 0; n < count; ++n) {
+		double percent = start + n * step;
+		if (percent > 1.0)
+			percent = 1.0;
+		values[n] = Interpolator(table, len, scale * percent);
+	}
+}
+
+template <typename T>
+static bool fillFromTable(TablePField::InterpFunction fun, const T *table, int len,
+						  double *values, int count, double start, double step)
+{
+	if (fun == TablePField::Interpolate1stOrder)
+		fillFromTable<T, tableInterp1stOrder<T> >(table, len, values, count, start, step);
+	else if (fun == TablePField::Interpolate2ndOrder)
+		fillFromTable<T, tableInterp2ndOrder<T> >(table, len, values, count, start, step);
+	else if (fun == TablePField::Truncate)
+		fillFromTable<T, tableTruncate<T> >(table, len, values, count, start, step);
+	else
+		return false;
+	return true;
+}
+
+void TablePField::fill(double *values, int count, double start, double end) const
+{
+	const double step = (end - start) / count;
+	const double *table = doubleTable();
+	const bool filled = table
+		? fillFromTable(_interpolator, table, _len, values, count, start, step)
+		: fillFromTable(_interpolator, (const float *) _floatTable, _len, values, count, start, step);
+	if (!filled)
+		PField::fill(values, count, start, end);
+}
 
 int TablePField::copyValues(double *array) const
 {
 	const int len = values();
-	for (int n = 0; n < len; ++n)
-		array[n] = _table[n];
+	const double *table = doubleTable();
+	if (table) {
+		for (int n = 0; n < len; ++n)
+			array[n] = table[n];
+	}
+	else {
+		for (int n = 0; n < len; ++n)
+			array[n] = _floatTable[n];
+	}
 	return len;
 }
 
+size_t TablePField::storageBytes() const
+{
+	return _floatTable ? _len * sizeof(float) : _len * sizeof(double);
+}
+
 // PFieldWrapper
 
 PFieldWrapper::PFieldWrapper(PField *innerPField)
@@ -735,6 +894,33 @@ double RangePField::doubleValue(int idx) const
 	return (*_rangefitter)(normval, min, max);
 }
 
+void RangePField::fill(double *values, int count, double start, double end) const
+{
+	double minValues[kFillChunk], maxValues[kFillChunk];
+	const double step = (end - start) / count;
+	for (int done = 0; done < count; done += kFillChunk) {
+		const int chunk = min(kFillChunk, count - done);
+		const double chunkStart = start + done * step;
+		const double chunkEnd = chunkStart + chunk * step;
+		double *vals = &values[done];
+		_minPField->fill(minValues, chunk, chunkStart, chunkEnd);
+		_maxPField->fill(maxValues, chunk, chunkStart, chunkEnd);
+		field()->fill(vals, chunk, chunkStart, chunkEnd);
+		if (_rangefitter == UnipolarSource) {
+			for (int n = 0; n < chunk; ++n)
+				vals[n] = minValues[n] + (vals[n] * (maxValues[n] - minValues[n]));
+		}
+		else if (_rangefitter == BipolarSource) {
+			for (int n = 0; n < chunk; ++n)
+				vals[n] = minValues[n] + ((vals[n] + 1.0) * 0.5 * (maxValues[n] - minValues[n]));
+		}
+		else {
+			for (int n = 0; n < chunk; ++n)
+				vals[n] = (*_rangefitter)(vals[n], minValues[n], maxValues[n]);
+		}
+	}
+}
+
 // SmoothPField
 
 SmoothPField::SmoothPField(PField *innerPField, double krate, PField *lagPField,
@@ -1075,6 +1261,13 @@ double ConverterPField::doubleValue(int idx) const
 	return (*_converter)(val);
 }  
 
+void ConverterPField::fill(double *values, int count, double start, double end) const
+{
+	field()->fill(values, count, start, end);
+	for (int n = 0; n < count; ++n)
+		values[n] = (*_converter)(values[n]);
+}
+
 #include <ugens.h>
 
 double ConverterPField::ampdb(const double db)
@@ -10,9 +10,18 @@
 
 #include <RefCounted.h>
 #include <stdio.h>
+#include <atomic>
 
 // Base class for all PFields.  Value can be retrieved at any time in any
 // of the 3 supported formats.
+//
+// fill() is the block-rate interface:  it writes <count> values, the nth taken
+// at percent <start> + n * (<end> - <start>) / <count>, so a block of frames
+// [F, F + count) in a note of N frames is fill(vals, count, F/N, (F+count)/N).
+// The default calls doubleValue() once per value;  constant, table, operator,
+// range and converter PFields override it with loops that make no virtual
+// calls.  PFields that keep state (LFO, random, smooth, delay) still advance
+// once per value, so ask them for values at the control rate.
 
 class PField : public RefCounted {
 public:
@@ -28,6 +37,9 @@ public:
 	virtual operator double *() const { /* default is to */ return 0; }
 	virtual int		copyValues(double *) const;
 	virtual int		values() const = 0;
+	virtual void	fill(double *values, int count, double start, double end) const;
+	// Operator and wrapper PFields fill their operands this many values at a time.
+	static const int kFillChunk = 64;
 protected:
 	PField();
 	virtual 		~PField();
@@ -52,6 +64,7 @@ private:
 class ConstPField : public SingleValuePField {
 public:
 	ConstPField(double value);
+	virtual void	fill(double *values, int count, double start, double end) const;
 protected:
 	virtual 		~ConstPField();
 };
@@ -101,8 +114,11 @@ public:
 	virtual int		print(FILE *) const;
 	virtual int		copyValues(double *) const;
 	virtual int		values() const;
+	virtual void	fill(double *values, int count, double start, double end) const;
 protected:
 	virtual 		~PFieldBinaryOperator();
+	// Apply the operator to a chunk:  values[n] = op(values[n], operand[n]).
+	virtual void	combine(double *values, const double *operand, int count) const;
 private:
 	PField	*_pfield1, *_pfield2;
 	Operator _operator;
@@ -117,6 +133,7 @@ public:
 	AddPField(PField *pf1, PField *pf2) : PFieldBinaryOperator(pf1, pf2, Add) {}
 protected:
 	virtual 		~AddPField() {}
+	virtual void	combine(double *values, const double *operand, int count) const;
 };
 
 // PField which multiplies two other PFields
@@ -128,6 +145,7 @@ public:
 	MultPField(PField *pf1, PField *pf2) : PFieldBinaryOperator(pf1, pf2, Mult) {}
 protected:
 	virtual 		~MultPField() {}
+	virtual void	combine(double *values, const double *operand, int count) const;
 };
 
 // Base class for all Real-Time-varying parameters.
@@ -207,6 +225,10 @@ private:
 
 // Class for interpolated reading of table.
 
+// A table made from a float array stores half as many bytes.  The first time
+// its raw double array is asked for, a double copy is made, and from then on
+// the table reads from that copy, so that writes to it (modtable "draw") show.
+
 class TablePField : public PField, public RTFieldObject {
 public:
 	typedef double (*InterpFunction)(double *, int, double);
@@ -215,17 +237,26 @@ public:
 	static double Interpolate2ndOrder(double *, int, double);
 public:
 	TablePField(double *tableArray, int length, InterpFunction fun=Interpolate1stOrder);
+	TablePField(float *tableArray, int length, InterpFunction fun=Interpolate1stOrder);
 	virtual double 	doubleValue(int indx = 0) const;
 	virtual double	doubleValue(double) const;
-	virtual operator double *() const { return _table; }
+	virtual operator double *() const;
 	virtual int		print(FILE *) const;	// redefined
 	virtual int		copyValues(double *) const;
 	virtual int		values() const { return _len; }
+	virtual void	fill(double *values, int count, double start, double end) const;
 	void setInterpFunction(InterpFunction fun) { _interpolator = fun; }
+	InterpFunction interpFunction() const { return _interpolator; }
+	size_t			storageBytes() const;
 protected:
 	virtual ~TablePField();
 private:
+	double *		doubleTable() const {
+						return _table ? _table : _doubleView.load(std::memory_order_acquire);
+					}
 	double				*_table;
+	float				*_floatTable;
+	mutable std::atomic<double *> _doubleView;
 	int 				_len;
 	InterpFunction		_interpolator;
 };
@@ -366,6 +397,7 @@ public:
 												RangeFitFunction fun=UnipolarSource);
 	virtual double	doubleValue(double didx) const;
 	virtual double	doubleValue(int idx) const;
+	virtual void	fill(double *values, int count, double start, double end) const;
 protected:
 	virtual ~RangePField();
 private:
@@ -543,6 +575,7 @@ public:
 	ConverterPField(PField *innerPField, ConverterFunction cfun);
 	virtual double doubleValue(double percent) const;
 	virtual double doubleValue(int indx = 0) const;
+	virtual void	fill(double *values, int count, double start, double end) const;
 private:
 	ConverterFunction _converter;
 };
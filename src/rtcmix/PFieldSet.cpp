@@ -33,3 +33,13 @@ PFieldSet::load(PField *pf, int index)
 	}
 }
 
+void
+PFieldSet::fill(double *values[], int nfields, int count,
+				double start, double end, unsigned fields) const
+{
+	for (int n = 0; n < nfields; ++n) {
+		if (fields == 0 || (fields & (1 << n)))
+			_array[n]->fill(values[n], count, start, end);
+	}
+}
+
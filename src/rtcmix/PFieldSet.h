@@ -17,6 +17,10 @@ public:
 	void		load(PField *, int index);
 	PField & 	operator[](int index) const { return *_array[index]; }
 	int			size() const { return _size; }
+	// Fill values[n][0 .. count-1] from field n over [start, end), for the
+	// fields in <fields> (all if zero).  See PField::fill().
+	void		fill(double *values[], int nfields, int count,
+					 double start, double end, unsigned fields=0) const;
 private:
 	PField	**_array;
 	int		_size;
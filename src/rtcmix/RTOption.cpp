@@ -36,11 +36,22 @@ bool RTOption::_requireSampleRate = true;
 bool RTOption::_printSuppressUnderbar = false;
 bool RTOption::_bailOnUndefinedFunction = false;
 bool RTOption::_sendMIDIRecordAutoStart = false;
+bool RTOption::_threadAffinity = false;
+bool RTOption::_outputWriteDrop = false;
+bool RTOption::_tableFloat = false;
+bool RTOption::_dither = false;
 
 double RTOption::_bufferFrames = DEFAULT_BUFFER_FRAMES;
 int RTOption::_bufferCount = DEFAULT_BUFFER_COUNT;
 int RTOption::_oscInPort = DEFAULT_OSC_INPORT;
 double RTOption::_muteThreshold = DEFAULT_MUTE_THRESHOLD;
+int RTOption::_threadCount = DEFAULT_THREAD_COUNT;
+int RTOption::_threadPriority = DEFAULT_THREAD_PRIORITY;
+int RTOption::_inputReadAhead = DEFAULT_INPUT_READ_AHEAD;
+int RTOption::_outputWriteQueue = DEFAULT_OUTPUT_WRITE_QUEUE;
+int RTOption::_tableCache = DEFAULT_TABLE_CACHE;
+int RTOption::_inputResample = DEFAULT_INPUT_RESAMPLE;
+int RTOption::_silenceBlocks = DEFAULT_SILENCE_BLOCKS;
 
 // BGG see ugens.h for levels
 #ifdef EMBEDDED
@@ -76,6 +87,10 @@ void RTOption::init()
 	_autoLoad = false;
 	_fastUpdate = false;
 	_requireSampleRate = true;
+	_threadAffinity = false;
+	_outputWriteDrop = false;
+	_tableFloat = false;
+	_dither = false;
 #ifdef EMBEDDED
 	_print = MMP_RTERRORS; // basic level for max/msp
 #else
@@ -87,6 +102,13 @@ void RTOption::init()
 	_bufferCount = DEFAULT_BUFFER_COUNT;
 	_oscInPort = DEFAULT_OSC_INPORT;
 	_muteThreshold = DEFAULT_MUTE_THRESHOLD;
+	_threadCount = DEFAULT_THREAD_COUNT;
+	_threadPriority = DEFAULT_THREAD_PRIORITY;
+	_inputReadAhead = DEFAULT_INPUT_READ_AHEAD;
+	_outputWriteQueue = DEFAULT_OUTPUT_WRITE_QUEUE;
+	_tableCache = DEFAULT_TABLE_CACHE;
+	_inputResample = DEFAULT_INPUT_RESAMPLE;
+	_silenceBlocks = DEFAULT_SILENCE_BLOCKS;
 
 	_device[0] = 0;
 	_inDevice[0] = 0;
@@ -229,6 +251,34 @@ int RTOption::readConfigFile(const char *fileName)
     else if (result != kConfigNoValueForKey)
         reportError("%s: %s.", conf.getLastErrorText(), key);
 
+    key = kOptionThreadAffinity;
+    result = conf.getValue(key, bval);
+    if (result == kConfigNoErr)
+        threadAffinity(bval);
+    else if (result != kConfigNoValueForKey)
+        reportError("%s: %s.", conf.getLastErrorText(), key);
+
+    key = kOptionOutputWriteDrop;
+    result = conf.getValue(key, bval);
+    if (result == kConfigNoErr)
+        outputWriteDrop(bval);
+    else if (result != kConfigNoValueForKey)
+        reportError("%s: %s.", conf.getLastErrorText(), key);
+
+    key = kOptionTableFloat;
+    result = conf.getValue(key, bval);
+    if (result == kConfigNoErr)
+        tableFloat(bval);
+    else if (result != kConfigNoValueForKey)
+        reportError("%s: %s.", conf.getLastErrorText(), key);
+
+    key = kOptionDither;
+    result = conf.getValue(key, bval);
+    if (result == kConfigNoErr)
+        dither(bval);
+    else if (result != kConfigNoValueForKey)
+        reportError("%s: %s.", conf.getLastErrorText(), key);
+
     // number options .........................................................
 
 	double dval;
@@ -275,6 +325,55 @@ int RTOption::readConfigFile(const char *fileName)
 	else if (result != kConfigNoValueForKey)
 		reportError("%s: %s.", conf.getLastErrorText(), key);
 
+	key = kOptionThreadCount;
+	result = conf.getValue(key, dval);
+	if (result == kConfigNoErr)
+		threadCount((int)dval);
+	else if (result != kConfigNoValueForKey)
+		reportError("%s: %s.", conf.getLastErrorText(), key);
+
+	key = kOptionThreadPriority;
+	result = conf.getValue(key, dval);
+	if (result == kConfigNoErr)
+		threadPriority((int)dval);
+	else if (result != kConfigNoValueForKey)
+		reportError("%s: %s.", conf.getLastErrorText(), key);
+
+	key = kOptionInputReadAhead;
+	result = conf.getValue(key, dval);
+	if (result == kConfigNoErr)
+		inputReadAhead((int)dval);
+	else if (result != kConfigNoValueForKey)
+		reportError("%s: %s.", conf.getLastErrorText(), key);
+
+	key = kOptionOutputWriteQueue;
+	result = conf.getValue(key, dval);
+	if (result == kConfigNoErr)
+		outputWriteQueue((int)dval);
+	else if (result != kConfigNoValueForKey)
+		reportError("%s: %s.", conf.getLastErrorText(), key);
+
+	key = kOptionTableCache;
+	result = conf.getValue(key, dval);
+	if (result == kConfigNoErr)
+		tableCache((int)dval);
+	else if (result != kConfigNoValueForKey)
+		reportError("%s: %s.", conf.getLastErrorText(), key);
+
+	key = kOptionInputResample;
+	result = conf.getValue(key, dval);
+	if (result == kConfigNoErr)
+		inputResample((int)dval);
+	else if (result != kConfigNoValueForKey)
+		reportError("%s: %s.", conf.getLastErrorText(), key);
+
+	key = kOptionSilenceBlocks;
+	result = conf.getValue(key, dval);
+	if (result == kConfigNoErr)
+		silenceBlocks((int)dval);
+	else if (result != kConfigNoValueForKey)
+		reportError("%s: %s.", conf.getLastErrorText(), key);
+
 	// string options .........................................................
 
 	char *sval;
@@ -394,6 +493,14 @@ int RTOption::writeConfigFile(const char *fileName)
                                         printSuppressUnderbar() ? "true" : "false");
     fprintf(stream, "%s = %s\n", kOptionBailOnUndefinedFunction,
             bailOnUndefinedFunction() ? "true" : "false");
+	fprintf(stream, "%s = %s\n", kOptionThreadAffinity,
+										threadAffinity() ? "true" : "false");
+	fprintf(stream, "%s = %s\n", kOptionOutputWriteDrop,
+										outputWriteDrop() ? "true" : "false");
+	fprintf(stream, "%s = %s\n", kOptionTableFloat,
+										tableFloat() ? "true" : "false");
+	fprintf(stream, "%s = %s\n", kOptionDither,
+										dither() ? "true" : "false");
 
 	// write number options
 	fprintf(stream, "\n# Number options: key = value\n");
@@ -403,6 +510,13 @@ int RTOption::writeConfigFile(const char *fileName)
 	fprintf(stream, "%s = %d\n", kOptionPrint, print());
     fprintf(stream, "%s = %d\n", kOptionPrintListLimit, printListLimit());
 	fprintf(stream, "%s = %g\n", kOptionMuteThreshold, muteThreshold());
+	fprintf(stream, "%s = %d\n", kOptionThreadCount, threadCount());
+	fprintf(stream, "%s = %d\n", kOptionThreadPriority, threadPriority());
+	fprintf(stream, "%s = %d\n", kOptionInputReadAhead, inputReadAhead());
+	fprintf(stream, "%s = %d\n", kOptionOutputWriteQueue, outputWriteQueue());
+	fprintf(stream, "%s = %d\n", kOptionTableCache, tableCache());
+	fprintf(stream, "%s = %d\n", kOptionInputResample, inputResample());
+	fprintf(stream, "%s = %d\n", kOptionSilenceBlocks, silenceBlocks());
 
 	// write string options
 	fprintf(stream, "\n# String options: key = \"quoted string\"\n");
@@ -559,10 +673,21 @@ void RTOption::dump()
 	cout << kOptionRequireSampleRate << ": " << _requireSampleRate << endl;
     cout << kOptionPrintSuppressUnderbar << ": " << _printSuppressUnderbar << endl;
     cout << kOptionBailOnUndefinedFunction << ": " << _bailOnUndefinedFunction << endl;
+	cout << kOptionThreadAffinity << ": " << _threadAffinity << endl;
+	cout << kOptionOutputWriteDrop << ": " << _outputWriteDrop << endl;
+	cout << kOptionTableFloat << ": " << _tableFloat << endl;
+	cout << kOptionDither << ": " << _dither << endl;
 	cout << kOptionBufferFrames << ": " << _bufferFrames << endl;
 	cout << kOptionBufferCount << ": " << _bufferCount << endl;
     cout << kOptionPrintListLimit << ": " << _printListLimit << endl;
 	cout << kOptionMuteThreshold << ": " << _muteThreshold << endl;
+	cout << kOptionThreadCount << ": " << _threadCount << endl;
+	cout << kOptionThreadPriority << ": " << _threadPriority << endl;
+	cout << kOptionInputReadAhead << ": " << _inputReadAhead << endl;
+	cout << kOptionOutputWriteQueue << ": " << _outputWriteQueue << endl;
+	cout << kOptionTableCache << ": " << _tableCache << endl;
+	cout << kOptionInputResample << ": " << _inputResample << endl;
+	cout << kOptionSilenceBlocks << ": " << _silenceBlocks << endl;
 	cout << kOptionOSCInPort << ": " << _oscInPort << endl;
 	cout << kOptionDevice << ": " << _device << endl;
 	cout << kOptionInDevice << ": " << _inDevice << endl;
@@ -631,6 +756,14 @@ int get_bool_option(const char *option_name)
         return (int)RTOption::bailOnUndefinedFunction();
     else if (!strcmp(option_name, kOptionSendMIDIRecordAutoStart))
         return (int)RTOption::sendMIDIRecordAutoStart();
+	else if (!strcmp(option_name, kOptionThreadAffinity))
+		return (int)RTOption::threadAffinity();
+	else if (!strcmp(option_name, kOptionOutputWriteDrop))
+		return (int)RTOption::outputWriteDrop();
+	else if (!strcmp(option_name, kOptionTableFloat))
+		return (int)RTOption::tableFloat();
+	else if (!strcmp(option_name, kOptionDither))
+		return (int)RTOption::dither();
 
 	assert(0 && "unsupported option name");		// program error
 	return 0;
@@ -666,6 +799,14 @@ void set_bool_option(const char *option_name, int value)
         RTOption::printSuppressUnderbar((bool) value);
     else if (!strcmp(option_name, kOptionSendMIDIRecordAutoStart))
         RTOption::sendMIDIRecordAutoStart((bool)value);
+	else if (!strcmp(option_name, kOptionThreadAffinity))
+		RTOption::threadAffinity((bool)value);
+	else if (!strcmp(option_name, kOptionOutputWriteDrop))
+		RTOption::outputWriteDrop((bool)value);
+	else if (!strcmp(option_name, kOptionTableFloat))
+		RTOption::tableFloat((bool)value);
+	else if (!strcmp(option_name, kOptionDither))
+		RTOption::dither((bool)value);
 	else
 		assert(0 && "unsupported option name");
 }
@@ -682,6 +823,20 @@ double get_double_option(const char *option_name)
         return RTOption::parserWarnings();
 	else if (!strcmp(option_name, kOptionMuteThreshold))
 		return RTOption::muteThreshold();
+	else if (!strcmp(option_name, kOptionThreadCount))
+		return RTOption::threadCount();
+	else if (!strcmp(option_name, kOptionThreadPriority))
+		return RTOption::threadPriority();
+	else if (!strcmp(option_name, kOptionInputReadAhead))
+		return RTOption::inputReadAhead();
+	else if (!strcmp(option_name, kOptionOutputWriteQueue))
+		return RTOption::outputWriteQueue();
+	else if (!strcmp(option_name, kOptionTableCache))
+		return RTOption::tableCache();
+	else if (!strcmp(option_name, kOptionInputResample))
+		return RTOption::inputResample();
+	else if (!strcmp(option_name, kOptionSilenceBlocks))
+		return RTOption::silenceBlocks();
 
 	assert(0 && "unsupported option name");
 	return 0;
@@ -699,6 +854,20 @@ void set_double_option(const char *option_name, double value)
         RTOption::parserWarnings((int)value);
 	else if (!strcmp(option_name, kOptionMuteThreshold))
 		RTOption::muteThreshold(value);
+	else if (!strcmp(option_name, kOptionThreadCount))
+		RTOption::threadCount((int)value);
+	else if (!strcmp(option_name, kOptionThreadPriority))
+		RTOption::threadPriority((int)value);
+	else if (!strcmp(option_name, kOptionInputReadAhead))
+		RTOption::inputReadAhead((int)value);
+	else if (!strcmp(option_name, kOptionOutputWriteQueue))
+		RTOption::outputWriteQueue((int)value);
+	else if (!strcmp(option_name, kOptionTableCache))
+		RTOption::tableCache((int)value);
+	else if (!strcmp(option_name, kOptionInputResample))
+		RTOption::inputResample((int)value);
+	else if (!strcmp(option_name, kOptionSilenceBlocks))
+		RTOption::silenceBlocks((int)value);
 	else
 		assert(0 && "unsupported option name");
 }
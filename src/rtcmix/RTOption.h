@@ -81,6 +81,18 @@
 #define DEVICE_MAX   64
 #define MAX_OUTPUT_DEVICES 3
 
+#ifdef RT_THREAD_COUNT
+#define DEFAULT_THREAD_COUNT RT_THREAD_COUNT
+#else
+#define DEFAULT_THREAD_COUNT 2
+#endif
+#define DEFAULT_THREAD_PRIORITY 0		/* means leave scheduling alone */
+#define DEFAULT_INPUT_READ_AHEAD 1024	/* KB per input file; 0 disables */
+#define DEFAULT_OUTPUT_WRITE_QUEUE 16	/* buffers; 0 means write synchronously */
+#define DEFAULT_TABLE_CACHE 32			/* MB of unused tables kept; 0 disables */
+#define DEFAULT_INPUT_RESAMPLE 1		/* 0 off, 1 fast, 2 best */
+#define DEFAULT_SILENCE_BLOCKS 0		/* 0 disables */
+
 #define DEFAULT_PRINT_LIST_LIMIT 16
 #define DEFAULT_PARSER_WARNINGS 0
 
@@ -103,6 +115,10 @@
 #define kOptionPrintSuppressUnderbar "print_suppress_underbar"
 #define kOptionBailOnUndefinedFunction "bail_on_undefined_function"
 #define kOptionSendMIDIRecordAutoStart "send_midi_record_auto_start"
+#define kOptionThreadAffinity   "thread_affinity"
+#define kOptionOutputWriteDrop  "output_write_drop"
+#define kOptionTableFloat       "table_float"
+#define kOptionDither           "dither"
 
 // number options
 #define kOptionBufferFrames     "buffer_frames"
@@ -112,6 +128,13 @@
 #define kOptionPrintListLimit    "print_list_limit"
 #define kOptionParserWarnings   "parser_warnings"
 #define kOptionMuteThreshold	"mute_threshold"
+#define kOptionThreadCount      "thread_count"
+#define kOptionThreadPriority   "thread_priority"
+#define kOptionInputReadAhead   "input_read_ahead"
+#define kOptionOutputWriteQueue "output_write_queue"
+#define kOptionTableCache       "table_cache"
+#define kOptionInputResample    "input_resample"
+#define kOptionSilenceBlocks    "silence_blocks"
 
 // string options
 #define kOptionDevice           "device"
@@ -199,6 +222,26 @@ public:
     static bool sendMIDIRecordAutoStart(const bool setIt) { _sendMIDIRecordAutoStart = setIt;
         return _sendMIDIRecordAutoStart; }
 
+	static bool threadAffinity() { return _threadAffinity; }
+	static bool threadAffinity(const bool setIt) { _threadAffinity = setIt;
+		return _threadAffinity; }
+
+	// If true, drop output file buffers when the writer falls behind,
+	// rather than waiting for it.
+	static bool outputWriteDrop() { return _outputWriteDrop; }
+	static bool outputWriteDrop(const bool setIt) { _outputWriteDrop = setIt;
+		return _outputWriteDrop; }
+
+	// If true, maketable() stores table values as floats.
+	static bool tableFloat() { return _tableFloat; }
+	static bool tableFloat(const bool setIt) { _tableFloat = setIt;
+		return _tableFloat; }
+
+	// If true, add TPDF dither when writing 16 or 24-bit output.
+	static bool dither() { return _dither; }
+	static bool dither(const bool setIt) { _dither = setIt;
+		return _dither; }
+
 	// number options
 
 	static double bufferFrames() { return _bufferFrames; }
@@ -225,6 +268,35 @@ public:
 	static double muteThreshold() { return _muteThreshold; }
 	static double muteThreshold(double thresh) { _muteThreshold = thresh; return _muteThreshold; }
 
+	// A thread count of 0 means use one thread per online CPU.
+	static int threadCount() { return _threadCount; }
+	static int threadCount(int count) { _threadCount = count; return _threadCount; }
+
+	static int threadPriority() { return _threadPriority; }
+	static int threadPriority(int prio) { _threadPriority = prio; return _threadPriority; }
+
+	// Size in KB of the read-ahead cache for each input sound file, 0 to disable.
+	static int inputReadAhead() { return _inputReadAhead; }
+	static int inputReadAhead(int kbytes) { _inputReadAhead = kbytes; return _inputReadAhead; }
+
+	// Buffers queued for the output file writer thread, 0 to write synchronously.
+	static int outputWriteQueue() { return _outputWriteQueue; }
+	static int outputWriteQueue(int count) { _outputWriteQueue = count; return _outputWriteQueue; }
+
+	// Size in MB of unused tables kept by the table cache, 0 to disable.
+	static int tableCache() { return _tableCache; }
+	static int tableCache(int mbytes) { _tableCache = mbytes; return _tableCache; }
+
+	// Quality of the converter for input files whose rate is not sr():
+	// 0 to read them unconverted, 1 for the short filter, 2 for the long one.
+	static int inputResample() { return _inputResample; }
+	static int inputResample(int quality) { _inputResample = quality; return _inputResample; }
+
+	// Buffers of silence after which a note that has sounded is ended, 0 to
+	// let every note run its full duration.
+	static int silenceBlocks() { return _silenceBlocks; }
+	static int silenceBlocks(int count) { _silenceBlocks = count; return _silenceBlocks; }
+
 	// string options
 
 	// WARNING: If no string as been assigned, do not expect the get method
@@ -282,6 +354,10 @@ private:
     static bool _printSuppressUnderbar;
     static bool _bailOnUndefinedFunction;
     static bool _sendMIDIRecordAutoStart;
+	static bool _threadAffinity;
+	static bool _outputWriteDrop;
+	static bool _tableFloat;
+	static bool _dither;
 
 	// number options
 	static double _bufferFrames;
@@ -291,6 +367,13 @@ private:
     static int _printListLimit;
     static unsigned _parserWarnings;
 	static double _muteThreshold;
+	static int _threadCount;
+	static int _threadPriority;
+	static int _inputReadAhead;
+	static int _outputWriteQueue;
+	static int _tableCache;
+	static int _inputResample;
+	static int _silenceBlocks;
 
 	// string options
 	static char _device[];
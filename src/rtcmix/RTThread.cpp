@@ -8,7 +8,9 @@
 
 #include "RTThread.h"
 #include <sys/resource.h>
+#include <sched.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <assert.h>
 
 static pthread_once_t sOnceControl = PTHREAD_ONCE_INIT;
@@ -35,6 +37,28 @@ void RTThread::setName(const char *name)
 #endif
 }
 
+// These two are called from within run(), i.e., on the thread itself.
+
+int RTThread::setPriority(int inPriority)
+{
+	struct sched_param param;
+	param.sched_priority = inPriority;
+	return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+}
+
+int RTThread::setAffinity(int inCPU)
+{
+#ifdef LINUX
+	const long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(cpuCount > 0 ? inCPU % cpuCount : inCPU, &cpuSet);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+#else
+	return -1;	// No way to pin a thread to a core on this platform
+#endif
+}
+
 // We cannot start running the pthread in the ctor, so we do it here.
 
 void RTThread::start() {
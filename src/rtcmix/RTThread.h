@@ -21,6 +21,8 @@ protected:
 	void start();
 	virtual void run()=0;
     void setName(const char *name);
+	int setPriority(int inPriority);
+	int setAffinity(int inCPU);
 	static void *sProcess(void *inContext);
 private:
 	int			GetIndex() const { return mThreadIndex; }
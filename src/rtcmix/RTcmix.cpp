@@ -24,7 +24,8 @@
 #include <math.h>
 
 #include "prototypes.h"
-#include "InputFile.h"
+#include "InputFileTable.h"
+#include "InputResampler.h"
 #include <ugens.h>
 #include <RTcmix.h>
 #include <RTOption.h>
@@ -36,6 +37,9 @@
 #endif
 #include "rt.h"
 #include "heap.h"
+#include <Reclaimer.h>
+#include <ReadAheadCache.h>
+#include <TableCache.h>
 #include "maxdispargs.h"
 #include "dbug.h"
 #include "globals.h"
@@ -81,7 +85,7 @@ AudioDevice *	RTcmix::audioDevice     = NULL;
 
 heap *			RTcmix::rtHeap			= NULL;
 RTQueue *		RTcmix::rtQueue			= NULL;
-rt_item *		RTcmix::rt_list 		= NULL;
+InstrumentTable *	RTcmix::rt_table 		= NULL;
 
 int				RTcmix::output_data_format 		= -1;
 int				RTcmix::output_header_type 		= -1;
@@ -105,7 +109,7 @@ bool		RTcmix::rtrecord 	= false;		// indicates reading from audio device
 int			RTcmix::rtfileit 	= 0;		// signal writing to soundfile
 int			RTcmix::rtoutfile 	= 0;
 
-InputFile *	RTcmix::inputFileTable = NULL;
+InputFileTable	RTcmix::inputFileTable;
 long		RTcmix::max_input_fds = 0;
 int			RTcmix::last_input_index = -1;
 
@@ -131,7 +135,9 @@ short *			RTcmix::ToAuxPlayList = NULL;
 //pthread_mutex_t RTcmix::aux_buffer_lock = PTHREAD_MUTEX_INITIALIZER;
 //pthread_mutex_t RTcmix::out_buffer_lock = PTHREAD_MUTEX_INITIALIZER;
 TaskManager *	RTcmix::taskManager = NULL;
-std::vector<RTcmix::MixData> RTcmix::mixVectors[RT_THREAD_COUNT];
+int				RTcmix::sThreadCount = 0;
+std::vector<RTcmix::MixData> *RTcmix::mixVectors = NULL;
+RTcmix::BusMixer RTcmix::busMixer;
 #endif
 
 std::vector<RTcmix::CallbackInfo> RTcmix::audioStartCallbacks;
@@ -146,10 +152,11 @@ int				RTcmix::busCount = DEFAULT_MAXBUS;
 BusConfig *		RTcmix::BusConfigs = NULL;
 
 // Function registry
-FunctionEntry *	RTcmix::_functionRegistry = NULL;
+FunctionRegistry *	RTcmix::_functionRegistry = NULL;
 
 // Function table state
-struct _func *	RTcmix::_func_list = NULL;
+FunctionTable *	RTcmix::_func_table = NULL;
+unsigned		RTcmix::sRegistryGeneration = 1;
 
 
 /* --------------------------------------------------------- init_options --- */
@@ -188,18 +195,37 @@ RTcmix::init_options(bool fromMain, const char *defaultDSOPath)
 	}
 }
 
+#ifdef MULTI_THREAD
+/* ---------------------------------------------------- get_thread_count --- */
+/* The "thread_count" option, with 0 meaning one thread per online CPU. */
+static int
+get_thread_count()
+{
+	int count = RTOption::threadCount();
+	if (count == 0) {
+		const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		count = (cpus > 0) ? (int) cpus : DEFAULT_THREAD_COUNT;
+	}
+	return count;
+}
+#endif
+
 /* --------------------------------------------------------- init_globals --- */
 void
 RTcmix::init_globals()
 {
    rtcmix_debug(NULL, "RTcmix::init_globals entered");
+   Reclaimer::start();
    rtHeap = new heap;
    rtQueue = new RTQueue[busCount*3];
 #ifdef MULTI_THREAD
-   taskManager = new TaskManager;
-    for (int i = 0; i < RT_THREAD_COUNT; ++i) {
+   sThreadCount = get_thread_count();
+   taskManager = new TaskManager(sThreadCount, RTOption::threadPriority(), RTOption::threadAffinity());
+   mixVectors = new std::vector<MixData>[sThreadCount];
+    for (int i = 0; i < sThreadCount; ++i) {
         mixVectors[i].reserve(busCount);
     }
+   rtcmix_debug(NULL, "RTcmix::init_globals: using %d audio threads", sThreadCount);
 #endif
 	BusConfigs = new BusConfig[busCount];
 	AuxToAuxPlayList = new short[busCount];
@@ -214,6 +240,8 @@ RTcmix::init_globals()
 	max_input_fds = sysconf(_SC_OPEN_MAX);
 	if (max_input_fds == -1)	// call failed
 		max_input_fds = 128;		// what we used to hardcode
+	else if (max_input_fds > MAX_INPUT_FDS)
+		max_input_fds = MAX_INPUT_FDS;
 	else
 		max_input_fds -= RESERVE_INPUT_FDS;
 #else
@@ -222,7 +250,8 @@ RTcmix::init_globals()
 	// which seems to work fine
 	max_input_fds = 128;
 #endif
-	inputFileTable = new InputFile[max_input_fds];
+	// This is only a limit; slots are made as files are opened.
+	inputFileTable.init(max_input_fds);
 	last_input_index = -1;
 	
    init_buf_ptrs();
@@ -241,8 +270,12 @@ RTcmix::free_globals()
 	rtQueue = NULL;
 	delete rtHeap;
 	rtHeap = NULL;
-	delete [] inputFileTable;
-	inputFileTable = NULL;
+	// Finish deleting instruments before the input files they refer to go away.
+	Reclaimer::stop();
+	inputFileTable.clear();
+	InputResampler::clearFilters();
+	ReadAheadCache::stopThread();
+	TableCache::clear();
 	
 	delete [] AuxToAuxPlayList;
 	AuxToAuxPlayList = NULL;
@@ -273,6 +306,9 @@ RTcmix::free_globals()
 #ifdef MULTI_THREAD
 	delete taskManager;
 	taskManager = NULL;
+	delete [] mixVectors;
+	mixVectors = NULL;
+	sThreadCount = 0;
 	InputFile::destroyConversionBuffers();
 #endif
 
@@ -34,12 +34,30 @@ struct CheckNode;
 #endif
 struct _func;
 struct FunctionEntry;
+struct FunctionTable;
+struct FunctionRegistry;
+struct InstrumentTable;
 struct InputState;	// part of Instrument class
 struct InputFile;
+class InputResampler;
+class InputFileTable;
 
 typedef bool (*AudioDeviceCallback)(AudioDevice *device, void *arg);
 typedef void (*AudioCallback)(void *context);
 
+typedef Instrument * (*InstCreatorFunction)();
+
+// A function or instrument name resolved by RTcmix::resolve(), so that a
+// caller dispatching the same name over and over (e.g., a Minc function call
+// node inside a loop) can skip the lookup.  A handle stays usable until the
+// set of registered functions or instruments changes.
+struct DispatchHandle {
+	DispatchHandle() : function(NULL), creator(NULL), generation(0) {}
+	struct _func *		function;
+	InstCreatorFunction	creator;
+	unsigned			generation;
+};
+
 enum RTstatus {
 	RT_GOOD = 0, RT_SHUTDOWN = 1, RT_PANIC = 2, RT_SKIP = 3, RT_FLUSH = 4, RT_ERROR = 5
 };
@@ -92,6 +110,16 @@ public:
 	static void printargs(const char *funcname, const Arg arglist[], const int nargs);
 	static int dispatch(const char *func_label, const Arg arglist[],
 						const int nargs, Arg *retval);
+	// Look up <func_label> as a function (auto-loading its DSO if need be),
+	// then as an instrument.  Returns false if it is neither.
+	static bool resolve(const char *func_label, DispatchHandle *outHandle);
+	static bool isCurrent(const DispatchHandle &handle) {
+		return handle.generation == sRegistryGeneration && (handle.function || handle.creator);
+	}
+	// Call a handle from resolve() which isCurrent().
+	static int dispatch(const char *func_label, const DispatchHandle &handle,
+						const Arg arglist[], const int nargs, Arg *retval);
+	static InstCreatorFunction findInstrument(const char *inst_name);
 	static void addfunc(const char *func_label,
 					   double (*func_ptr_legacy)(double*, int),
                        double (*func_ptr_number)(const Arg[], int),
@@ -117,12 +145,13 @@ public:
 	 */
 	static int get_last_input_index() { return last_input_index; }
 	static off_t seekInputFile(int fdIndex, int frames, int chans, int whence);
-	static void readFromInputFile(BufPtr dest, int dest_chans, int dest_frms, const short src_chan_list[], short src_chans, int fdIndex, off_t *outFileOffset);
+	static void readFromInputFile(BufPtr dest, int dest_chans, int dest_frms, const short src_chan_list[], short src_chans, int fdIndex, off_t *outFileOffset, InputResampler *resampler = NULL);
 	static void rtgetsamps(AudioDevice *inputDevice);
 	// Output	   
 	static void addToBus(BusType type, int bus, BufPtr buf, int offset, int endfr, int chans);
 #ifdef MULTI_THREAD
     static void mixToBus();
+	static int threadCount() { return sThreadCount; }
 #endif
 	static void releaseInput(int fdIndex);
 
@@ -200,6 +229,8 @@ protected:
 	static int checkInsts(const char *instname, const Arg arglist[], const int nargs, Arg *retval);
 	static int checkfunc(const char *funcname, const Arg arglist[], const int nargs, Arg *retval);
 	static int findAndLoadFunction(const char *funcname);
+	static int callfunc(struct _func *func, const char *funcname, const Arg arglist[], const int nargs, Arg *retval);
+	static int callInstrument(InstCreatorFunction creator, const char *instname, const Arg arglist[], const int nargs, Arg *retval);
 	static void freefuncs();
 	static FRAMETYPE getElapsed() { return elapsed; }
 
@@ -287,10 +318,7 @@ private:
 	static FRAMETYPE 	bufStartSamp;
 	static FRAMETYPE	elapsed;
 
-	// HACK ALERT!!!  D.S. WAS HERE!!!!
-public:
-	static rt_item *rt_list;
-private:
+	static InstrumentTable *rt_table;
 	static pthread_mutex_t aux_to_aux_lock;
 	static pthread_mutex_t to_aux_lock;
 	static pthread_mutex_t to_out_lock;
@@ -308,7 +336,7 @@ private:
 	static int		rtfileit;		// 1 if rtoutput() succeeded
 	static int		rtoutfile;
 
-	static InputFile	*inputFileTable;
+	static InputFileTable	inputFileTable;
 	static int 		last_input_index;
 	static long     max_input_fds;
 
@@ -317,6 +345,7 @@ private:
 	static BufPtr	*out_buffer;
 #ifdef MULTI_THREAD
 	static TaskManager *taskManager;
+	static int sThreadCount;
 //	static pthread_mutex_t aux_buffer_lock;
 //	static pthread_mutex_t out_buffer_lock;
     struct MixData {
@@ -324,11 +353,17 @@ private:
         BufPtr  dest;
         int     frames;
         int     channels;
-        MixData(BufPtr inSrc, BufPtr inDest, int inFrames, int inChans)
-            : src(inSrc), dest(inDest), frames(inFrames), channels(inChans) {}
+        int     destBus;	// out buses first, then aux buses
+        MixData(BufPtr inSrc, BufPtr inDest, int inFrames, int inChans, int inDestBus)
+            : src(inSrc), dest(inDest), frames(inFrames), channels(inChans), destBus(inDestBus) {}
+    };
+    // Task target which applies the mixes for one partition of the buses.
+    struct BusMixer {
+        int mix(int inPartition, int inPartitionCount);
     };
     static void mixOperation(MixData &m);
-    static std::vector<MixData> mixVectors[];
+    static std::vector<MixData> *mixVectors;	// one per thread
+    static BusMixer busMixer;
 #endif
 	
 	static short *AuxToAuxPlayList; /* The playback order for AUX buses */
@@ -363,12 +398,16 @@ private:
 	// END of bus config
 	
 	// Function registry
-	static FunctionEntry *_functionRegistry;
+	static FunctionRegistry *_functionRegistry;
 
 	// Function table variables
-	static struct _func *	_func_list;
+	static FunctionTable *	_func_table;
 	// End of function table
 
+	// Bumped whenever a function or instrument is added or the tables are
+	// cleared, to retire DispatchHandles.
+	static unsigned sRegistryGeneration;
+
 };
 
 // handy utility function...
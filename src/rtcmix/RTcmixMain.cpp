@@ -20,6 +20,7 @@
 #include "prototypes.h"
 #include "../parser/rtcmix_parse.h"
 #include <sockdefs.h>
+#include "SocketServer.h"
 #include <limits.h>
 #include "heap.h"
 
@@ -659,77 +660,80 @@ void * RTcmixMain::OSC_Server(void *arg){
 }
 #endif
 
-void *
-RTcmixMain::sockit(void *arg)
-{
-    char ttext[MAXTEXTARGS][512];
-    int i;
+// Commands arriving over the socket, from any client, in arrival order.
 
-    // socket stuff
-    int s, ns;
-    struct sockaddr_in sss;
-    int err;
-    struct sockdata *sinfo;
-    size_t amt;
-    char *sptr;
-    int val,optlen;
-	Bool audio_configured = NO;
+class RTcmixMain::SockitHandler : public SocketServer::Handler {
+public:
+	SockitHandler(bool waitForConfig) : _audioConfigured(!waitForConfig) {}
+	virtual bool command(const char *name, double *p, int n_args);
+	virtual void score(char *text, int len) { parse_score_buffer(text, len); }
+private:
+	void checkConfigured();
+	bool _audioConfigured;
+};
 
-    /* create the socket for listening */
+// We do this when the -n flag is set:  rtsetparams() has to come over the
+// socket before anyone can access RTBUFSAMPS, SR, NCHANS, etc., and until
+// then RTcmix_off and RTcmix_panic are passed along like any other command.
 
-    rtcmix_debug(NULL, "RTcmixMain::sockit entered");
-    if( (s = ::socket(AF_INET, SOCK_STREAM, 0)) < 0) {
-      perror("socket");
-	  run_status = RT_ERROR;	// Notify inTraverse()
-      exit(1);
-    }
+void RTcmixMain::SockitHandler::checkConfigured()
+{
+	pthread_mutex_lock(&audio_config_lock);
+	_audioConfigured = (audio_config != 0);
+	pthread_mutex_unlock(&audio_config_lock);
+	if (_audioConfigured && interactive() && RTOption::print())
+		RTPrintf("RTcmixMain::sockit(): audio configured.\n");
+}
 
-    /* set up the receive buffer nicely for us */
-    optlen = sizeof(char);
-    val = sizeof(struct sockdata);
-    setsockopt(s, SOL_SOCKET, SO_RCVBUF, &val, optlen);
+bool RTcmixMain::SockitHandler::command(const char *name, double *p, int n_args)
+{
+	const bool configuring = !_audioConfigured;
+	if (configuring)
+		checkConfigured();
+	if (!configuring && strcmp(name, "RTcmix_off") == 0) {
+		RTPrintf("RTcmix termination cmd received.\n");
+		run_status = RT_SHUTDOWN;	// Notify inTraverse()
+		return false;
+	}
+	else if (!configuring && strcmp(name, "RTcmix_panic") == 0) {
+		int count = 30;
+		RTPrintf("RTcmix panic cmd received...\n");
+		panic();	// Notify inTraverse()
+		while (count--) {
+#ifdef linux
+			usleep(1000);
+#endif
+		}
+		RTPrintf("Resuming normal mode\n");
+		run_status = RT_GOOD;	// Notify inTraverse()
+		return true;
+	}
+#ifdef DBUG
+	RTPrintf("sockit(): elapsed = %llu\n", (unsigned long long)getElapsed());
+	rtcmix_debug(NULL, "RTcmixMain::sockit: RECIEVED command");
+	rtcmix_debug(NULL, "name = %s", name);
+	rtcmix_debug(NULL, "n_args = %d", n_args);
+	for (int i = 0; i < n_args; i++)
+		rtcmix_debug(NULL, "p[%d] = %f", i, p[i]);
+#endif
+	(void) ::dispatch(name, p, n_args, NULL);
+	return true;
+}
 
-    /* set up the socket address */
-    sss.sin_family = AF_INET;
-    sss.sin_addr.s_addr = INADDR_ANY;
-    // socknew is offset from MYPORT to allow more than one inst
-    sss.sin_port = htons(MYPORT+socknew);
+void *
+RTcmixMain::sockit(void *arg)
+{
+    rtcmix_debug(NULL, "RTcmixMain::sockit entered");
 
-    err = ::bind(s, (struct sockaddr *)&sss, sizeof(sss));
-    if (err < 0) {
-      perror("bind");
+    SocketServer server;
+    // socknew is offset from MYPORT to allow more than one inst
+    if (server.open(MYPORT+socknew) < 0) {
 	  run_status = RT_ERROR;	// Notify inTraverse()
 	  sleep(1);
       exit(1);
     }
 
-    listen(s, 1);
-
-#ifdef JAGUAR
-    int len = sizeof(sss);
-#else
-    socklen_t len = sizeof(sss);
-#endif
-    ns = ::accept(s, (struct sockaddr *)&sss, &len);
-    if(ns < 0) {
-        perror("RTcmixMain::sockit: accept");
-        run_status = RT_ERROR;	// Notify inTraverse()
-        exit(1);
-    }
-    else {
-      sinfo = new (struct sockdata);
-      // Zero the socket structure
-      sinfo->name[0] = '\0';
-      for (i=0;i<MAXDISPARGS;i++) {
-		sinfo->data.p[i] = 0;
-      }
-	  
-      // we do this when the -n flag is set, it has to parse rtsetparams()
-      // coming over the socket before it can access the values of RTBUFSAMPS,
-      // SR, NCHANS, etc.
-      if (noParse) {
-		
-		// Wait for the ok to go ahead
+    if (noParse) {
 		pthread_mutex_lock(&audio_config_lock);
 		if (!audio_config) {
 #ifndef EMBEDDED
@@ -738,127 +742,15 @@ RTcmixMain::sockit(void *arg)
 #endif
 		}
 		pthread_mutex_unlock(&audio_config_lock);
-		
-		while (!audio_configured) {
-		  pthread_mutex_lock(&audio_config_lock);
-		  if (audio_config) {
-			audio_configured = YES;
-		  }
-		  pthread_mutex_unlock(&audio_config_lock);
-
-		  sptr = (char *)sinfo;
-		  amt = read(ns, (void *)sptr, sizeof(struct sockdata));
-          while (amt < sizeof(struct sockdata)) {
-              amt += read(ns, (void *)(sptr+amt), sizeof(struct sockdata)-amt);
-          }
-          if (strlen(sinfo->name) == 0) {
-              rtcmix_warn(NULL, "bad socket command (NULL command name)");
-              continue;
-          }
-          if (strcmp(sinfo->name, "score")==0) {
-              for (int n = 0; n < sinfo->n_args; ++n) {
-                  parse_score_buffer(sinfo->data.text[n], (int)strlen(sinfo->data.text[0]));
-              }
-          }
-          else {
-              if ( (strcmp(sinfo->name, "rtinput") == 0) ||
-                   (strcmp(sinfo->name, "rtoutput") == 0) ||
-                   (strcmp(sinfo->name,"set_option") == 0) ||
-                   (strcmp(sinfo->name,"bus_config") == 0) ||
-                   (strcmp(sinfo->name, "load")==0) ) {
-                // these two commands use text data
-                // replace the text[i] with p[i] pointers
-                for (i = 0; i < sinfo->n_args; i++)
-                  strcpy(ttext[i],sinfo->data.text[i]);
-                for (i = 0; i < sinfo->n_args; i++) {
-                  sinfo->data.p[i] = STRING_TO_DOUBLE(ttext[i]);
-                }
-              }
-#ifdef DBUG
-              rtcmix_debug(NULL, "RTcmixMain::sockit: RECIEVED command during audio_configure loop");
-              rtcmix_debug(NULL, "sinfo->name = %s", sinfo->name);
-              rtcmix_debug(NULL, "sinfo->n_args = %d", (int)sinfo->n_args);
-              for (i=0;i<sinfo->n_args;i++) {
-                  rtcmix_debug(NULL, "sinfo->data.p[%d] = %f", i, sinfo->data.p[i]);
-              }
-#endif
-              (void) ::dispatch(sinfo->name, sinfo->data.p, sinfo->n_args, NULL);
-            }
-        }
-		if (audio_configured && interactive()) {
-			if (RTOption::print())
-                RTPrintf("RTcmixMain::sockit(): audio configured.\n");
-		}
-	  }
-
-      // Main socket reading loop
-      while(1) {
-		sptr = (char *)sinfo;
-		amt = read(ns, (void *)sptr, sizeof(struct sockdata));
-        while (amt < sizeof(struct sockdata)) {
-            amt += read(ns, (void *)(sptr+amt), sizeof(struct sockdata)-amt);
-        }
-        if (strlen(sinfo->name) == 0) {
-            rtcmix_warn(NULL, "bad socket command (NULL command name)");
-            continue;
-        }
-		if (strcmp(sinfo->name, "RTcmix_off") == 0) {
-			RTPrintf("RTcmix termination cmd received.\n");
-			run_status = RT_SHUTDOWN;	// Notify inTraverse()
- 			shutdown(s,0);
-			return NULL;
-		}
-		else if (strcmp(sinfo->name, "RTcmix_panic") == 0) {
-			int count = 30;
-			RTPrintf("RTcmix panic cmd received...\n");
-			panic();	// Notify inTraverse()
-			while (count--) {
-#ifdef linux
-				usleep(1000);
-#endif
-			}
-			RTPrintf("Resuming normal mode\n");
-			run_status = RT_GOOD;	// Notify inTraverse()
-            continue;
-		}
-        else if (strcmp(sinfo->name, "score")==0) {
-            for (int n = 0; n < sinfo->n_args; ++n) {
-                parse_score_buffer(sinfo->data.text[n], (int)strlen(sinfo->data.text[0]));
-            }
-            continue;
-        }
-		else {
-            if (strcmp(sinfo->name, "rtinput") == 0 ||
-                strcmp(sinfo->name, "rtoutput") == 0 ||
-                strcmp(sinfo->name,"set_option") == 0 ||
-                strcmp(sinfo->name,"bus_config") == 0 ||
-                strcmp(sinfo->name, "load")==0 ) {
-                
-                // these two commands use text data
-                // replace the text[i] with p[i] pointers
-                for (i = 0; i < sinfo->n_args; i++)
-                    strcpy(ttext[i],sinfo->data.text[i]);
-                for (i = 0; i < sinfo->n_args; i++) {
-                    sinfo->data.p[i] = STRING_TO_DOUBLE(ttext[i]);
-                }
-            }
-#ifdef DBUG
-		  RTPrintf("sockit(): elapsed = %llu\n", (unsigned long long)getElapsed());
-		  RTPrintf("SR = %f\n", SR());
-          rtcmix_debug(NULL, "RTcmixMain::sockit: RECIEVED command");
-          rtcmix_debug(NULL, "sinfo->name = %s", sinfo->name);
-          rtcmix_debug(NULL, "sinfo->n_args = %d", (int)sinfo->n_args);
-          for (i=0;i<sinfo->n_args;i++) {
-              rtcmix_debug(NULL, "sinfo->data.p[%d] = %f", i, sinfo->data.p[i]);
-          }
-#endif
-          (void) ::dispatch(sinfo->name, sinfo->data.p, sinfo->n_args, NULL);
-		}
-      }
     }
+
+    // Returns when a client sends RTcmix_off.
+    SockitHandler handler(noParse != 0);
+    server.serve(handler);
 #ifdef DBUG
     cout << "EXITING sockit() FUNCTION **********\n";
 #endif
+    return NULL;
 }
 
 #ifdef EMBEDDED
@@ -32,6 +32,7 @@ protected:
 	static void		set_sig_handlers();
 
 	static void *	sockit(void *);
+	class SockitHandler;
 #ifdef OSC
     int             runUsingOSC();
 	static void *   OSC_Server(void *);
@@ -5,6 +5,12 @@
 
 /* These are the publically-visible API routines for embedded RTcmix platforms */
 
+/* The engine's state (buses, the note heap and queue, the input files,
+   Instrument::SR and so on) is process-wide, as is the Minc parser's, so
+   these routines drive the one engine in each loaded copy of the library.
+   Hosts that need several independent engines, such as the pd external,
+   load a separate copy of the library for each. */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,6 +22,8 @@ extern "C" {
 	int RTcmix_init(void);
 	int RTcmix_destroy(void);
 	int RTcmix_setparams(float sr, int nchans, int vecsize, int recording, int bus_count);
+	// Call after RTcmix_init() and before RTcmix_setparams().  A count of 0 means one thread per CPU.
+	int RTcmix_setThreadCount(int count);
 	void RTcmix_setBangCallback(RTcmixBangCallback inBangCallback, void *inContext);
 	void RTcmix_setValuesCallback(RTcmixValuesCallback inValuesCallback, void *inContext);
 	void RTcmix_setPrintCallback(RTcmixPrintCallback inPrintCallback, void *inContext);
@@ -37,7 +45,8 @@ extern "C" {
 	int RTcmix_setAudioBufferFormat(RTcmix_AudioFormat format, int nchans);
     // Set this to 0 to run non-interactively (i.e., parse the score completely first, then start running audio).
     void RTcmix_setInteractive(int interactive);
-	// Call this to send and receive audio from RTcmix
+	// Call this to send and receive audio from RTcmix.  nframes need not match
+	// the vector size given to RTcmix_init/resetAudio, and may change between calls.
 	int RTcmix_runAudio(void *inAudioBuffer, void *outAudioBuffer, int nframes);
 #endif
 	int RTcmix_parseScore(char *theBuf, int buflen);
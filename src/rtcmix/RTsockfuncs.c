@@ -274,6 +274,191 @@ RTsockstr *RTnewsockstr(char *name)
   return theSock;
 }
 
+/* Binary protocol.  Everything is sent little-endian, whatever the host. */
+
+struct RTbinbatch {
+  unsigned char *buf;
+  size_t size, capacity;
+  int count;
+};
+
+#define RTBIN_HEADER 5		/* uint32 length, uint8 type */
+
+static unsigned char *put16(unsigned char *p, unsigned val)
+{
+  p[0] = val & 0xff;
+  p[1] = (val >> 8) & 0xff;
+  return p + 2;
+}
+
+static void putheader(unsigned char *p, size_t length, int type)
+{
+  p[0] = length & 0xff;
+  p[1] = (length >> 8) & 0xff;
+  p[2] = (length >> 16) & 0xff;
+  p[3] = (length >> 24) & 0xff;
+  p[4] = type;
+}
+
+static int writeall(int theSock, const void *data, size_t len)
+{
+  const char *p = (const char *)data;
+  while (len > 0) {
+    ssize_t amt = write(theSock, p, len);
+    if (amt < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("RTsockfuncs: write");
+      return -1;
+    }
+    p += amt;
+    len -= amt;
+  }
+  return 0;
+}
+
+/* Send a message whose body is <len> bytes, laid out after RTBIN_HEADER
+   bytes of room at the start of <msg>. */
+
+static int sendmessage(int theSock, unsigned char *msg, size_t len, int type)
+{
+  if (len + 1 > RTBIN_MAX_MESSAGE)
+    return -1;
+  putheader(msg, len + 1, type);
+  return writeall(theSock, msg, RTBIN_HEADER + len);
+}
+
+int RTbinopen(int theSock)
+{
+  return writeall(theSock, RTBIN_MAGIC, 4);
+}
+
+int RTbindefine(int theSock, int id, const char *cmd)
+{
+  size_t len = strlen(cmd);
+  unsigned char *msg = (unsigned char *)malloc(RTBIN_HEADER + 2 + len);
+  int ret;
+  if (msg == NULL)
+    return -1;
+  put16(msg + RTBIN_HEADER, id);
+  memcpy(msg + RTBIN_HEADER + 2, cmd, len);
+  ret = sendmessage(theSock, msg, 2 + len, RTBIN_DEFINE);
+  free(msg);
+  return ret;
+}
+
+RTbinbatch *RTnewbinbatch(void)
+{
+  RTbinbatch *batch = (RTbinbatch *)malloc(sizeof(RTbinbatch));
+  if (batch == NULL)
+    return NULL;
+  batch->capacity = 4096;
+  batch->buf = (unsigned char *)malloc(batch->capacity);
+  batch->size = RTBIN_HEADER + 2;	/* room for the note count */
+  batch->count = 0;
+  return batch;
+}
+
+/* Append one note (or any numeric command) to <batch>.  Returns -1 when the
+   batch is full; send it and add the note again. */
+
+int RTbinbatchadd(RTbinbatch *batch, int id, int nargs, const double *fields)
+{
+  size_t need = 4 + (size_t)nargs * 8;
+  unsigned char *p;
+  int i, b;
+
+  if (nargs < 0 || nargs > MAXDISPARGS || batch->count == 0xffff
+      || batch->size + need - RTBIN_HEADER + 1 > RTBIN_MAX_MESSAGE)
+    return -1;
+  if (batch->size + need > batch->capacity) {
+    unsigned char *newbuf;
+    size_t newcap = batch->capacity * 2;
+    while (newcap < batch->size + need)
+      newcap *= 2;
+    newbuf = (unsigned char *)realloc(batch->buf, newcap);
+    if (newbuf == NULL)
+      return -1;
+    batch->buf = newbuf;
+    batch->capacity = newcap;
+  }
+  p = put16(batch->buf + batch->size, id);
+  p = put16(p, nargs);
+  for (i = 0; i < nargs; i++) {
+    unsigned long long bits;
+    memcpy(&bits, &fields[i], 8);
+    for (b = 0; b < 8; b++, bits >>= 8)
+      *p++ = bits & 0xff;
+  }
+  batch->size += need;
+  batch->count++;
+  return 0;
+}
+
+/* Send everything added since the last send, and empty the batch. */
+
+int RTsendbinbatch(int theSock, RTbinbatch *batch)
+{
+  int ret;
+  if (batch->count == 0)
+    return 0;
+  put16(batch->buf + RTBIN_HEADER, batch->count);
+  ret = sendmessage(theSock, batch->buf, batch->size - RTBIN_HEADER, RTBIN_NOTES);
+  batch->size = RTBIN_HEADER + 2;
+  batch->count = 0;
+  return ret;
+}
+
+void RTfreebinbatch(RTbinbatch *batch)
+{
+  free(batch->buf);
+  free(batch);
+}
+
+/* A command with string arguments, e.g. rtinput or load. */
+
+int RTsendbintext(int theSock, int id, int nargs, const char **text)
+{
+  size_t len = 4;
+  unsigned char *msg, *p;
+  int i, ret;
+
+  if (nargs < 0 || nargs > MAXDISPARGS)
+    return -1;
+  for (i = 0; i < nargs; i++) {
+    if (strlen(text[i]) > 0xffff)
+      return -1;
+    len += 2 + strlen(text[i]);
+  }
+  msg = (unsigned char *)malloc(RTBIN_HEADER + len);
+  if (msg == NULL)
+    return -1;
+  p = put16(msg + RTBIN_HEADER, id);
+  p = put16(p, nargs);
+  for (i = 0; i < nargs; i++) {
+    size_t tlen = strlen(text[i]);
+    p = put16(p, tlen);
+    memcpy(p, text[i], tlen);
+    p += tlen;
+  }
+  ret = sendmessage(theSock, msg, len, RTBIN_TEXT);
+  free(msg);
+  return ret;
+}
+
+int RTsendbinscore(int theSock, const char *text)
+{
+  size_t len = strlen(text);
+  unsigned char *msg = (unsigned char *)malloc(RTBIN_HEADER + len);
+  int ret;
+  if (msg == NULL)
+    return -1;
+  memcpy(msg + RTBIN_HEADER, text, len);
+  ret = sendmessage(theSock, msg, len, RTBIN_SCORE);
+  free(msg);
+  return ret;
+}
+
 /* RTtimeit takes a floating point number of seconds (interval) and a pointer
    to a void-returning function and sets up a timer to call that function
    every interval seconds.  Setting interval to 0.0 should disable the
@@ -31,6 +31,28 @@ struct sockdata *newRTsockstr(char *name, int);
 
 struct sockdata *RTnewsockstr(char *name);
 
+/* Binary protocol (see sockdefs.h).  Call RTbinopen() once on a new
+   connection, bind small ids to command names with RTbindefine(), and then
+   send notes in batches.  These return 0, or -1 on error. */
+
+typedef struct RTbinbatch RTbinbatch;
+
+int RTbinopen(int theSock);
+
+int RTbindefine(int theSock, int id, const char *cmd);
+
+RTbinbatch *RTnewbinbatch(void);
+
+int RTbinbatchadd(RTbinbatch *batch, int id, int nargs, const double *fields);
+
+int RTsendbinbatch(int theSock, RTbinbatch *batch);
+
+void RTfreebinbatch(RTbinbatch *batch);
+
+int RTsendbintext(int theSock, int id, int nargs, const char **text);
+
+int RTsendbinscore(int theSock, const char *text);
+
 void RTtimeit(float interval, void *func);
 
 void parse(char *buf, char**);
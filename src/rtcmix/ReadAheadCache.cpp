@@ -0,0 +1,212 @@
+// ReadAheadCache.cpp -- disk I/O thread and block cache for streamed input files.
+//
+
+#include <ReadAheadCache.h>
+#include <ugens.h>
+#include <WorkerThread.h>
+#include <unistd.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <algorithm>
+
+using namespace std;
+
+static const long kMinBlockBytes = 16 * 1024;
+static const long kBlockAlignment = 4096;
+static const int kMinBlocksPerStream = 4;
+
+vector<ReadAheadCache *>	ReadAheadCache::sCaches;
+pthread_mutex_t				ReadAheadCache::sCacheLock = PTHREAD_MUTEX_INITIALIZER;
+RTSemaphore					ReadAheadCache::sWakeup;
+pthread_t					ReadAheadCache::sThread;
+bool						ReadAheadCache::sRunning = false;
+
+ReadAheadCache::ReadAheadCache(int inFd, off_t inDataStart, off_t inEndByte,
+							   long inRequestBytes, long inCacheBytes)
+	: mFd(inFd), mDataStart(inDataStart), mEndByte(inEndByte), mClock(0), mHits(0), mMisses(0)
+{
+	// A request may span two blocks but never three.
+	mBlockBytes = max(inRequestBytes, kMinBlockBytes);
+	mBlockBytes = ((mBlockBytes + kBlockAlignment - 1) / kBlockAlignment) * kBlockAlignment;
+	mBlocksPerStream = max((int) (inCacheBytes / kMaxStreams / mBlockBytes), kMinBlocksPerStream);
+	mAhead = mBlocksPerStream / 2;
+	const int blockCount = mBlocksPerStream * kMaxStreams;
+	mBlocks = new Block[blockCount];
+	mStorage = new char[(size_t) blockCount * mBlockBytes];
+	for (int n = 0; n < blockCount; ++n)
+		mBlocks[n].data = &mStorage[(size_t) n * mBlockBytes];
+	registerCache(this);
+}
+
+ReadAheadCache::~ReadAheadCache()
+{
+	unregisterCache(this);		// after this, the I/O thread no longer sees us
+	delete [] mBlocks;
+	delete [] mStorage;
+}
+
+// Match a read to the stream it continues, or recycle the least recently used
+// stream for it.  Any race between audio threads here can only cost hits, since
+// the block tags, not the streams, decide what is resident.
+
+ReadAheadCache::Stream *ReadAheadCache::findStream(off_t inOffset)
+{
+	const off_t window = mBlockBytes * (mBlocksPerStream - mAhead);
+	Stream *oldest = &mStreams[0];
+	for (int s = 0; s < kMaxStreams; ++s) {
+		Stream &stream = mStreams[s];
+		const off_t next = stream.nextOffset.load(memory_order_relaxed);
+		if (next >= 0 && inOffset >= next - window && inOffset <= next + mBlockBytes)
+			return &stream;
+		if (stream.lastUse.load(memory_order_relaxed) < oldest->lastUse.load(memory_order_relaxed))
+			oldest = &stream;
+	}
+	return oldest;
+}
+
+bool ReadAheadCache::copyBlock(long inBlockNum, long inBlockOffset, long inBytes, char *outDest)
+{
+	for (int s = 0; s < kMaxStreams; ++s) {
+		Block &block = slotFor(s, inBlockNum);
+		const unsigned seq = block.seq.load(memory_order_acquire);
+		if ((seq & 1) != 0 || block.tag.load(memory_order_relaxed) != inBlockNum)
+			continue;
+		if (inBlockOffset + inBytes > block.length.load(memory_order_relaxed))
+			continue;
+		memcpy(outDest, block.data + inBlockOffset, inBytes);
+		atomic_thread_fence(memory_order_acquire);
+		if (block.seq.load(memory_order_relaxed) == seq)
+			return true;		// not refilled underneath us
+	}
+	return false;
+}
+
+bool ReadAheadCache::read(off_t inOffset, long inBytes, void *outDest)
+{
+	if (inOffset < mDataStart || inBytes > mBlockBytes) {
+		mMisses.fetch_add(1, memory_order_relaxed);
+		return false;
+	}
+	// Tell the I/O thread where this stream is now, before we look.
+	Stream *stream = findStream(inOffset);
+	const long firstBlock = (long) ((inOffset - mDataStart) / mBlockBytes);
+	stream->nextOffset.store(inOffset + inBytes, memory_order_relaxed);
+	stream->lastUse.store(mClock.fetch_add(1, memory_order_relaxed) + 1, memory_order_relaxed);
+	if (stream->wanted.exchange(firstBlock, memory_order_release) != firstBlock)
+		sWakeup.post();
+
+	const long valid = max(0L, (long) min((off_t) inBytes, mEndByte - inOffset));
+	char *dest = (char *) outDest;
+	off_t pos = inOffset - mDataStart;
+	for (long remaining = valid; remaining > 0; ) {
+		const long blockNum = (long) (pos / mBlockBytes);
+		const long blockOffset = (long) (pos - (off_t) blockNum * mBlockBytes);
+		const long bytes = min(remaining, mBlockBytes - blockOffset);
+		if (!copyBlock(blockNum, blockOffset, bytes, dest)) {
+			mMisses.fetch_add(1, memory_order_relaxed);
+			return false;
+		}
+		dest += bytes;
+		pos += bytes;
+		remaining -= bytes;
+	}
+	memset(dest, 0, inBytes - valid);
+	mHits.fetch_add(1, memory_order_relaxed);
+	return true;
+}
+
+// I/O thread, with sCacheLock held.
+
+void ReadAheadCache::service()
+{
+	const long lastBlock = (long) ((mEndByte - mDataStart + mBlockBytes - 1) / mBlockBytes);
+	for (int s = 0; s < kMaxStreams; ++s) {
+		const long first = mStreams[s].wanted.load(memory_order_acquire);
+		if (first < 0)
+			continue;
+		for (long blockNum = first; blockNum < first + mAhead && blockNum < lastBlock; ++blockNum) {
+			bool resident = false;
+			for (int t = 0; t < kMaxStreams && !resident; ++t)
+				resident = (slotFor(t, blockNum).tag.load(memory_order_relaxed) == blockNum);
+			if (!resident)
+				fill(slotFor(s, blockNum), blockNum);
+			// If this reader has moved on (e.g., rtinrepos), start over from there.
+			if (mStreams[s].wanted.load(memory_order_relaxed) != first)
+				break;
+		}
+	}
+}
+
+void ReadAheadCache::fill(Block &inBlock, long inBlockNum)
+{
+	const unsigned seq = inBlock.seq.load(memory_order_relaxed);
+	inBlock.seq.store(seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	inBlock.tag.store(-1, memory_order_relaxed);
+	const off_t start = mDataStart + (off_t) inBlockNum * mBlockBytes;
+	const long wanted = (long) min((off_t) mBlockBytes, mEndByte - start);
+	long length = 0;
+	while (length < wanted) {
+		ssize_t bytes = pread(mFd, inBlock.data + length, wanted - length, start + length);
+		if (bytes < 0 && errno == EINTR)
+			continue;
+		if (bytes <= 0)
+			break;		// the synchronous read on a miss will report any error
+		length += bytes;
+	}
+	inBlock.length.store(length, memory_order_relaxed);
+	inBlock.tag.store(inBlockNum, memory_order_relaxed);
+	inBlock.seq.store(seq + 2, memory_order_release);
+}
+
+void ReadAheadCache::registerCache(ReadAheadCache *inCache)
+{
+	pthread_mutex_lock(&sCacheLock);
+	sCaches.push_back(inCache);
+	if (!sRunning) {
+		sRunning = true;
+		if (createWorkerThread(&sThread, sProcess, NULL) != 0) {
+			rtcmix_warn("ReadAheadCache", "Unable to start disk I/O thread; input files will be read synchronously");
+			sRunning = false;
+		}
+	}
+	pthread_mutex_unlock(&sCacheLock);
+}
+
+void ReadAheadCache::unregisterCache(ReadAheadCache *inCache)
+{
+	pthread_mutex_lock(&sCacheLock);
+	vector<ReadAheadCache *>::iterator it = find(sCaches.begin(), sCaches.end(), inCache);
+	if (it != sCaches.end())
+		sCaches.erase(it);
+	pthread_mutex_unlock(&sCacheLock);
+}
+
+void ReadAheadCache::stopThread()
+{
+	pthread_mutex_lock(&sCacheLock);
+	const bool wasRunning = sRunning;
+	sRunning = false;
+	pthread_mutex_unlock(&sCacheLock);
+	if (wasRunning) {
+		sWakeup.post();
+		pthread_join(sThread, NULL);
+	}
+}
+
+void *ReadAheadCache::sProcess(void *)
+{
+	for (;;) {
+		sWakeup.wait();
+		pthread_mutex_lock(&sCacheLock);
+		if (!sRunning) {
+			pthread_mutex_unlock(&sCacheLock);
+			break;
+		}
+		for (size_t n = 0; n < sCaches.size(); ++n)
+			sCaches[n]->service();
+		pthread_mutex_unlock(&sCacheLock);
+	}
+	return NULL;
+}
@@ -0,0 +1,86 @@
+// ReadAheadCache.h
+//
+// Read-ahead cache for a streamed (non-InMemoryType) InputFile.  A single
+// low-priority disk I/O thread fills fixed-size blocks ahead of each
+// instrument's read position, so that InputFile::readSamps() can usually copy
+// from memory instead of doing lseek() and read() inside the audio callback.
+//
+// Blocks are direct-mapped by absolute file offset, so an instrument's
+// fileOffset and any rtinrepos() seek need no special handling:  a read that
+// is not continuous with a stream we know about claims the least recently used
+// stream, and its blocks are fetched from that point on.  The audio thread
+// never blocks or locks here; if the data is not resident, read() returns
+// false and the caller does a synchronous read as before.
+//
+
+#ifndef _RT_READAHEADCACHE_H_
+#define _RT_READAHEADCACHE_H_
+
+#include <sys/types.h>
+#include <pthread.h>
+#include <atomic>
+#include <vector>
+#include <RTSemaphore.h>
+
+class ReadAheadCache {
+public:
+	// <inDataStart> and <inEndByte> bound the sound data in the file.
+	// <inRequestBytes> is the size of a typical readSamps() request.
+	ReadAheadCache(int inFd, off_t inDataStart, off_t inEndByte,
+				   long inRequestBytes, long inCacheBytes);
+	~ReadAheadCache();
+	// Audio thread.  Copies <inBytes> at file offset <inOffset> to <outDest>,
+	// zero-filling past the end of the sound data.  Returns false on a miss.
+	bool	read(off_t inOffset, long inBytes, void *outDest);
+	long	hits() const { return mHits.load(std::memory_order_relaxed); }
+	long	misses() const { return mMisses.load(std::memory_order_relaxed); }
+	// Stops the disk I/O thread, if running.  Called at shutdown.
+	static void	stopThread();
+private:
+	enum { kMaxStreams = 4 };
+	struct Block {
+		Block() : seq(0), tag(-1), length(0), data(NULL) {}
+		std::atomic<unsigned>	seq;		// odd while being filled
+		std::atomic<long>		tag;		// block number held, or -1
+		std::atomic<long>		length;		// valid bytes in data
+		char *					data;
+	};
+	struct Stream {
+		Stream() : nextOffset(-1), wanted(-1), lastUse(0) {}
+		std::atomic<off_t>		nextOffset;	// where a continuing read would start
+		std::atomic<long>		wanted;		// block to fetch ahead from, or -1
+		std::atomic<unsigned long>	lastUse;
+	};
+	Stream *	findStream(off_t inOffset);
+	bool		copyBlock(long inBlockNum, long inBlockOffset, long inBytes, char *outDest);
+	Block &		slotFor(int inStream, long inBlockNum) {
+					return mBlocks[inStream * mBlocksPerStream + inBlockNum % mBlocksPerStream];
+				}
+	void		service();
+	void		fill(Block &inBlock, long inBlockNum);
+
+	static void		registerCache(ReadAheadCache *inCache);
+	static void		unregisterCache(ReadAheadCache *inCache);
+	static void *	sProcess(void *);
+
+	int			mFd;
+	off_t		mDataStart;
+	off_t		mEndByte;
+	long		mBlockBytes;
+	int			mBlocksPerStream;
+	long		mAhead;				// blocks to keep filled past the read position
+	Block *		mBlocks;
+	char *		mStorage;
+	Stream		mStreams[kMaxStreams];
+	std::atomic<unsigned long>	mClock;
+	std::atomic<long>	mHits;
+	std::atomic<long>	mMisses;
+
+	static std::vector<ReadAheadCache *>	sCaches;
+	static pthread_mutex_t	sCacheLock;
+	static RTSemaphore		sWakeup;
+	static pthread_t		sThread;
+	static bool				sRunning;
+};
+
+#endif	//	 _RT_READAHEADCACHE_H_
@@ -0,0 +1,105 @@
+// Reclaimer.cpp -- housekeeping thread which deletes dead Instruments.
+//
+
+#include <Reclaimer.h>
+#include <RefCounted.h>
+#include <ugens.h>
+#include <WorkerThread.h>
+#include <stddef.h>
+
+std::atomic<RefCounted *>	Reclaimer::sQueue(NULL);
+std::atomic<bool>			Reclaimer::sRunning(false);
+RTSemaphore					Reclaimer::sWakeup;
+pthread_t					Reclaimer::sThread;
+pthread_mutex_t				Reclaimer::sStatsLock = PTHREAD_MUTEX_INITIALIZER;
+long						Reclaimer::sReclaimCount = 0;
+int							Reclaimer::sMaxQueueDepth = 0;
+double						Reclaimer::sTotalLatency = 0.0;
+double						Reclaimer::sMaxLatency = 0.0;
+
+void Reclaimer::start()
+{
+	if (sRunning)
+		return;
+	sRunning = true;
+	if (createWorkerThread(&sThread, sProcess, NULL) != 0) {
+		rtcmix_warn("Reclaimer", "Unable to start housekeeping thread; instruments will be deleted on the audio thread");
+		sRunning = false;
+	}
+}
+
+void Reclaimer::stop()
+{
+	if (!sRunning)
+		return;
+	sRunning = false;
+	sWakeup.post();
+	pthread_join(sThread, NULL);
+	collect();		// anything pushed while the thread was exiting
+	reportStats("Reclaimer::stop");
+}
+
+// Called from RefCounted::unref() on whatever thread dropped the last reference.
+// This does not allocate or lock.
+
+bool Reclaimer::reclaim(RefCounted *inObject)
+{
+	if (!sRunning)
+		return false;
+	inObject->_reclaimTime = monotonicTime();
+	RefCounted *head = sQueue.load(std::memory_order_relaxed);
+	do {
+		inObject->_reclaimNext = head;
+	} while (!sQueue.compare_exchange_weak(head, inObject, std::memory_order_release, std::memory_order_relaxed));
+	sWakeup.post();
+	return true;
+}
+
+void *Reclaimer::sProcess(void *)
+{
+	while (sRunning) {
+		sWakeup.wait();
+		collect();
+	}
+	return NULL;
+}
+
+void Reclaimer::collect()
+{
+	RefCounted *object = sQueue.exchange(NULL, std::memory_order_acquire);
+	if (object == NULL)
+		return;
+	int depth = 0;
+	double totalLatency = 0.0, maxLatency = 0.0;
+	while (object != NULL) {
+		RefCounted *next = object->_reclaimNext;
+		const double latency = monotonicTime() - object->_reclaimTime;
+		totalLatency += latency;
+		if (latency > maxLatency)
+			maxLatency = latency;
+		++depth;
+		delete object;
+		object = next;
+	}
+	pthread_mutex_lock(&sStatsLock);
+	sReclaimCount += depth;
+	if (depth > sMaxQueueDepth)
+		sMaxQueueDepth = depth;
+	sTotalLatency += totalLatency;
+	if (maxLatency > sMaxLatency)
+		sMaxLatency = maxLatency;
+	pthread_mutex_unlock(&sStatsLock);
+}
+
+void Reclaimer::reportStats(const char *inCaller)
+{
+	pthread_mutex_lock(&sStatsLock);
+	if (sReclaimCount > 0) {
+		rtcmix_debug(inCaller, "reclaimed %ld instruments: latency avg %.3f ms, max %.3f ms; max queue depth %d",
+					 sReclaimCount, 1000.0 * sTotalLatency / sReclaimCount, 1000.0 * sMaxLatency, sMaxQueueDepth);
+	}
+	sReclaimCount = 0;
+	sMaxQueueDepth = 0;
+	sTotalLatency = sMaxLatency = 0.0;
+	pthread_mutex_unlock(&sStatsLock);
+}
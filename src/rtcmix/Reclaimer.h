@@ -0,0 +1,45 @@
+// Reclaimer.h
+//
+// Deferred destruction for RefCounted objects created with dispatchOnDelete
+// (i.e., Instruments).  When the last reference goes away on the audio thread,
+// the object is pushed onto a lock-free queue and deleted later by a
+// low-priority housekeeping thread, so that freeing PFieldSets and buffers and
+// closing input files never happens inside the audio callback.
+// Class is entirely static.
+//
+
+#ifndef _RT_RECLAIMER_H_
+#define _RT_RECLAIMER_H_
+
+#include <pthread.h>
+#include <atomic>
+#include <RTSemaphore.h>
+
+class RefCounted;
+
+class Reclaimer {
+public:
+	static void	start();
+	// Stops the thread and deletes anything still queued.
+	static void	stop();
+	// Returns false if the housekeeping thread is not running, in which
+	// case the caller must delete the object itself.
+	static bool	reclaim(RefCounted *inObject);
+	// Report (via rtcmix_debug) and reset latency and queue depth stats.
+	static void	reportStats(const char *inCaller);
+private:
+	static void *	sProcess(void *);
+	static void		collect();
+
+	static std::atomic<RefCounted *>	sQueue;
+	static std::atomic<bool>			sRunning;
+	static RTSemaphore					sWakeup;
+	static pthread_t					sThread;
+	static pthread_mutex_t				sStatsLock;
+	static long		sReclaimCount;
+	static int		sMaxQueueDepth;
+	static double	sTotalLatency;
+	static double	sMaxLatency;
+};
+
+#endif	//	 _RT_RECLAIMER_H_
@@ -2,6 +2,7 @@
 //
 
 #include <RefCounted.h>
+#include <Reclaimer.h>
 #include <assert.h>
 #ifdef USE_OSX_DISPATCH
 #include <dispatch/dispatch.h>
@@ -10,7 +11,7 @@
 RefCounted::~RefCounted()
 {
 #if defined(DEBUG_MEMORY) || defined(DEBUG)
-	if (_refcount > 0) { rtcmix_print("Refcounted::~RefCounted(this = %p): delete called on object with nonzero ref count!\n"); assert(0); }
+	if (refcount() > 0) { rtcmix_print("Refcounted::~RefCounted(this = %p): delete called on object with nonzero ref count!\n"); assert(0); }
 #endif
 }
 
@@ -18,9 +19,15 @@ int RefCounted::unref()
 {
 	int r;
 #if defined(DEBUG_MEMORY) || defined(DEBUG)
-	if (_refcount <= 0) { rtcmix_print("Refcounted::~RefCounted(this = %p): object already deleted!\n"); assert(0); }
+	if (refcount() <= 0) { rtcmix_print("Refcounted::~RefCounted(this = %p): object already deleted!\n"); assert(0); }
 #endif
-	if ((r=--_refcount) <= 0) {
+	// The release pairs with the acquire in whichever thread drops the count
+	// to zero, so that it sees every other thread's use of the object.
+	if ((r = _refcount.fetch_sub(1, std::memory_order_acq_rel) - 1) <= 0) {
+		// Objects created with dispatchOnDelete are deleted off this thread.
+		if (_dispatch && Reclaimer::reclaim(this)) {
+			return r;
+		}
 #ifdef USE_OSX_DISPATCH
         if (_dispatch) {
             dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
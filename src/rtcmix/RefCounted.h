@@ -1,28 +1,36 @@
 // RefCounted.h
 //
 // Base class for objects which are held by reference in multiple locations.
+// The count is atomic, because an object may be shared between threads (the
+// parser, the audio thread and the Reclaimer).
 //
 
 #ifndef _RT_REFCOUNTED_H_
 #define _RT_REFCOUNTED_H_
 
+#include <atomic>
+
 class RefCounted {
 public:
 #ifdef DEBUG_MEMORY
-	virtual int ref() { return ++_refcount; }
+	virtual int ref() { return _refcount.fetch_add(1, std::memory_order_relaxed) + 1; }
 	virtual int unref();
 #else
-	int ref() { return ++_refcount; }
+	int ref() { return _refcount.fetch_add(1, std::memory_order_relaxed) + 1; }
 	int unref();
 #endif
 	static void ref(RefCounted *r);
 	static int unref(RefCounted *r);
+	int refcount() const { return _refcount.load(std::memory_order_acquire); }
 protected:
-	RefCounted(bool dispatchOnDelete=false) : _refcount(0), _dispatch(dispatchOnDelete) {}
+	RefCounted(bool dispatchOnDelete=false) : _refcount(0), _dispatch(dispatchOnDelete), _reclaimNext(0), _reclaimTime(0.0) {}
 	virtual ~RefCounted();
 private:
-	int _refcount;
+	friend class Reclaimer;
+	std::atomic<int> _refcount;
     bool  _dispatch;
+	RefCounted *_reclaimNext;	// link and timestamp for Reclaimer's queue
+	double _reclaimTime;
 };
 
 #endif	//	 _RT_REFCOUNTED_H_
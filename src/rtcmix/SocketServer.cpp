@@ -0,0 +1,466 @@
+// SocketServer.cpp -- multi-client reader for the RTcmix socket interface.
+//
+
+#include "SocketServer.h"
+#include <sockdefs.h>
+#include <ugens.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <algorithm>
+
+#if defined(LINUX) && !defined(FREEBSD)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+using namespace std;
+
+static const size_t kReadBytes = 64 * 1024;
+static const int kMaxEvents = 32;
+// Messages dispatched from one client before the others get a turn.
+static const int kMaxMessagesPerWakeup = 64;
+
+enum { kUnknownProtocol, kLegacyProtocol, kBinaryProtocol };
+
+struct SocketServer::Client {
+	Client(int inFd) : fd(inFd), protocol(kUnknownProtocol), used(0), start(0),
+					   backlog(false), round(0) {}
+	int						fd;
+	int						protocol;
+	vector<unsigned char>	buffer;
+	size_t					used;		// bytes read into buffer
+	size_t					start;		// first byte not yet processed
+	bool					backlog;	// stopped with messages still to dispatch
+	unsigned				round;		// last time through serve() we read it
+	vector<string>			names;		// binary protocol command ids
+	vector<string>			strings;	// RTBIN_TEXT arguments, while dispatched
+};
+
+static inline unsigned get16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t get32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline double getDouble(const unsigned char *p)
+{
+	uint64_t bits = 0;
+	for (int n = 7; n >= 0; --n)
+		bits = (bits << 8) | p[n];
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+// Commands whose legacy sockdata carries text[] rather than p[].
+
+static bool isTextCommand(const char *name)
+{
+	return strcmp(name, "rtinput") == 0 ||
+		   strcmp(name, "rtoutput") == 0 ||
+		   strcmp(name, "set_option") == 0 ||
+		   strcmp(name, "bus_config") == 0 ||
+		   strcmp(name, "load") == 0;
+}
+
+SocketServer::SocketServer()
+	: _listenFd(-1), _pollFd(-1), _pfields(MAXDISPARGS), _budget(0), _round(0)
+{
+}
+
+SocketServer::~SocketServer()
+{
+	while (!_clients.empty())
+		closeClient(_clients.back());
+	if (_pollFd >= 0)
+		::close(_pollFd);
+	if (_listenFd >= 0)
+		::close(_listenFd);
+}
+
+int SocketServer::open(int port)
+{
+	if ((_listenFd = ::socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+		perror("socket");
+		return -1;
+	}
+	int val = 1;
+	setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
+
+	struct sockaddr_in sss;
+	memset(&sss, 0, sizeof(sss));
+	sss.sin_family = AF_INET;
+	sss.sin_addr.s_addr = INADDR_ANY;
+	sss.sin_port = htons(port);
+	if (::bind(_listenFd, (struct sockaddr *) &sss, sizeof(sss)) < 0) {
+		perror("bind");
+		return -1;
+	}
+	if (::listen(_listenFd, SOMAXCONN) < 0) {
+		perror("listen");
+		return -1;
+	}
+	fcntl(_listenFd, F_SETFL, fcntl(_listenFd, F_GETFL) | O_NONBLOCK);
+#ifdef USE_EPOLL
+	if ((_pollFd = epoll_create1(0)) < 0) {
+		perror("epoll_create1");
+		return -1;
+	}
+#endif
+	if (!addWatch(_listenFd, NULL))
+		return -1;
+	return 0;
+}
+
+bool SocketServer::addWatch(int fd, void *tag)
+{
+#ifdef USE_EPOLL
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = tag;
+	if (epoll_ctl(_pollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+		perror("epoll_ctl");
+		return false;
+	}
+#endif
+	return true;
+}
+
+void SocketServer::removeWatch(int fd)
+{
+#ifdef USE_EPOLL
+	struct epoll_event event;	// ignored, but must be non-NULL on old kernels
+	epoll_ctl(_pollFd, EPOLL_CTL_DEL, fd, &event);
+#endif
+}
+
+void SocketServer::serve(Handler &handler)
+{
+	bool running = true;
+	while (running) {
+		++_round;
+		// Don't wait for more input while a client still has messages to go.
+		bool backlog = false;
+		for (size_t n = 0; n < _clients.size() && !backlog; ++n)
+			backlog = _clients[n]->backlog;
+		const int timeout = backlog ? 0 : -1;
+#ifdef USE_EPOLL
+		struct epoll_event events[kMaxEvents];
+		const int count = epoll_wait(_pollFd, events, kMaxEvents, timeout);
+#else
+		vector<struct pollfd> fds(_clients.size() + 1);
+		fds[0].fd = _listenFd;
+		fds[0].events = POLLIN;
+		for (size_t n = 0; n < _clients.size(); ++n) {
+			fds[n + 1].fd = _clients[n]->fd;
+			fds[n + 1].events = POLLIN;
+		}
+		// Snapshot, since reading a client may close it.
+		vector<Client *> polled(_clients);
+		const int count = ::poll(&fds[0], fds.size(), timeout);
+#endif
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("SocketServer::serve");
+			break;
+		}
+#ifdef USE_EPOLL
+		for (int n = 0; n < count && running; ++n) {
+			Client *client = (Client *) events[n].data.ptr;
+			if (client == NULL)
+				acceptClients();
+			else
+				running = readClient(client, handler);
+		}
+#else
+		if (fds[0].revents & POLLIN)
+			acceptClients();
+		for (size_t n = 0; n < polled.size() && running; ++n) {
+			if (fds[n + 1].revents & (POLLIN | POLLHUP | POLLERR))
+				running = readClient(polled[n], handler);
+		}
+#endif
+		if (backlog && running) {
+			// Only a client's own readClient() can close it.
+			vector<Client *> waiting(_clients);
+			for (size_t n = 0; n < waiting.size() && running; ++n) {
+				if (waiting[n]->backlog && waiting[n]->round != _round)
+					running = readClient(waiting[n], handler);
+			}
+		}
+	}
+	while (!_clients.empty())
+		closeClient(_clients.back());
+	::shutdown(_listenFd, SHUT_RD);
+}
+
+void SocketServer::acceptClients()
+{
+	for (;;) {
+		const int fd = ::accept(_listenFd, NULL, NULL);
+		if (fd < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				perror("SocketServer: accept");
+			return;
+		}
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		Client *client = new Client(fd);
+		if (!addWatch(fd, client)) {
+			::close(fd);
+			delete client;
+			continue;
+		}
+		_clients.push_back(client);
+		rtcmix_debug("SocketServer", "client connected (%d open)", (int) _clients.size());
+	}
+}
+
+void SocketServer::closeClient(Client *client)
+{
+	removeWatch(client->fd);
+	::close(client->fd);
+	_clients.erase(find(_clients.begin(), _clients.end(), client));
+	delete client;
+	rtcmix_debug("SocketServer", "client disconnected (%d open)", (int) _clients.size());
+}
+
+// Dispatches the commands <client> has sent, reading more until it has no
+// more to give, but stops after kMaxMessagesPerWakeup messages so that one
+// busy client cannot starve the rest.  What is left stays in its buffer for
+// the next time through serve().  Returns false if the handler asked us to
+// stop.
+
+bool SocketServer::readClient(Client *client, Handler &handler)
+{
+	client->round = _round;
+	_budget = kMaxMessagesPerWakeup;
+	for (;;) {
+		bool ok = true;
+		const bool running = processInput(client, handler, &ok);
+		if (!running)
+			return false;
+		if (!ok) {
+			closeClient(client);
+			return true;
+		}
+		// Keep unprocessed bytes at the front.
+		if (client->start > 0) {
+			memmove(&client->buffer[0], &client->buffer[client->start], client->used - client->start);
+			client->used -= client->start;
+			client->start = 0;
+		}
+		client->backlog = (_budget == 0);
+		if (client->backlog)
+			return true;
+		if (client->buffer.size() - client->used < kReadBytes)
+			client->buffer.resize(client->used + kReadBytes);
+		const ssize_t bytes = ::read(client->fd, &client->buffer[client->used], kReadBytes);
+		if (bytes < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return true;
+			closeClient(client);
+			return true;
+		}
+		if (bytes == 0) {
+			closeClient(client);
+			return true;
+		}
+		client->used += bytes;
+	}
+}
+
+bool SocketServer::processInput(Client *client, Handler &handler, bool *ok)
+{
+	if (client->protocol == kUnknownProtocol) {
+		if (client->used < 4)
+			return true;
+		if (memcmp(&client->buffer[0], RTBIN_MAGIC, 4) == 0) {
+			client->protocol = kBinaryProtocol;
+			client->start = 4;
+		}
+		else
+			client->protocol = kLegacyProtocol;
+	}
+	if (client->protocol == kLegacyProtocol)
+		return processLegacy(client, handler, ok);
+	return processBinary(client, handler, ok);
+}
+
+// Original protocol:  one struct sockdata, in host byte order, per command.
+
+bool SocketServer::processLegacy(Client *client, Handler &handler, bool *ok)
+{
+	struct sockdata sinfo;
+	while (_budget > 0 && client->used - client->start >= sizeof(struct sockdata)) {
+		memcpy(&sinfo, &client->buffer[client->start], sizeof(struct sockdata));
+		client->start += sizeof(struct sockdata);
+		--_budget;
+		sinfo.name[sizeof(sinfo.name) - 1] = '\0';
+		if (strlen(sinfo.name) == 0) {
+			rtcmix_warn(NULL, "bad socket command (NULL command name)");
+			continue;
+		}
+		if (sinfo.n_args < 0 || sinfo.n_args > MAXDISPARGS) {
+			rtcmix_warn(NULL, "bad socket command (%d arguments)", sinfo.n_args);
+			*ok = false;
+			return true;
+		}
+		const bool isText = isTextCommand(sinfo.name) || strcmp(sinfo.name, "score") == 0;
+		if (isText) {
+			if (sinfo.n_args > (int) MAXTEXTARGS) {
+				rtcmix_warn(NULL, "bad socket command (%d text arguments)", sinfo.n_args);
+				*ok = false;
+				return true;
+			}
+			for (int n = 0; n < sinfo.n_args; ++n)
+				sinfo.data.text[n][sizeof(sinfo.data.text[n]) - 1] = '\0';
+		}
+		if (strcmp(sinfo.name, "score") == 0) {
+			for (int n = 0; n < sinfo.n_args; ++n)
+				handler.score(sinfo.data.text[n], (int) strlen(sinfo.data.text[n]));
+			continue;
+		}
+		double *p = sinfo.data.p;
+		if (isText) {
+			// Replace the text with pointers to it.
+			for (int n = 0; n < sinfo.n_args; ++n)
+				_pfields[n] = STRING_TO_DOUBLE(sinfo.data.text[n]);
+			p = &_pfields[0];
+		}
+		if (!handler.command(sinfo.name, p, sinfo.n_args))
+			return false;
+	}
+	return true;
+}
+
+// Binary protocol:  see sockdefs.h.
+
+bool SocketServer::processBinary(Client *client, Handler &handler, bool *ok)
+{
+	while (_budget > 0 && client->used - client->start >= 4) {
+		const unsigned char *msg = &client->buffer[client->start];
+		const uint32_t length = get32(msg);
+		if (length < 1 || length > RTBIN_MAX_MESSAGE) {
+			rtcmix_warn(NULL, "bad socket message (length %u)", (unsigned) length);
+			*ok = false;
+			return true;
+		}
+		if (client->used - client->start < 4 + (size_t) length)
+			break;
+		client->start += 4 + length;
+		--_budget;
+		if (!handleMessage(client, msg[4], msg + 5, length - 1, handler, ok))
+			return false;
+		if (!*ok)
+			return true;
+	}
+	return true;
+}
+
+bool SocketServer::handleMessage(Client *client, int type, const unsigned char *body,
+								 unsigned length, Handler &handler, bool *ok)
+{
+	const unsigned char *end = body + length;
+	switch (type) {
+	case RTBIN_DEFINE: {
+		if (length < 3) {
+			rtcmix_warn(NULL, "bad socket message (short command definition)");
+			*ok = false;
+			return true;
+		}
+		const unsigned id = get16(body);
+		if (id >= client->names.size())
+			client->names.resize(id + 1);
+		client->names[id].assign((const char *) body + 2, length - 2);
+		return true;
+	}
+	case RTBIN_NOTES: {
+		if (length < 2)
+			break;
+		const unsigned count = get16(body);
+		const unsigned char *p = body + 2;
+		unsigned note;
+		for (note = 0; note < count; ++note) {
+			if (end - p < 4)
+				break;
+			const unsigned id = get16(p);
+			const unsigned nargs = get16(p + 2);
+			p += 4;
+			if (nargs > MAXDISPARGS || (size_t) (end - p) < nargs * 8)
+				break;
+			if (id >= client->names.size() || client->names[id].empty()) {
+				rtcmix_warn(NULL, "bad socket message (undefined command id %u)", id);
+				*ok = false;
+				return true;
+			}
+			for (unsigned n = 0; n < nargs; ++n, p += 8)
+				_pfields[n] = getDouble(p);
+			if (!handler.command(client->names[id].c_str(), &_pfields[0], nargs))
+				return false;
+		}
+		if (note < count || p != end)
+			break;
+		return true;
+	}
+	case RTBIN_TEXT: {
+		if (length < 4)
+			break;
+		const unsigned id = get16(body);
+		const unsigned nargs = get16(body + 2);
+		if (nargs > MAXDISPARGS)
+			break;
+		if (id >= client->names.size() || client->names[id].empty()) {
+			rtcmix_warn(NULL, "bad socket message (undefined command id %u)", id);
+			*ok = false;
+			return true;
+		}
+		const unsigned char *p = body + 4;
+		client->strings.resize(nargs);
+		unsigned n;
+		for (n = 0; n < nargs; ++n) {
+			if (end - p < 2)
+				break;
+			const unsigned len = get16(p);
+			p += 2;
+			if ((unsigned) (end - p) < len)
+				break;
+			client->strings[n].assign((const char *) p, len);
+			p += len;
+		}
+		if (n < nargs || p != end)
+			break;
+		for (n = 0; n < nargs; ++n)
+			_pfields[n] = STRING_TO_DOUBLE(client->strings[n].c_str());
+		return handler.command(client->names[id].c_str(), &_pfields[0], nargs);
+	}
+	case RTBIN_SCORE: {
+		string text((const char *) body, length);
+		handler.score(&text[0], (int) length);
+		return true;
+	}
+	default:
+		rtcmix_warn(NULL, "bad socket message (unknown type %d)", type);
+		*ok = false;
+		return true;
+	}
+	rtcmix_warn(NULL, "bad socket message (malformed type %d message)", type);
+	*ok = false;
+	return true;
+}
@@ -0,0 +1,59 @@
+// SocketServer.h
+//
+// TCP server for RTcmix's socket interface (the -s option).  Accepts any
+// number of clients and reads all of them from one thread, with epoll on
+// Linux and poll() elsewhere, so commands are still dispatched one at a time.
+// Clients take turns, a bounded number of messages each.
+// Each client speaks either the original protocol (one fixed-size struct
+// sockdata per command) or the binary protocol described in sockdefs.h,
+// chosen by the first four bytes it sends.
+//
+
+#ifndef _RT_SOCKETSERVER_H_
+#define _RT_SOCKETSERVER_H_
+
+#include <string>
+#include <vector>
+
+class SocketServer {
+public:
+	// Receives decoded commands, in order, on the serve() thread.
+	class Handler {
+	public:
+		virtual ~Handler() {}
+		// Return false to shut the server down.
+		virtual bool command(const char *name, double *p, int n_args) = 0;
+		virtual void score(char *text, int len) = 0;
+	};
+
+	SocketServer();
+	~SocketServer();
+	// Bind and listen on <port>.  Returns -1 (after reporting why) on failure.
+	int		open(int port);
+	// Read and dispatch commands until the handler returns false or a
+	// listening error occurs.  Closes all connections on return.
+	void	serve(Handler &handler);
+
+private:
+	struct Client;
+
+	void	acceptClients();
+	bool	readClient(Client *client, Handler &handler);
+	bool	processInput(Client *client, Handler &handler, bool *ok);
+	bool	processLegacy(Client *client, Handler &handler, bool *ok);
+	bool	processBinary(Client *client, Handler &handler, bool *ok);
+	bool	handleMessage(Client *client, int type, const unsigned char *body,
+						  unsigned length, Handler &handler, bool *ok);
+	void	closeClient(Client *client);
+	bool	addWatch(int fd, void *tag);
+	void	removeWatch(int fd);
+
+	int						_listenFd;
+	int						_pollFd;		// epoll descriptor (Linux)
+	std::vector<Client *>	_clients;
+	std::vector<double>		_pfields;
+	int						_budget;		// messages left in this client's turn
+	unsigned				_round;			// passes through serve()
+};
+
+#endif	// _RT_SOCKETSERVER_H_
@@ -0,0 +1,196 @@
+// TableCache.cpp -- shared tables for maketable() and makegen().
+//
+
+#include <TableCache.h>
+#include <PField.h>
+#include <RTOption.h>
+#include <ugens.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+TableCache::EntryMap	TableCache::sEntries;
+pthread_mutex_t			TableCache::sLock = PTHREAD_MUTEX_INITIALIZER;
+unsigned long			TableCache::sClock = 0;
+size_t					TableCache::sTableBytes = 0;
+long					TableCache::sHits = 0;
+long					TableCache::sMisses = 0;
+double					TableCache::sBytesSaved = 0.0;
+
+bool TableCache::Key::addFile(const char *path)
+{
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return false;
+	add(path);
+	add((double) st.st_mtime);
+	add((double) st.st_size);
+	return true;
+}
+
+bool TableCache::enabled()
+{
+	return RTOption::tableCache() > 0;
+}
+
+TablePField *TableCache::find(const Key &inKey)
+{
+	TablePField *table = NULL;
+	pthread_mutex_lock(&sLock);
+	EntryMap::iterator it = sEntries.find(inKey.bytes());
+	if (it != sEntries.end() && it->second.table != NULL) {
+		Entry &entry = it->second;
+		entry.lastUse = ++sClock;
+		table = entry.table;
+		table->ref();
+		++sHits;
+		sBytesSaved += entry.bytes;
+	}
+	else
+		++sMisses;
+	pthread_mutex_unlock(&sLock);
+	return table;
+}
+
+void TableCache::add(const Key &inKey, TablePField *inTable)
+{
+	pthread_mutex_lock(&sLock);
+	Entry &entry = sEntries[inKey.bytes()];
+	if (entry.table == NULL) {
+		inTable->ref();
+		entry.table = inTable;
+		entry.array = NULL;
+		entry.size = inTable->values();
+		entry.retval = 0.0;
+		entry.bytes = inTable->storageBytes();
+		entry.lastUse = ++sClock;
+		sTableBytes += entry.bytes;
+		trim();
+	}
+	pthread_mutex_unlock(&sLock);
+}
+
+bool TableCache::holds(const PField *inTable)
+{
+	bool found = false;
+	pthread_mutex_lock(&sLock);
+	for (EntryMap::iterator it = sEntries.begin(); it != sEntries.end() && !found; ++it)
+		found = (it->second.table != NULL && it->second.table == inTable);
+	pthread_mutex_unlock(&sLock);
+	return found;
+}
+
+// Drop the least recently used of the tables that only the cache refers to,
+// until the rest fit within the budget.  Called with the lock held.  Other
+// threads may unref a table while we look, but once only the cache refers
+// to one, nobody but find() can ref it again, and find() takes the lock.
+
+void TableCache::trim()
+{
+	const size_t budget = (size_t) RTOption::tableCache() * 1024 * 1024;
+	if (sTableBytes <= budget)
+		return;
+	vector<pair<unsigned long, EntryMap::iterator> > idle;
+	for (EntryMap::iterator it = sEntries.begin(); it != sEntries.end(); ++it) {
+		if (it->second.table != NULL && it->second.table->refcount() == 1)
+			idle.push_back(make_pair(it->second.lastUse, it));
+	}
+	sort(idle.begin(), idle.end(),
+		 [](const pair<unsigned long, EntryMap::iterator> &a,
+			const pair<unsigned long, EntryMap::iterator> &b) { return a.first < b.first; });
+	for (size_t n = 0; n < idle.size() && sTableBytes > budget; ++n) {
+		Entry &entry = idle[n].second->second;
+		sTableBytes -= entry.bytes;
+		entry.table->unref();
+		sEntries.erase(idle[n].second);
+	}
+}
+
+double *TableCache::findGen(const Key &inKey, int *outSize, double *outRetval)
+{
+	double *array = NULL;
+	pthread_mutex_lock(&sLock);
+	EntryMap::iterator it = sEntries.find(inKey.bytes());
+	if (it != sEntries.end() && it->second.array != NULL) {
+		Entry &entry = it->second;
+		array = entry.array;
+		*outSize = entry.size;
+		*outRetval = entry.retval;
+		++sHits;
+		sBytesSaved += entry.bytes;
+	}
+	else
+		++sMisses;
+	pthread_mutex_unlock(&sLock);
+	return array;
+}
+
+void TableCache::addGen(const Key &inKey, double *inTable, int inSize, double inRetval)
+{
+	pthread_mutex_lock(&sLock);
+	Entry &entry = sEntries[inKey.bytes()];
+	entry.table = NULL;
+	entry.array = inTable;
+	entry.size = inSize;
+	entry.retval = inRetval;
+	entry.bytes = inSize * sizeof(double);
+	entry.lastUse = ++sClock;
+	pthread_mutex_unlock(&sLock);
+}
+
+void TableCache::clear()
+{
+	pthread_mutex_lock(&sLock);
+	const long lookups = sHits + sMisses;
+	if (sHits > 0)
+		rtcmix_advise(NULL, "Table cache: %ld of %ld tables shared (%.0f%%), %.1f MB saved.",
+					  sHits, lookups, 100.0 * sHits / lookups, sBytesSaved / (1024.0 * 1024.0));
+	for (EntryMap::iterator it = sEntries.begin(); it != sEntries.end(); ++it) {
+		if (it->second.table != NULL)
+			it->second.table->unref();
+	}
+	sEntries.clear();
+	sTableBytes = 0;
+	sHits = sMisses = 0;
+	sBytesSaved = 0.0;
+	pthread_mutex_unlock(&sLock);
+}
+
+// makegen() keys.  gen1 reads a sound file, and old-style gen2 (one argument
+// after the size) reads from the score or a file, so gen1 is keyed by its
+// file and gen2 that way is not cached, nor is gen20, which is random.
+
+static bool makeGenKey(const double p[], int n_args, TableCache::Key &key)
+{
+	const int genno = (int) p[1];
+	if (genno == 20 || (genno == 2 && n_args == 4))
+		return false;
+	key.add((double) genno);
+	key.add(p[0] < 0 ? -1.0 : 1.0);		// negative slot means no rescaling
+	for (int n = 2; n < n_args; ++n) {
+		if (genno == 1 && n == 3) {
+			if (!key.addFile(DOUBLE_TO_STRING(p[n])))
+				return false;
+		}
+		else
+			key.add(p[n]);
+	}
+	return true;
+}
+
+double *table_cache_find_gen(const double p[], int n_args, int *size, double *retval)
+{
+	TableCache::Key key("makegen");
+	if (!TableCache::enabled() || !makeGenKey(p, n_args, key))
+		return NULL;
+	return TableCache::findGen(key, size, retval);
+}
+
+void table_cache_add_gen(const double p[], int n_args, double *table, int size, double retval)
+{
+	TableCache::Key key("makegen");
+	if (table != NULL && retval != -1.0 && TableCache::enabled() && makeGenKey(p, n_args, key))
+		TableCache::addGen(key, table, size, retval);
+}
@@ -0,0 +1,90 @@
+// TableCache.h
+//
+// Content-addressed cache of the tables made by maketable() and makegen().
+// Scores often build the same envelope or waveform once per note; the cache
+// keys each table by its kind and arguments, so that a repeated request gets
+// the table already made instead of computing and storing another copy.
+//
+// Cached tables are shared, so they must not be written to;  modtable()'s
+// "draw" works on a copy of one.  maketable()
+// tables are TablePFields, and the cache holds a reference to each one;  it
+// keeps unused tables up to the "table_cache" option's size in MB, dropping
+// the least recently used beyond that.  makegen() tables are never freed, so
+// the cache just remembers them.  Tables read from files are keyed by the
+// file's modification time and size too.  Random tables are never cached.
+//
+
+#ifndef _RT_TABLECACHE_H_
+#define _RT_TABLECACHE_H_
+
+#ifdef __cplusplus
+
+#include <pthread.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+
+class PField;
+class TablePField;
+
+class TableCache {
+public:
+	// The bytes that identify one table.
+	class Key {
+	public:
+		Key(const char *family) : _bytes(family) { _bytes += '\0'; }
+		void	add(double value) { _bytes += 'd'; _bytes.append((const char *) &value, sizeof(value)); }
+		void	add(const char *str) { _bytes += 's'; _bytes.append(str, strlen(str) + 1); }
+		// Adds the file's modification time and size.  Returns false if
+		// there is no such file, in which case the table is not cached.
+		bool	addFile(const char *path);
+		const std::string &	bytes() const { return _bytes; }
+	private:
+		std::string	_bytes;
+	};
+	static bool	enabled();
+	// Returns the cached table with a reference added for the caller, or NULL.
+	static TablePField *	find(const Key &inKey);
+	static void				add(const Key &inKey, TablePField *inTable);
+	// Whether <inTable> is one of the cache's, and so may be shared.
+	static bool				holds(const PField *inTable);
+	static double *			findGen(const Key &inKey, int *outSize, double *outRetval);
+	static void				addGen(const Key &inKey, double *inTable, int inSize, double inRetval);
+	// Reports the hit rate and bytes saved, and drops all tables.
+	static void				clear();
+private:
+	struct Entry {
+		TablePField *	table;		// NULL for a makegen() table
+		double *		array;
+		int				size;
+		double			retval;
+		size_t			bytes;
+		unsigned long	lastUse;
+	};
+	typedef std::unordered_map<std::string, Entry> EntryMap;
+	static void		trim();
+
+	static EntryMap			sEntries;
+	static pthread_mutex_t	sLock;
+	static unsigned long	sClock;
+	static size_t			sTableBytes;	// held by maketable() entries
+	static long				sHits;
+	static long				sMisses;
+	static double			sBytesSaved;
+};
+
+#endif	// __cplusplus
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// For makegen():  <p> and <n_args> are its arguments.
+double *table_cache_find_gen(const double p[], int n_args, int *size, double *retval);
+void table_cache_add_gen(const double p[], int n_args, double *table, int size, double retval);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	//	 _RT_TABLECACHE_H_
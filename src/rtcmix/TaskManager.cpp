@@ -15,7 +15,10 @@
 #include "rt_types.h"
 #include <pthread.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <assert.h>
+#include <atomic>
+#include <algorithm>
 
 #ifdef LINUX
 #include <sys/time.h>
@@ -49,16 +52,18 @@ private:
 class TaskThread : public RTThread, Notifier
 {
 public:
-	TaskThread(Notifiable *inTarget, TaskProvider *inProvider, int inIndex)
+	TaskThread(Notifiable *inTarget, TaskProvider *inProvider, int inIndex, int inPriority, bool inPin)
 		: RTThread(inIndex), Notifier(inTarget, inIndex),
-		  mStopping(false), mTaskProvider(inProvider) { start(); }
+		  mStopping(false), mPriority(inPriority), mPin(inPin), mTaskProvider(inProvider) { start(); }
 	~TaskThread() { mStopping = true; wake(); }
 	inline void wake();
 protected:
 	virtual void	run();
-	Task *			getATask() { return mTaskProvider->getSingleTask(); }
+	Task *			getATask() { return mTaskProvider->getSingleTask(getIndex()); }
 private:
 	bool			mStopping;
+	int				mPriority;
+	bool			mPin;
 	TaskProvider *	mTaskProvider;
 	RTSemaphore		mSema;
 };
@@ -85,6 +90,12 @@ void TaskThread::run()
     char threadName[16];
     snprintf(threadName, 16, "TaskThread %d", getIndex());
     setName(threadName);
+	if (mPriority > 0 && setPriority(mPriority) != 0) {
+		fprintf(stderr, "TaskThread %d: unable to set realtime priority %d\n", getIndex(), mPriority);
+	}
+	if (mPin && setAffinity(getIndex()) != 0) {
+		fprintf(stderr, "TaskThread %d: unable to set CPU affinity\n", getIndex());
+	}
 	do {
 #ifdef THREAD_DEBUG
 		printf("TaskThread %d sleeping...\n", tIndex);
@@ -135,32 +146,32 @@ void TaskThread::run()
 class ThreadPool : private Notifiable
 {
 public:
-	ThreadPool(TaskProvider *inProvider) : mRequestCount(0), mThreadSema(RT_THREAD_COUNT), mWaitSema(0) {
-		for(int i=0; i<RT_THREAD_COUNT; ++i) {
-			mThreads[i] = new TaskThread(this, inProvider, i);
+	ThreadPool(TaskProvider *inProvider, int inThreadCount, int inPriority, bool inPin)
+		: mThreadCount(inThreadCount), mThreads(new TaskThread *[inThreadCount]), mRequestCount(0), mWaitSema(0) {
+		for(int i=0; i<mThreadCount; ++i) {
+			mThreads[i] = new TaskThread(this, inProvider, i, inPriority, inPin);
 		}
 	}
 	virtual ~ThreadPool() {
-		for(int i=0; i<RT_THREAD_COUNT; ++i)
+		for(int i=0; i<mThreadCount; ++i)
 			delete mThreads[i];
+		delete [] mThreads;
 	}
 	virtual void notify(int inIndex);
-	inline void startAndWait(int taskCount);
+	inline void startAndWait(int threadCount);
 private:
-	TaskThread		*mThreads[RT_THREAD_COUNT];
+	int				mThreadCount;
+	TaskThread		**mThreads;
 	AtomicInt		mRequestCount;
-	RTSemaphore		mThreadSema;
 	RTSemaphore		mWaitSema;
 };
 
-inline void ThreadPool::startAndWait(int taskCount) {
-	// Dont wake any more threads than we have tasks.
-	mRequestCount = (int) std::min(taskCount, RT_THREAD_COUNT);
-	const int count = (int) mRequestCount;
-	for(int i=0; i<count; ++i)
+inline void ThreadPool::startAndWait(int threadCount) {
+	mRequestCount = threadCount;
+	for(int i=0; i<threadCount; ++i)
 		mThreads[i]->wake();
 #ifdef POOL_DEBUG
-	printf("ThreadPool::startAndWait: waiting on %d threads\n", count);
+	printf("ThreadPool::startAndWait: waiting on %d threads\n", threadCount);
 #endif
 	mWaitSema.wait();
 }
@@ -181,10 +192,87 @@ void ThreadPool::notify(int inIndex)
 	}
 }
 
-TaskManagerImpl::TaskManagerImpl()
-	: mThreadPool(new ThreadPool(this)), mTaskHead(NULL), mTaskTail(NULL) {}
+// TaskDeque holds the tasks dealt to one thread.  The tasks are only written
+// while the pool is idle; once published, the owning thread takes from the
+// front and other threads steal from the back.  Both ends are packed into a
+// single 64-bit word so that either operation is one compare-and-swap.
+
+class TaskDeque
+{
+public:
+	TaskDeque() : mEnds(0) {}
+	// Returns true if the deque had to grow to hold the new task.
+	bool	push(Task *inTask) {
+		const bool grow = mTasks.size() == mTasks.capacity();
+		mTasks.push_back(inTask);
+		return grow;
+	}
+	template <typename Function> void	forEach(Function inFunction) {
+		for (size_t n = 0; n < mTasks.size(); ++n) inFunction(mTasks[n]);
+	}
+	void	publish() { mEnds.store(pack(0, (uint32_t) mTasks.size()), std::memory_order_release); }
+	void	clear() { mTasks.clear(); mEnds.store(0, std::memory_order_relaxed); }
+	inline Task *	take();
+	inline Task *	steal();
+private:
+	static uint64_t	pack(uint32_t front, uint32_t back) { return ((uint64_t) back << 32) | front; }
+	static uint32_t	front(uint64_t ends) { return (uint32_t) ends; }
+	static uint32_t	back(uint64_t ends) { return (uint32_t) (ends >> 32); }
+
+	std::vector<Task *>		mTasks;
+	std::atomic<uint64_t>	mEnds;
+};
 
-TaskManagerImpl::~TaskManagerImpl() { delete mThreadPool; }
+inline Task * TaskDeque::take()
+{
+	uint64_t ends = mEnds.load(std::memory_order_acquire);
+	while (front(ends) < back(ends)) {
+		if (mEnds.compare_exchange_weak(ends, pack(front(ends) + 1, back(ends)),
+										std::memory_order_acq_rel))
+			return mTasks[front(ends)];
+	}
+	return NULL;
+}
+
+inline Task * TaskDeque::steal()
+{
+	uint64_t ends = mEnds.load(std::memory_order_acquire);
+	while (front(ends) < back(ends)) {
+		if (mEnds.compare_exchange_weak(ends, pack(front(ends), back(ends) - 1),
+										std::memory_order_acq_rel))
+			return mTasks[back(ends) - 1];
+	}
+	return NULL;
+}
+
+TaskManagerImpl::TaskManagerImpl(int inThreadCount, int inPriority, bool inPinThreads)
+	: mThreadCount(inThreadCount), mThreadPool(NULL), mTaskHead(NULL), mTaskTail(NULL),
+	  mTaskDeques(new TaskDeque[inThreadCount]),
+	  mSlotsUsed(0), mSlotCapacity(0), mAllocationCount(0)
+{
+	mThreadPool = new ThreadPool(this, inThreadCount, inPriority, inPinThreads);
+	growTaskSlots();
+}
+
+TaskManagerImpl::~TaskManagerImpl()
+{
+	delete mThreadPool;
+	delete [] mTaskDeques;
+	for (size_t n = 0; n < mSlotBlocks.size(); ++n)
+		delete [] mSlotBlocks[n];
+}
+
+void TaskManagerImpl::growTaskSlots()
+{
+#ifdef DEBUG
+	printf("TaskManagerImpl::growTaskSlots: adding %d slots to %d\n", kTaskSlotsPerBlock, mSlotCapacity);
+#endif
+	mSlotBlocks.push_back(new char[kTaskSlotsPerBlock * kTaskSlotSize]);
+	mSlotCapacity += kTaskSlotsPerBlock;
+	++mAllocationCount;
+}
+
+static void destroyTask(Task *inTask) { inTask->~Task(); }
 
 void TaskManagerImpl::addTask(Task *inTask)
 {
@@ -196,11 +284,16 @@ void TaskManagerImpl::addTask(Task *inTask)
 	mTaskHead = inTask;
 }
 
-Task * TaskManagerImpl::getSingleTask()
+// Called by each worker thread.  Drain our own deque first, then go stealing.
+
+Task * TaskManagerImpl::getSingleTask(int inThreadIndex)
 {
-	Task *task = mTaskStack.pop_atomic();
+	Task *task = mTaskDeques[inThreadIndex].take();
+	for (int n = 1; task == NULL && n < mThreadCount; ++n) {
+		task = mTaskDeques[(inThreadIndex + n) % mThreadCount].steal();
+	}
 #ifdef DEBUG
-	printf("TaskManagerImpl::getSingleTask: returning task %p from stack\n", task);
+	printf("TaskManagerImpl::getSingleTask: returning task %p for thread %d\n", task, inThreadIndex);
 #endif
 	return task;
 }
@@ -208,26 +301,44 @@ Task * TaskManagerImpl::getSingleTask()
 void TaskManagerImpl::startAndWait()
 {
 #ifdef DEBUG
-	printf("TaskManagerImpl::startAndWait pushing tasks onto stack\n");
+	printf("TaskManagerImpl::startAndWait dealing tasks to thread deques\n");
 #endif
 	int taskCount = 0;
-	// Push entire reversed linked list into stack
-	for (Task *t = mTaskHead; t != NULL; ++taskCount) {
+	for (Task *t = mTaskHead; t != NULL; t = t->next())
+		++taskCount;
+	// Dont wake any more threads than we have tasks.
+	const int threadCount = std::min(taskCount, mThreadCount);
+	// Deal the (reversed) linked list out round-robin to the threads we will wake.
+	int index = 0;
+	for (Task *t = mTaskHead; t != NULL; ) {
 		Task *next = t->next();
-		mTaskStack.push_atomic(t);
+		if (mTaskDeques[index].push(t))
+			++mAllocationCount;
+		if (++index == threadCount)
+			index = 0;
 		t = next;
 	}
 	mTaskHead = mTaskTail = NULL;
+	for (int i = 0; i < threadCount; ++i)
+		mTaskDeques[i].publish();
 #ifdef DEBUG
-    printf("TaskManagerImpl::startAndWait waiting on ThreadPool for %d tasks...\n", taskCount);
+    printf("TaskManagerImpl::startAndWait waiting on ThreadPool for %d tasks on %d threads...\n", taskCount, threadCount);
 #endif
-	mThreadPool->startAndWait(taskCount);
+	if (threadCount > 0)
+		mThreadPool->startAndWait(threadCount);
+	// Every task has run: destroy them and hand their slots back to the pool.
+	for (int i = 0; i < threadCount; ++i) {
+		mTaskDeques[i].forEach(destroyTask);
+		mTaskDeques[i].clear();
+	}
+	mSlotsUsed = 0;
 #ifdef DEBUG
 	printf("TaskManagerImpl::startAndWait done\n");
 #endif
 }
 
-TaskManager::TaskManager() : mImpl(new TaskManagerImpl)
+TaskManager::TaskManager(int inThreadCount, int inPriority, bool inPinThreads)
+	: mImpl(new TaskManagerImpl(inThreadCount, inPriority, inPinThreads))
 {
 }
 
@@ -235,4 +346,3 @@ TaskManager::~TaskManager()
 {
 	delete mImpl;
 }
-
@@ -12,7 +12,8 @@
 #define _TASKMANAGER_H_
 
 #include <vector>
-#include "atomic_stack.h"
+#include <new>
+#include <stddef.h>
 
 #ifndef RT_THREAD_COUNT
 #define RT_THREAD_COUNT 2
@@ -34,7 +35,7 @@ private:
 class TaskProvider {
 public:
     virtual ~TaskProvider() {}
-	virtual Task *	getSingleTask() = 0;
+	virtual Task *	getSingleTask(int inThreadIndex) = 0;
 };
 
 template <typename Object, typename Ret, Ret (Object::*Method)()>
@@ -84,26 +85,64 @@ private:
 
 class ThreadPool;
 
+class TaskDeque;
+
+// Every Task is constructed in a fixed-size slot owned by the TaskManager.
+// The slots are recycled once startAndWait() returns, so tasks are no longer
+// new'd and deleted once the pool has grown to the largest task count seen.
+// getAllocationCount() counts only the times the slot pool or a thread deque
+// has had to grow; it does not see any other allocation.
+
+static const size_t kTaskSlotSize = 64;
+
+// Each worker thread owns a TaskDeque.  startAndWait() deals the pending tasks
+// out across the deques of the threads it wakes; a thread whose own deque runs
+// dry steals from the back of the others until every deque is empty.
+
 class TaskManagerImpl : public TaskProvider
 {
 public:
-	TaskManagerImpl();
+	TaskManagerImpl(int inThreadCount, int inPriority, bool inPinThreads);
 	virtual ~TaskManagerImpl();
-	virtual Task *	getSingleTask();
+	virtual Task *	getSingleTask(int inThreadIndex);
+	inline void *	allocTaskSlot();
 	void	addTask(Task *inTask);
 	void	startAndWait();
+	int		getThreadCount() const { return mThreadCount; }
+	long	getAllocationCount() const { return mAllocationCount; }
 private:
+	void	growTaskSlots();
+
+	int						mThreadCount;
 	ThreadPool *			mThreadPool;
 	Task *					mTaskHead;
 	Task *					mTaskTail;
-	TAtomicStack2<Task>		mTaskStack;
+	TaskDeque *				mTaskDeques;
+	vector<char *>			mSlotBlocks;
+	int						mSlotsUsed;
+	int						mSlotCapacity;
+	long					mAllocationCount;
 };
 
+static const int kTaskSlotsPerBlock = 256;
+
+inline void * TaskManagerImpl::allocTaskSlot()
+{
+	if (mSlotsUsed == mSlotCapacity)
+		growTaskSlots();
+	const int slot = mSlotsUsed++;
+	return mSlotBlocks[slot / kTaskSlotsPerBlock] + (slot % kTaskSlotsPerBlock) * kTaskSlotSize;
+}
+
 class TaskManager
 {
 public:
-	TaskManager();
+	// inPriority > 0 requests SCHED_FIFO at that priority for the worker threads.
+	// inPinThreads binds worker N to CPU N (where the platform supports it).
+	TaskManager(int inThreadCount=RT_THREAD_COUNT, int inPriority=0, bool inPinThreads=false);
 	~TaskManager();
+	int		getThreadCount() const { return mImpl->getThreadCount(); }
+	long	getAllocationCount() const { return mImpl->getAllocationCount(); }
 	template <typename Object, typename Ret, Ret (Object::*Method)()>
 	inline void addTask(Object * inObject);
 	template <typename Object, typename Ret, typename Arg, Ret (Object::*Method)(Arg)>
@@ -112,6 +151,7 @@ public:
 	inline void addTask(Object * inObject, Arg1 inArg1, Arg2 inArg2);
 	template <typename Object>
 	inline void waitForTasks(vector<Object *> &ioVector);
+	inline void waitForTasks();
 private:
 	TaskManagerImpl	*mImpl;
 };
@@ -119,19 +159,25 @@ private:
 template <typename Object, typename Ret, Ret (Object::*Method)()>
 inline void TaskManager::addTask(Object * inObject)
 {
-	mImpl->addTask(new NoArgumentTask<Object, Ret, Method>(inObject));
+	typedef NoArgumentTask<Object, Ret, Method> TaskType;
+	static_assert(sizeof(TaskType) <= kTaskSlotSize, "Task too large for slot");
+	mImpl->addTask(new (mImpl->allocTaskSlot()) TaskType(inObject));
 }
 
 template <typename Object, typename Ret, typename Arg, Ret (Object::*Method)(Arg)>
 inline void TaskManager::addTask(Object * inObject, Arg inArg)
 {
-	mImpl->addTask(new OneArgumentTask<Object, Ret, Arg, Method>(inObject, inArg));
+	typedef OneArgumentTask<Object, Ret, Arg, Method> TaskType;
+	static_assert(sizeof(TaskType) <= kTaskSlotSize, "Task too large for slot");
+	mImpl->addTask(new (mImpl->allocTaskSlot()) TaskType(inObject, inArg));
 }
 
 template <typename Object, typename Ret, typename Arg1, typename Arg2, Ret (Object::*Method)(Arg1, Arg2)>
 inline void TaskManager::addTask(Object * inObject, Arg1 inArg1, Arg2 inArg2)
 {
-	mImpl->addTask(new TwoArgumentTask<Object, Ret, Arg1, Arg2, Method>(inObject, inArg1, inArg2));
+	typedef TwoArgumentTask<Object, Ret, Arg1, Arg2, Method> TaskType;
+	static_assert(sizeof(TaskType) <= kTaskSlotSize, "Task too large for slot");
+	mImpl->addTask(new (mImpl->allocTaskSlot()) TaskType(inObject, inArg1, inArg2));
 }
 
 template <typename Object>
@@ -140,4 +186,9 @@ inline void TaskManager::waitForTasks(vector<Object *> &ioVector)
 	mImpl->startAndWait();
 }
 
+inline void TaskManager::waitForTasks()
+{
+	mImpl->startAndWait();
+}
+
 #endif	// _TASKMANAGER_H_
@@ -0,0 +1,37 @@
+// WorkerThread.h
+//
+// Helpers for the housekeeping threads that run beside the audio thread
+// (instrument reclaiming, input read-ahead, output file writing).
+
+#ifndef RT_WORKERTHREAD_H
+#define RT_WORKERTHREAD_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// Start <proc> at normal (non-realtime) priority, whatever our creator uses,
+// so that the thread never competes with the audio thread.  Returns the
+// result of pthread_create().
+
+inline int createWorkerThread(pthread_t *outThread, void *(*proc)(void *), void *arg)
+{
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+	const int status = pthread_create(outThread, &attr, proc, arg);
+	pthread_attr_destroy(&attr);
+	return status;
+}
+
+// Seconds on a clock that is never set back, for timing.
+
+inline double monotonicTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+#endif	// RT_WORKERTHREAD_H
@@ -12,11 +12,11 @@
 #include <ug_intro.h>
 #include <string.h>
 #include <RTOption.h>
+#include "NameTable.h"
 
 #define WARN_DUPLICATES
 
 typedef struct _func {
-   struct _func *next;
    union {
       double (*legacy_return) (double *, int);
       double (*number_return) (const Arg[], int);
@@ -33,9 +33,11 @@ struct FunctionEntry {
 	~FunctionEntry();
 	char *funcName;
 	char *dsoPath;
-	struct FunctionEntry *next;
 };
 
+struct FunctionTable : public NameTable<RTcmixFunction *> {};
+struct FunctionRegistry : public NameTable<FunctionEntry *> {};
+
 /* --------------------------------------------------------------- addfunc -- */
 /* Place a function into the table we search when handed a function name
    from the parser.  addfunc is called only from the UG_INTRO* macros.
@@ -56,9 +58,9 @@ RTcmix::addfunc(
    int			    return_type,            /* return type of function */
    int    			legacy)                 /* use old function signature */
 {
-    RTcmixFunction *cur_node, *this_node = NULL;
+    RTcmixFunction *this_node = NULL;
 
-    /* Create and initialize new list node. */
+    /* Create and initialize new table entry. */
     try {
         this_node = new RTcmixFunction;
     }
@@ -68,7 +70,6 @@ RTcmix::addfunc(
       return;
    }
 
-   this_node->next = NULL;
    switch (return_type) {
       case DoubleType:
 	  	if (legacy)
@@ -91,27 +92,18 @@ RTcmix::addfunc(
    this_node->func_label = func_label;
    this_node->legacy = legacy;
 
-    bool autoload = RTOption::autoLoad();
-   /* Place new node at tail of list.  Warn if this function name is already
-      in list.
-   */
-   if (_func_list == NULL) {
-      _func_list = this_node;
-      return;
-   }
-   for (cur_node = _func_list; cur_node->next != NULL; cur_node = cur_node->next) {
+   /* Warn if this function name is already in the table. */
+   if (_func_table == NULL)
+      _func_table = new FunctionTable;
+   if (!_func_table->insert(std::make_pair(func_label, this_node)).second) {
 #ifdef WARN_DUPLICATES
-      if (strcmp(cur_node->func_label, this_node->func_label) == 0) {
-         if (!autoload)
-             rtcmix_advise("addfunc", "Function '%s' already introduced",
-                  this_node->func_label);
-          delete this_node;
-         return;
-      }
+      if (!RTOption::autoLoad())
+         rtcmix_advise("addfunc", "Function '%s' already introduced", func_label);
 #endif
+      delete this_node;
+      return;
    }
-//   RTPrintf("addfunc: Function '%s' introduced at %p\n", this_node->func_label, this_node->func_ptr.legacy_return);
-   cur_node->next = this_node;
+   ++sRegistryGeneration;
 } 
 
 
@@ -119,35 +111,29 @@ RTcmix::addfunc(
 void
 RTcmix::freefuncs()
 {
-	for (RTcmixFunction *cur_node = _func_list; cur_node; ) {
-		RTcmixFunction *next = cur_node->next;
-		delete cur_node;
-		cur_node = next;
+	if (_func_table != NULL) {
+		for (FunctionTable::iterator it = _func_table->begin(); it != _func_table->end(); ++it)
+			delete it->second;
+		delete _func_table;
+		_func_table = NULL;
 	}
-	_func_list = NULL;
 	
 	// DAS added 01/2014
 	
-	for (FunctionEntry *entry = _functionRegistry; entry; ) {
-		FunctionEntry *next = entry->next;
-		delete entry;
-		entry = next;
+	if (_functionRegistry != NULL) {
+		for (FunctionRegistry::iterator it = _functionRegistry->begin(); it != _functionRegistry->end(); ++it)
+			delete it->second;
+		delete _functionRegistry;
+		_functionRegistry = NULL;
 	}
-	_functionRegistry = NULL;
+	++sRegistryGeneration;
 }
 
 /* ------------------------------------------------------------- findfunc -- */
 static RTcmixFunction *
-findfunc(RTcmixFunction *func_list, const char *func_label)
+findfunc(const FunctionTable *func_table, const char *func_label)
 {
-   RTcmixFunction *cur_node;
-
-   for (cur_node = func_list; cur_node; cur_node = cur_node->next) {
-      if (strcmp(cur_node->func_label, func_label) == 0) {
-         return cur_node;
-      }
-   }
-   return NULL;
+   return (func_table != NULL) ? func_table->lookup(func_label) : NULL;
 }
 
 
@@ -178,12 +164,12 @@ RTcmix::checkfunc(const char *funcname, const Arg arglist[], const int nargs,
 {
    RTcmixFunction *func;
 
-   func = ::findfunc(_func_list, funcname);
+   func = ::findfunc(_func_table, funcname);
 
    // If we did not find it, try loading it from our list of registered DSOs.
    if (func == NULL) {
       if (findAndLoadFunction(funcname) == 0) {
-         func = ::findfunc(_func_list, funcname);
+         func = ::findfunc(_func_table, funcname);
 		  if (func == NULL) {
                return FUNCTION_NOT_FOUND;
 		  }
@@ -192,7 +178,29 @@ RTcmix::checkfunc(const char *funcname, const Arg arglist[], const int nargs,
 		  return FUNCTION_NOT_FOUND;
 	  }
    }
+   return callfunc(func, funcname, arglist, nargs, retval);
+}
+
+/* --------------------------------------------------------------- resolve -- */
+bool
+RTcmix::resolve(const char *func_label, DispatchHandle *outHandle)
+{
+   RTcmixFunction *func = ::findfunc(_func_table, func_label);
+
+   // If we did not find it, try loading it from our list of registered DSOs.
+   if (func == NULL && findAndLoadFunction(func_label) == 0)
+      func = ::findfunc(_func_table, func_label);
+   outHandle->function = func;
+   outHandle->creator = (func == NULL) ? findInstrument(func_label) : NULL;
+   outHandle->generation = sRegistryGeneration;
+   return func != NULL || outHandle->creator != NULL;
+}
 
+/* -------------------------------------------------------------- callfunc -- */
+int
+RTcmix::callfunc(RTcmixFunction *func, const char *funcname, const Arg arglist[],
+                 const int nargs, Arg *retval)
+{
    /* function found, so call it */
    /* DAS: in order to properly report errors within function that return doubles,
       we have to use try/catch because there are no return values guaranteed not
@@ -305,7 +313,7 @@ RTcmix::checkfunc(const char *funcname, const Arg arglist[], const int nargs,
 // for a given function.
 
 FunctionEntry::FunctionEntry(const char *fname, const char *dso_path)
-	: funcName(strdup(fname)), dsoPath(strdup(dso_path)), next(NULL)
+	: funcName(strdup(fname)), dsoPath(strdup(dso_path))
 {
 }
 
@@ -315,21 +323,10 @@ FunctionEntry::~FunctionEntry()
 	free(funcName);
 }
 
-static FunctionEntry *
-findFunctionEntry(FunctionEntry *entry, const char *funcname)
-{
-	while (entry != NULL) {
-		if (!strcmp(entry->funcName, funcname))
-			return entry;
-		entry = entry->next;
-	}
-	return NULL;
-}
-
 static const char *
-getDSOPath(FunctionEntry *entry, const char *funcname)
+getDSOPath(const FunctionRegistry *registry, const char *funcname)
 {
-	FunctionEntry * fentry = findFunctionEntry(entry, funcname);
+	FunctionEntry *fentry = (registry != NULL) ? registry->lookup(funcname) : NULL;
 	if (fentry != NULL)
         return fentry->dsoPath;
 	return NULL;
@@ -373,8 +370,9 @@ RTcmix::registerFunction(const char *funcName, const char *dsoPath)
 	const char *path;
 	if ((path = ::getDSOPath(_functionRegistry, funcName)) == NULL) {
 		FunctionEntry *newEntry = new FunctionEntry(funcName, dsoPath);
-		newEntry->next = _functionRegistry;
-		_functionRegistry = newEntry;
+		if (_functionRegistry == NULL)
+			_functionRegistry = new FunctionRegistry;
+		(*_functionRegistry)[newEntry->funcName] = newEntry;
 		RTPrintf("RTcmix::registerFunction: registered function '%s' for dso '%s'\n",
 				funcName, dsoPath);
 		return 0;
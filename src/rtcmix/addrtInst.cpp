@@ -18,8 +18,11 @@
 #include "rt.h"
 #include "Instrument.h"
 #include "mixerr.h"
+#include "NameTable.h"
 #include <string.h>
 
+struct InstrumentTable : public NameTable<InstCreatorFunction> {};
+
 int
 addrtInst(rt_item *rt_p)
 {
@@ -29,37 +32,38 @@ addrtInst(rt_item *rt_p)
 int
 RTcmix::addrtInst(rt_item *rt_p)
 {
-	// RTPrintf("ENTERING addrtInst() FUNCTION -----\n");
-	/*  Seek end of rt_list	*/
-    rt_item *rt_tail = rt_list;
-	
-	if (!rt_tail) { // first one on the list
-	  rt_list = rt_p;
-	  rt_p->rt_next = NULL;
-	  // RTPrintf("EXITING addrtInst() FUNCTION (0)-----\n");
-	  return 0;
-	}
-	for (rt_tail=rt_list; rt_tail->rt_next != NULL; rt_tail=rt_tail->rt_next)
-	{
-		if (!strcmp(rt_tail->rt_name, rt_p->rt_name))	{
-			mixerr = MX_FEXIST;
-			// RTPrintf("EXITING addrtInst() FUNCTION (MX_FEXIST)-----\n");
-			return (-1);
-		}
+	if (rt_table == NULL)
+		rt_table = new InstrumentTable;
+	std::pair<InstrumentTable::iterator, bool> inserted =
+		rt_table->insert(std::make_pair(rt_p->rt_name, rt_p->rt_ptr));
+	if (!inserted.second) {
+		// Loading the same DSO again is harmless.
+		if (inserted.first->second == rt_p->rt_ptr)
+			return (0);
+		mixerr = MX_FEXIST;
+		return (-1);
 	}
-	rt_tail->rt_next = rt_p;
-	rt_p->rt_next = NULL;
-	// RTPrintf("EXITING addrtInst() FUNCTION (0)-----\n");
+	++sRegistryGeneration;
 	return (0);
 }
 
-void
-RTcmix::clearRtInstList()
+InstCreatorFunction
+findrtInst(const char *inst_name)
 {
-    rt_list = NULL;     // Ths does not leak memory because all the rt_items were statics
+	return RTcmix::findInstrument(inst_name);
 }
 
+InstCreatorFunction
+RTcmix::findInstrument(const char *inst_name)
+{
+	return (rt_table != NULL) ? rt_table->lookup(inst_name) : NULL;
+}
 
-
-
-
+void
+RTcmix::clearRtInstList()
+{
+	// The rt_items themselves are statics.
+	delete rt_table;
+	rt_table = NULL;
+	++sRegistryGeneration;
+}
@@ -14,9 +14,13 @@
 #include <RTcmix.h>
 #include <RTThread.h>
 #include "prototypes.h"
-#include "InputFile.h"
+#include "InputFileTable.h"
+#include "MixKernels.h"
 #include <lock.h>
 #include <RTOption.h>
+#ifdef MULTI_THREAD
+#include "TaskManager.h"
+#endif
   
 //#define PRINTPLAY
 //#define DEBUG
@@ -470,6 +474,24 @@ RTcmix::bf_traverse(int bus, Bool visit) {
 #endif
 }
 
+/* ---------------------------------------------------------- bus_depth --- */
+/* Returns the length of the longest chain of aux buses feeding <bus>. */
+/* The graph has already been checked for loops. */
+static short
+bus_depth(const BusConfig *configs, int bus, short *depths) {
+  if (depths[bus] < 0) {
+	short depth = 0;
+	const CheckNode *node = configs[bus].In_Config;
+	for (int i = 0; node && i < node->bus_count; i++) {
+	  short in_depth = bus_depth(configs, node->bus_list[i], depths) + 1;
+	  if (in_depth > depth)
+		depth = in_depth;
+	}
+	depths[bus] = depth;
+  }
+  return depths[bus];
+}
+
 /* ----------------------------------------------------- create_play_order -- */
 void
 RTcmix::create_play_order() {
@@ -522,6 +544,17 @@ RTcmix::create_play_order() {
 	}
 	pthread_mutex_unlock(&aux_in_use_lock);
   }
+
+  /* Record each bus's depth in the graph.  The multi-threaded scheduler */
+  /* runs all instruments at the same depth together, so it needs one */
+  /* barrier per level of the graph rather than one per bus. */
+  short depths[MAXBUS];
+  for (i=0;i<busCount;i++)
+	depths[i] = -1;
+  pthread_mutex_lock(&bus_in_config_lock);
+  for (i=0;i<busCount;i++)
+	BusConfigs[i].Depth = bus_depth(BusConfigs, i, depths);
+  pthread_mutex_unlock(&bus_in_config_lock);
 }
 
 /* ------------------------------------------------------- get_bus_config --- */
@@ -664,6 +697,10 @@ RTcmix::get_bus_config(const char *inst_name)
 
 #ifdef MULTI_THREAD
 
+// Below this many mixes per wave, waking the worker threads costs more than
+// the mixing itself.
+static const int kParallelMixMinimum = 64;
+
 void
 RTcmix::addToBus(BusType type, int bus, BufPtr src, int offset, int endfr, int chans)
 {
@@ -672,7 +709,8 @@ RTcmix::addToBus(BusType type, int bus, BufPtr src, int offset, int endfr, int c
 								src,
 								(type == BUS_AUX_OUT) ? aux_buffer[bus] + offset : out_buffer[bus] + offset,
 								endfr - offset,
-								chans)
+								chans,
+								(type == BUS_AUX_OUT) ? busCount + bus : bus)
                         );
 	
 }
@@ -680,37 +718,62 @@ RTcmix::addToBus(BusType type, int bus, BufPtr src, int offset, int endfr, int c
 void
 RTcmix::mixOperation(MixData &m)
 {
-    BufPtr src = m.src;
-    BufPtr dest = m.dest;
-    const int framesOverFour = m.frames >> 2;
-    const int framesRemaining = m.frames - (framesOverFour << 2);
-    const int chans = m.channels;
-    const int chansx2 = chans << 1;
-    const int chansx3 = chansx2 + chans;
-    const int chansx4 = chansx2 + chansx2;
-    for (int n = 0; n < framesOverFour; ++n) {
-        dest[0] += src[0];
-        dest[1] += src[chans];
-        dest[2] += src[chansx2];
-        dest[3] += src[chansx3];
-        dest += 4;
-        src += chansx4;
-    }
-    for (int n = 0; n < framesRemaining; ++n) {
-        dest[n] += *src;
-        src += chans;
+    mixFrames(m.dest, m.src, m.frames, m.channels);
+}
+
+// Apply every mix whose destination bus falls in this partition.  No two
+// partitions share a bus, so they can run concurrently without locking.
+
+int
+RTcmix::BusMixer::mix(int inPartition, int inPartitionCount)
+{
+    for (int i = 0; i < sThreadCount; ++i) {
+        std::vector<MixData> &vector = mixVectors[i];
+        const int count = (int) vector.size();
+        for (int n = 0; n < count; ++n) {
+            MixData &m = vector[n];
+            if (m.destBus % inPartitionCount == inPartition)
+                mixOperation(m);
+        }
     }
+    return 0;
 }
 
 void
 RTcmix::mixToBus()
 {
     // Mix all vectors from each thread down to the final mix buses
-    for (int i = 0; i < RT_THREAD_COUNT; ++i) {
-        std::vector<MixData> &vector = mixVectors[i];
-        std::for_each(vector.begin(), vector.end(), mixOperation);
-        vector.clear();
+    int mixCount = 0;
+    for (int i = 0; i < sThreadCount; ++i)
+        mixCount += (int) mixVectors[i].size();
+    int partitions = 1;
+    if (mixCount >= kParallelMixMinimum && sThreadCount > 1) {
+        bool busUsed[MAXBUS * 2] = { false };
+        int busesUsed = 0;
+        for (int i = 0; i < sThreadCount && busesUsed < sThreadCount; ++i) {
+            std::vector<MixData> &vector = mixVectors[i];
+            for (std::vector<MixData>::iterator it = vector.begin(); it != vector.end(); ++it) {
+                if (!busUsed[it->destBus]) {
+                    busUsed[it->destBus] = true;
+                    ++busesUsed;
+                }
+            }
+        }
+        partitions = std::min(busesUsed, sThreadCount);
     }
+    if (partitions > 1) {
+        for (int p = 0; p < partitions; ++p)
+            taskManager->addTask<BusMixer, int, int, int, &BusMixer::mix>(&busMixer, p, partitions);
+        taskManager->waitForTasks();
+    }
+    else {
+        for (int i = 0; i < sThreadCount; ++i) {
+            std::vector<MixData> &vector = mixVectors[i];
+            std::for_each(vector.begin(), vector.end(), mixOperation);
+        }
+    }
+    for (int i = 0; i < sThreadCount; ++i)
+        mixVectors[i].clear();
 }
 
 #else
@@ -730,10 +793,7 @@ RTcmix::addToBus(BusType type, int bus, BufPtr src, int offset, int endfr, int c
 		dest = out_buffer[bus];
 	}
 	assert(dest != NULL);
-	for (int frame = offset; frame < endfr; frame++) {
-		dest[frame] += *src;
-		src += chans;
-	}
+	mixFrames(dest + offset, src, endfr - offset, chans);
 }
 
 #endif	// MULTI_THREAD
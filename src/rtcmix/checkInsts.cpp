@@ -23,19 +23,6 @@
 
 //#define DEBUG
 
-static InstCreatorFunction
-findInstCreator(rt_item *inList, const char *inInstName)
-{
-	rt_item *item = inList;       // rt_item defined in rt.h
-	while (item) {
-		if (strcmp(item->rt_name, inInstName) == 0) {
-			return item->rt_ptr;
-		}
-		item = item->rt_next;
-	}
-	return NULL;
-}
-
 // Load the argument list into a PFieldSet, hand to instrument, and call setup().  Does not destroy
 // the instrument on failure.
 
@@ -112,6 +99,18 @@ static int loadPFieldsAndSetup(const char *inName, Instrument *inInst, const Arg
 int
 RTcmix::checkInsts(const char *instname, const Arg arglist[],
 				   const int nargs, Arg *retval)
+{
+	InstCreatorFunction instCreator = findInstrument(instname);
+
+	if (instCreator)
+		return callInstrument(instCreator, instname, arglist, nargs, retval);
+
+   return FUNCTION_NOT_FOUND;
+}
+
+int
+RTcmix::callInstrument(InstCreatorFunction instCreator, const char *instname,
+					   const Arg arglist[], const int nargs, Arg *retval)
 {
 	Instrument *Iptr = NULL;;
 
@@ -121,61 +120,54 @@ RTcmix::checkInsts(const char *instname, const Arg arglist[],
 
 	*retval = 0.0;	// Default to float 0
 
-	InstCreatorFunction instCreator = findInstCreator(rt_list, instname);
+	printargs(instname, arglist, nargs);
 
-	if (instCreator) {
-		
-		printargs(instname, arglist, nargs);
-
-		if (!rtsetparams_was_called()) {
+	if (!rtsetparams_was_called()) {
 #ifdef EMBEDDED
-			die(instname, "You need to start the audio device before doing this.");
+		die(instname, "You need to start the audio device before doing this.");
 #else
-			die(instname, "You did not call rtsetparams!");
+		die(instname, "You did not call rtsetparams!");
 #endif
-            return CONFIGURATION_ERROR;
-		}
-		
-		/* Create the Instrument */
+        return CONFIGURATION_ERROR;
+	}
+	
+	/* Create the Instrument */
 
-		Iptr = (*instCreator)();
+	Iptr = (*instCreator)();
 
-		if (!Iptr) {
-			return SYSTEM_ERROR;
-		}
+	if (!Iptr) {
+		return SYSTEM_ERROR;
+	}
 
-		Iptr->ref();   // We do this to assure one reference
+	Iptr->ref();   // We do this to assure one reference
 
-		int rv = loadPFieldsAndSetup(instname, Iptr, arglist, nargs);
-		
-        if (rv == 0) { // only schedule if no setup() error
-			// For non-interactive case, configure() is delayed until just
-			// before instrument run time.
-			if (interactive()) {
-			   if ((rv = Iptr->configure(bufsamps())) != 0) {
-                   return rv;
-			   }
-			}
-		}
-		// Clean up if there was an error.
-		else {
-			Iptr->unref();
-			*retval = (Handle) NULL;
-			return rv;
+	int rv = loadPFieldsAndSetup(instname, Iptr, arglist, nargs);
+	
+    if (rv == 0) { // only schedule if no setup() error
+		// For non-interactive case, configure() is delayed until just
+		// before instrument run time.
+		if (interactive()) {
+		   if ((rv = Iptr->configure(bufsamps())) != 0) {
+               return rv;
+		   }
 		}
+	}
+	// Clean up if there was an error.
+	else {
+		Iptr->unref();
+		*retval = (Handle) NULL;
+		return rv;
+	}
 
-		/* schedule instrument */
-		Iptr->schedule(rtHeap);
+	/* schedule instrument */
+	Iptr->schedule(rtHeap);
 
-		// Create Handle for Iptr on return
-		*retval = createInstHandle(Iptr);
+	// Create Handle for Iptr on return
+	*retval = createInstHandle(Iptr);
 #ifdef DEBUG
-		 RTPrintf("EXITING checkInsts() FUNCTION -----\n");
+	RTPrintf("EXITING checkInsts() FUNCTION -----\n");
 #endif
-		 return rv;
-	}
-
-   return FUNCTION_NOT_FOUND;
+	return rv;
 }
 
 static Handle mkusage()
@@ -205,7 +197,7 @@ makeinstrument(const Arg arglist[], int nargs)
 	if (!instName)
 		return mkusage();
 	
-	InstCreatorFunction instCreator = findInstCreator(RTcmix::rt_list, instName);
+	InstCreatorFunction instCreator = RTcmix::findInstrument(instName);
 	
 	if (instCreator) {
         if (!rtsetparams_was_called()) {
@@ -12,28 +12,28 @@ int
 RTcmix::dispatch(const char *func_label, const Arg arglist[], 
 				 const int nargs, Arg *retval)
 {
-   /* Search non-rt and rt function lists for a match with <func_label>.
-      If there is a match of either, checkfunc or checkInsts will call
-      the appropriate function and return zero.  If both of these return
-      non-zero status, print an error message if the error indicates that
-	  no function was found.  Else just return proper status.
+   /* Search non-rt and rt function tables for a match with <func_label>.
+      If there is a match of either, callfunc or callInstrument will call
+      the appropriate function and return zero.  If neither is found, print
+      an error message.  Else just return proper status.
    */
-   int status = checkfunc(func_label, arglist, nargs, retval);
-
-   if (status == FUNCTION_NOT_FOUND) {    /* search rt functions */
-      status = checkInsts(func_label, arglist, nargs, retval);
-      switch (status) {
-          case FUNCTION_NOT_FOUND:		// Function not found
-              rtcmix_advise(NULL,
-				"Note: \"%s\" is an undefined function or instrument.",
-				func_label);
-              break;
-          case NO_ERROR:
-          default:
-              break;
-      }
+   DispatchHandle handle;
+   if (!resolve(func_label, &handle)) {
+      rtcmix_advise(NULL,
+		"Note: \"%s\" is an undefined function or instrument.",
+		func_label);
+      return FUNCTION_NOT_FOUND;
    }
-   return status;
+   return dispatch(func_label, handle, arglist, nargs, retval);
+}
+
+int
+RTcmix::dispatch(const char *func_label, const DispatchHandle &handle,
+				 const Arg arglist[], const int nargs, Arg *retval)
+{
+   if (handle.function != NULL)
+      return callfunc(handle.function, func_label, arglist, nargs, retval);
+   return callInstrument(handle.creator, func_label, arglist, nargs, retval);
 }
 
 #include <stdlib.h>
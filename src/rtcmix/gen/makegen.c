@@ -9,6 +9,7 @@
 #include <math.h>    /* for fabs */
 #include <assert.h>
 #include <maxdispargs.h>
+#include "../TableCache.h"
 
 extern double gen1(struct gen *gen, char *sfname);
 extern double gen2(struct gen *gen);
@@ -86,6 +87,16 @@ makegen(double p[], int n_args)
       return -1.0;
    }
 
+   /* An identical table made earlier can be shared, since none is freed. */
+   table = table_cache_find_gen(p, n_args, &gen.size, &retval);
+   if (table != NULL) {
+      if (!install_gen(genslot, gen.size, table)) {
+         die("makegen", "No more function tables available!");
+         return -1.0;
+      }
+      return retval;
+   }
+
    if (genno != 1) {    /* gen1 must allocate its own memory */
       table = (double *) malloc((size_t) gen.size * sizeof(double));
       if (table == NULL) {
@@ -165,6 +176,8 @@ makegen(double p[], int n_args)
          retval = (double) die("makegen", "There is no gen%d.", genno);
    }
 
+   table_cache_add_gen(p, n_args, gen.array, gen.size, retval);
+
    return retval;
 }
 
@@ -3,228 +3,213 @@
    the license to this software and for a DISCLAIMER OF ALL WARRANTIES.
 */
 #include "heap.h"
-#include <lock.h>
 #include <stdio.h>
-#include <Instrument.h>
 
 using namespace std;
 
-heapslot::heapslot() : chunkStart(0), inst(NULL), 
-					   left(NULL), right(NULL), parent(NULL)   
-{
-}
+static const long kInitialHeapSize = 1024;    // entries reserved up front
+static const int kNotesPerBlock = 256;        // inbox notes allocated at once
+static const long kArity = 4;                 // children per heap node
 
-heapslot::~heapslot()
+heap::heap() : inbox(NULL), freeNotes(NULL), spareNotes(NULL),
+               reservedEntries(kInitialHeapSize), pendingEntries(NULL), retiredEntries(NULL),
+               size(0), insertCount(0)
 {
-//	printf("heapslot::~heapslot()\n");
-	delete left;
-	delete right;
+  pthread_mutex_init(&spareLock, NULL);
+  entries.reserve(kInitialHeapSize);
 }
 
 heap::~heap()
 {
-    delete top;
+  for (size_t n = 0; n < noteBlocks.size(); ++n)
+    delete [] noteBlocks[n];
+  delete pendingEntries.load();
+  freeRetired(retiredEntries.load());
+  pthread_mutex_destroy(&spareLock);
 //	printf("heap::~heap()\n");
 }
 
+// Audio thread only.
+
 FRAMETYPE heap::getTop()
 {
-  Lock topLock(getLockHandle());	// This will unlock when it goes out of scope
-  return top ? top->chunkStart : 0;
+  drainInbox();
+  return entries.empty() ? 0 : entries[0].chunkStart;
 }
 
-void heap::insert(Instrument *newInst, FRAMETYPE cStart)
+// Producers share the spare list under a lock, but never contend with the
+// audio thread for it:  they refill it by taking every recycled note at once.
+// The note is counted here too, so that the heap can be grown to hold it
+// before it reaches the inbox.
+
+heap::Note *heap::allocNote()
+{
+  pthread_mutex_lock(&spareLock);
+  const long count = size.fetch_add(1, memory_order_release) + 1;
+  if (count > reservedEntries)
+    growEntries(count);
+  if (spareNotes == NULL)
+    spareNotes = freeNotes.exchange(NULL, memory_order_acquire);
+  if (spareNotes == NULL) {
+    Note *block = new Note[kNotesPerBlock];
+    noteBlocks.push_back(block);
+    for (int n = 0; n < kNotesPerBlock - 1; ++n)
+      block[n].next = &block[n + 1];
+    block[kNotesPerBlock - 1].next = NULL;
+    spareNotes = block;
+  }
+  Note *note = spareNotes;
+  spareNotes = note->next;
+  pthread_mutex_unlock(&spareLock);
+  return note;
+}
+
+// Hands the audio thread storage for twice <count> entries, which it adopts
+// the next time it drains the inbox.  Producers only, with spareLock held.
+// Storage the audio thread has given up is freed here.  It may retire more
+// while we do, so we take the whole list at once, as with freeNotes.
+
+void heap::growEntries(long count)
+{
+  freeRetired(retiredEntries.exchange(NULL, memory_order_acquire));
+  Storage *storage = new Storage;
+  storage->entries.reserve(count * 2);
+  storage->next = NULL;
+  reservedEntries = count * 2;
+  delete pendingEntries.exchange(storage, memory_order_acq_rel);
+}
+
+void heap::freeRetired(Storage *list)
 {
-  heapslot *newHeapElt;
-  heapslot *tempHeapElt;
-  Instrument *tempInst;
-  unsigned long tempChunkStart;
+  while (list != NULL) {
+    Storage *next = list->next;
+    delete list;
+    list = next;
+  }
+}
 
-  Lock insertLock(getLockHandle());	// This will unlock when it goes out of scope
+// May be called from any thread.
 
+void heap::insert(Instrument *newInst, FRAMETYPE cStart)
+{
+  Note *note = allocNote();
+  note->entry.chunkStart = cStart;
+  note->entry.order = insertCount.fetch_add(1, memory_order_relaxed);
+  note->entry.inst = newInst;
+
+  Note *head = inbox.load(memory_order_relaxed);
+  do {
+    note->next = head;
+  } while (!inbox.compare_exchange_weak(head, note, memory_order_release, memory_order_relaxed));
 //  printf("insert(in):  %lld\n", cStart);
+}
+
+// Move everything in the inbox into the heap and hand the notes back to the
+// producers.  Only the audio thread calls this, so it never blocks.
 
-  if (size == 0) {          // SC:  heap is empty ... need to allocate new memory
-//  printf("Heap empty ... initializing\n");
-    top = new heapslot;
-    leaves.head=NULL;
-    leaves.tail=NULL;
-    leaves.pushTail(top);
-    bot = top;
+void heap::drainInbox()
+{
+  Note *head = inbox.exchange(NULL, memory_order_acquire);
+  if (head == NULL)
+    return;
+  // Any storage a producer made for these notes was published before they
+  // were pushed.  Copying into it stays within its capacity.
+  Storage *storage = pendingEntries.exchange(NULL, memory_order_acquire);
+  if (storage != NULL) {
+    storage->entries.assign(entries.begin(), entries.end());
+    entries.swap(storage->entries);
+    storage->entries.clear();
+    Storage *retired = retiredEntries.load(memory_order_relaxed);
+    do {
+      storage->next = retired;
+    } while (!retiredEntries.compare_exchange_weak(retired, storage, memory_order_release, memory_order_relaxed));
+  }
+  Note *tail = head;
+  for (Note *note = head; note != NULL; note = note->next) {
+    entries.push_back(note->entry);
+    siftUp((long) entries.size() - 1);
+    tail = note;
   }
+  Note *recycled = freeNotes.load(memory_order_relaxed);
+  do {
+    tail->next = recycled;
+  } while (!freeNotes.compare_exchange_weak(recycled, head, memory_order_release, memory_order_relaxed));
+}
 
-  newHeapElt = leaves.pop();  // pop bottom most leaf to locate new insertion point
-
-  newHeapElt->left = new heapslot;    // create new slots and put into leaves queue
-  newHeapElt->left->parent = newHeapElt;
-  newHeapElt->right = new heapslot;
-  newHeapElt->right->parent = newHeapElt;
-  
-  leaves.pushTail(newHeapElt->right);
-  leaves.pushTail(newHeapElt->left);
-
-  newHeapElt->inst = newInst;
-  newHeapElt->chunkStart = cStart;
-
-  bot = newHeapElt;
-
-  tempHeapElt = newHeapElt;
-
-  // swap instruments based on chunkStart value until heap order is restored
-  while (tempHeapElt->parent && 
-	 (tempHeapElt->parent->chunkStart > tempHeapElt->chunkStart)) {
-    tempInst = tempHeapElt->parent->inst;
-    tempChunkStart = tempHeapElt->parent->chunkStart;
-    tempHeapElt->parent->inst = tempHeapElt->inst;
-    tempHeapElt->parent->chunkStart = tempHeapElt->chunkStart;
-    tempHeapElt->inst = tempInst;
-    tempHeapElt->chunkStart = tempChunkStart;
-    tempHeapElt = tempHeapElt->parent;
+void heap::siftUp(long index)
+{
+  const Entry entry = entries[index];
+  while (index > 0) {
+    const long parent = (index - 1) / kArity;
+    if (!precedes(entry, entries[parent]))
+      break;
+    entries[index] = entries[parent];
+    index = parent;
   }
-  size++;
-//  printf("insert(out): %lld\n", tempHeapElt->chunkStart);
-//  printf("heap::insert ... size = %d\n", size)";
+  entries[index] = entry;
+}
+
+void heap::siftDown(long index)
+{
+  const long count = (long) entries.size();
+  const Entry entry = entries[index];
+  for (;;) {
+    const long first = index * kArity + 1;
+    if (first >= count)
+      break;
+    const long last = (first + kArity < count) ? first + kArity : count;
+    long best = first;
+    for (long child = first + 1; child < last; ++child) {
+      if (precedes(entries[child], entries[best]))
+        best = child;
+    }
+    if (!precedes(entries[best], entry))
+      break;
+    entries[index] = entries[best];
+    index = best;
+  }
+  entries[index] = entry;
 }
 
 // Pull the top instrument if its start sample is < maxChunkStart
 // Returns start sample for the instrument as argument
 
-Instrument * 
+Instrument *
 heap::deleteMin(FRAMETYPE maxChunkStart, FRAMETYPE *pChunkStart)
 {
-  int sift;               // flag to tell loop when to stop sifting
-  Instrument* retInst;
-  Instrument* tempInst;
-  heapslot *dead;
-  heapslot *oldBot;
-  heapslot *tempHeapElt;
-  unsigned long tempChunkStart;
-  unsigned long retChunkStart;
-
-  Lock deleteLock(getLockHandle());	// This will unlock when it goes out of scope
-
-  sift = 1;
+  drainInbox();
 
-  if (size == 0) {  // trap to catch attempt to pop empty heap
-//    cerr << "heap is empty -- returning NULL\n";
+  if (entries.empty()) {  // trap to catch attempt to pop empty heap
 	*pChunkStart = 0;
     return NULL;
   }
 
   // If instrument start time is > max, return NULL.
-  if (top->chunkStart >= maxChunkStart) {
-      *pChunkStart = top->chunkStart;
+  if (entries[0].chunkStart >= maxChunkStart) {
+      *pChunkStart = entries[0].chunkStart;
 	  return NULL;
   }
-  
-  retInst = top->inst;    // return instrument is the top instrument
-  retChunkStart = top->chunkStart;
 
-  top->inst = bot->inst;  // replace top instrument with bottom instrument
-  top->chunkStart = bot->chunkStart;
+  Instrument *retInst = entries[0].inst;
+  *pChunkStart = entries[0].chunkStart;
 
-                          // for filtering down (later)
-  oldBot = bot;           // store old "bottom"
+  entries[0] = entries.back();  // replace top with bottom and filter it down
+  entries.pop_back();
+  if (!entries.empty())
+    siftDown(0);
 
-  bot->left = NULL;
-  bot->right = NULL;
-  bot->inst = NULL;
-  bot->chunkStart = 0;
-
-  if (size > 1) {             // SC: only want to pop one item if size == 1
-    dead = leaves.popTail();  // trim last (two) element(s) appended to leaves
-    delete dead;              // and free up memory
-  }
-  dead = leaves.popTail();    
-  delete dead;
-
-  bot = leaves.tail->heap->parent;  // reset bottom
-  
-  leaves.push(oldBot);        // push old bottom onto top of leaves
-
-  tempHeapElt = top;          // place new element onto top of heap
-
-  // filter top item down through heap until heap order is restored
-
-  while ((tempHeapElt->inst && 
-	(tempHeapElt->left->inst || tempHeapElt->right->inst) && sift)) {
-    if (!tempHeapElt->left->inst) {
-      if (tempHeapElt->right->chunkStart < tempHeapElt->chunkStart) {
-	tempInst = tempHeapElt->right->inst;
-	tempChunkStart = tempHeapElt->right->chunkStart;
-	tempHeapElt->right->inst = tempHeapElt->inst;
-	tempHeapElt->right->chunkStart = tempHeapElt->chunkStart;
-	tempHeapElt->inst = tempInst;
-	tempHeapElt->chunkStart = tempChunkStart;
-	tempHeapElt = tempHeapElt->right;
-      }
-      else
-	sift = 0;
-    }
-    else if (!tempHeapElt->right->inst) {
-      if (tempHeapElt->left->chunkStart < tempHeapElt->chunkStart) {
-	tempInst = tempHeapElt->left->inst;
-	tempChunkStart = tempHeapElt->left->chunkStart;
-	tempHeapElt->left->inst = tempHeapElt->inst;
-	tempHeapElt->left->chunkStart = tempHeapElt->chunkStart;
-	tempHeapElt->inst = tempInst;
-	tempHeapElt->chunkStart = tempChunkStart;
-	tempHeapElt = tempHeapElt->left;
-      }
-      else
-	sift = 0;
-    }
-    if (tempHeapElt->left->inst && tempHeapElt->right->inst) {
-      if(tempHeapElt->left->chunkStart < tempHeapElt->right->chunkStart) {
-	if (tempHeapElt->left->chunkStart < tempHeapElt->chunkStart) {
-	tempInst = tempHeapElt->left->inst;
-	tempChunkStart = tempHeapElt->left->chunkStart;
-	tempHeapElt->left->inst = tempHeapElt->inst;
-	tempHeapElt->left->chunkStart = tempHeapElt->chunkStart;
-	tempHeapElt->inst = tempInst;
-	tempHeapElt->chunkStart = tempChunkStart;
-	tempHeapElt = tempHeapElt->left;
-	}
-	else
-	  sift = 0;
-      }
-      else if(tempHeapElt->left->chunkStart >= tempHeapElt->right->chunkStart)
-	if (tempHeapElt->right->chunkStart < tempHeapElt->chunkStart) {
-	tempInst = tempHeapElt->right->inst;
-	tempChunkStart = tempHeapElt->right->chunkStart;
-	tempHeapElt->right->inst = tempHeapElt->inst;
-	tempHeapElt->right->chunkStart = tempHeapElt->chunkStart;
-	tempHeapElt->inst = tempInst;
-	tempHeapElt->chunkStart = tempChunkStart;
-	tempHeapElt = tempHeapElt->right;
-	}
-	else
-	  sift = 0;
-    }
-  }
-//  printf("deleteMin(): %lld\n", retChunkStart);
-  size--;
-  *pChunkStart = retChunkStart;
+  size.fetch_sub(1, memory_order_release);
+//  printf("deleteMin(): %lld\n", *pChunkStart);
   return retInst;
 }
 
-void heapslot::dump(int indent)
-{
-  int i;
+// Audio thread only.
 
-  if (this->inst == NULL)
-    return;
-  
-  if (left->inst)
-    left->dump(indent+1);
-
-  for (i=0; i<indent; i++)
-    printf("    ");
-  printf("%lld\n", chunkStart);
-  
-  if (right->inst)
-    right->dump(indent+1);
-  return;
+void heap::dump()
+{
+  for (size_t n = 0; n < entries.size(); ++n) {
+    for (size_t i = n; i > 0; i = (i - 1) / kArity)
+      printf("    ");
+    printf("%lld\n", entries[n].chunkStart);
+  }
 }
-
-
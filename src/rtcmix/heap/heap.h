@@ -2,69 +2,67 @@
 #define _HEAP_H_ 1
 
 #include <rt_types.h>
-#include <Lockable.h>
+#include <pthread.h>
+#include <atomic>
 #include <vector>
 
 class Instrument;
 
-// class for heap element structure
-
-class heapslot {
-public:
-  FRAMETYPE chunkStart; // start samp for chunk
-  Instrument *inst;
-  heapslot *left, *right, *parent;
-
-  heapslot();
-  ~heapslot();
-  void dump(int);
-};
-
-// class for queue used to hold heap end
-
-class qElt {
-public:
-  qElt(heapslot *hs) : next(NULL), prev(NULL), heap(hs) {}
-  friend class rtqueue;
-  friend class heap;
-  qElt *next;
-  qElt *prev;
-  heapslot *heap;
-};
-
-// class for main queue structure
-
-class rtqueue {
-private:
-  friend class heap;
-  qElt *head;
-  qElt *tail;
-public:
-  rtqueue() : head(NULL), tail(NULL) {}
-  ~rtqueue();
-  void pushTail(heapslot*);
-  void push(heapslot*);
-  heapslot *pop();
-  heapslot *popTail();
-  void print();
-};
-
 // class for main heap structure
+//
+// Instruments may be inserted from any thread (parser, socket, OSC, embedded
+// host).  They land in a lock-free inbox which the audio thread drains into
+// a contiguous 4-ary min-heap the next time it calls deleteMin().  Notes with
+// equal start times come out in the order they were inserted.  The heap's
+// storage is grown by the producers, before the note that needs it is in the
+// inbox, so the audio thread never allocates.
 
-class heap : public Lockable {
-private:
-  rtqueue leaves;  // queue used to hold next insertion point
+class heap {
 public:
-  heapslot* bot;
-  heapslot* top;
-  heap() : bot(NULL), top(NULL), size(0) {}
+  heap();
   ~heap();
   FRAMETYPE getTop();
-  long getSize() const { return size; }
+  // Number of instruments in the heap plus those still in the inbox.
+  long getSize() const { return size.load(std::memory_order_acquire); }
   void insert(Instrument*, FRAMETYPE chunkStart);
   Instrument *deleteMin(FRAMETYPE maxChunkStart, FRAMETYPE *pChunkStart);
-  void dump(heapslot*,int);
-  long size;
+  void dump();
+private:
+  struct Entry {
+    FRAMETYPE chunkStart;   // start samp for chunk
+    unsigned long long order;
+    Instrument *inst;
+  };
+  struct Note {
+    Entry entry;
+    Note *next;
+  };
+  struct Storage {
+    std::vector<Entry> entries;
+    Storage *next;                          // in the retired list
+  };
+  static bool precedes(const Entry &a, const Entry &b) {
+    return a.chunkStart < b.chunkStart
+           || (a.chunkStart == b.chunkStart && a.order < b.order);
+  }
+  void drainInbox();
+  void siftUp(long);
+  void siftDown(long);
+  Note *allocNote();
+  void growEntries(long count);
+  static void freeRetired(Storage *list);
+
+  std::vector<Entry> entries;               // the heap proper; audio thread only
+  std::atomic<Note *> inbox;                // pushed by producers, taken whole by the audio thread
+  std::atomic<Note *> freeNotes;            // drained notes handed back to producers
+  Note *spareNotes;                         // guarded by spareLock
+  pthread_mutex_t spareLock;                // taken by producers only
+  std::vector<Note *> noteBlocks;
+  long reservedEntries;                     // capacity promised to the audio thread; guarded by spareLock
+  std::atomic<Storage *> pendingEntries;    // larger storage for the audio thread to adopt
+  std::atomic<Storage *> retiredEntries;    // list of storage it gave up, freed by a producer
+  std::atomic<long> size;
+  std::atomic<unsigned long long> insertCount;
 };
 
 // class for queue used to hold Instruments
@@ -90,4 +88,3 @@ public:
 };
 
 #endif /* _HEAP_H_ */
-
@@ -19,11 +19,14 @@
 #include <bus.h>
 #include "BusSlot.h"
 #include "dbug.h"
+#include <Reclaimer.h>
+#include <WorkerThread.h>
 #include <ugens.h>
 
 #ifdef MULTI_THREAD
 #include "TaskManager.h"
 #include <vector>
+#include <algorithm>
 #endif
 
 #ifdef EMBEDDED
@@ -48,6 +51,45 @@ using namespace std;
 static FRAMETYPE bufEndSamp;
 static int startupBufCount = 0;
 static bool audioDone = true;   // set to false in runMainLoop
+#ifdef MULTI_THREAD
+// One instrument playing onto one bus during the current buffer.
+struct BusRun {
+	Instrument	*inst;
+	BusType		busType;
+	short		bus;
+	short		busq;
+	IBusClass	queueClass;		// class of the rtQueue it was popped from
+};
+
+static bool busRunPrecedes(const BusRun &inA, const BusRun &inB)
+{
+	if (inA.inst != inB.inst)
+		return inA.inst < inB.inst;
+	return inA.busq < inB.busq;
+}
+
+// Task target which plays one instrument onto each of its buses in turn.
+class BusRunner {
+public:
+	int exec(BusRun *inRuns, int inCount) {
+		for (int n = 0; n < inCount; ++n)
+			inRuns[n].inst->exec(inRuns[n].busType, inRuns[n].bus);
+		return 0;
+	}
+};
+
+static BusRunner sBusRunner;
+// Reused every buffer so that dispatching instruments does not allocate.
+static vector<Instrument *> sRunInstruments;
+static vector<vector<BusRun> > sWaves;
+static vector<int> sVisitedQueues;
+static long sTaskAllocationCount = 0;
+static long sAllocatingBufferCount = 0;
+#endif
+
+// For reporting the speed of offline (file-only) renders.
+static double sRenderStartTime = 0.0;
+static FRAMETYPE sRenderStartFrame = 0;
 
 int RTcmix::runMainLoop()
 {
@@ -134,6 +176,8 @@ int RTcmix::runMainLoop()
 			run_status = RT_GOOD;
 		}
 #endif
+		sRenderStartTime = monotonicTime();
+		sRenderStartFrame = bufStartSamp;
 		if (startAudio(inTraverse, doneTraverse, this) != 0) {
 			audioDone = true;
             rtcmix_debug(NULL, "runMainLoop():  exiting with -1");
@@ -325,8 +369,12 @@ bool RTcmix::inTraverse(AudioDevice *device, void *arg)
 	int rtQSize = 0, allQSize = 0;
     FRAMETYPE rtQchunkStart = 0;
 #ifdef MULTI_THREAD
-	vector<Instrument *>instruments;
-	instruments.reserve(busCount);
+	vector<Instrument *> &instruments = sRunInstruments;
+	vector<vector<BusRun> > &waves = sWaves;
+	vector<int> &queues = sVisitedQueues;
+	int waveCount = 0;
+	if (queues.capacity() < (size_t) busCount * 3)
+		queues.reserve(busCount * 3);
 #endif
 	bool instrumentFound = false;
 	// rtQueue[] playback shuffling ++++++++++++++++++++++++++++++++++++++++
@@ -408,19 +456,19 @@ bool RTcmix::inTraverse(AudioDevice *device, void *arg)
 #endif
         
 #ifdef MULTI_THREAD
-		if (bus != -1) {
-#if defined(BBUG) || defined(DBUG)
-			printf("\nAdding instruments for current slice [end = %.3f ms] and bus [%d]\n",
-				   1000 * bufEndSamp/sr(), busq);
-#endif
-		}
-		else {
+		if (bus == -1) {
 #if defined(BBUG) || defined(DBUG)
 			printf("\nDone with bus type %d -- continuing\n", bus_type);
 #endif
 			continue;
 		}
-		// Play elements on queue (insert back in if needed) ++++++++++++++++++
+#if defined(BBUG) || defined(DBUG)
+		printf("\nCollecting instruments for current slice [end = %.3f ms] and bus [%d]\n",
+			   1000 * bufEndSamp/sr(), busq);
+#endif
+		queues.push_back(busq);
+		// Pop every ready instrument off this queue into the wave for its aux
+		// inputs.  Nothing runs until all queues have been collected.
 		while (rtQSize > 0 && rtQchunkStart < bufEndSamp) {
 			int chunksamps = 0;
 			instrumentFound = true;
@@ -475,53 +523,87 @@ bool RTcmix::inTraverse(AudioDevice *device, void *arg)
 						
 			// DT_PANIC_MOD
 			if (!panic) {
+				// An instrument can run as soon as every aux bus it reads from
+				// is complete, i.e. one wave past the deepest of those buses.
+				iBus = Iptr->getBusSlot();
+				int wave = 0;
+				::pthread_mutex_lock(&bus_slot_lock);
+				for (i = 0; i < iBus->auxin_count; i++) {
+					const int auxin = iBus->auxin[i];
+					if (auxin >= 0 && auxin < busCount && BusConfigs[auxin].Depth >= wave)
+						wave = BusConfigs[auxin].Depth + 1;
+				}
+				::pthread_mutex_unlock(&bus_slot_lock);
+				if (wave >= (int) waves.size())
+					waves.resize(wave + 1);
+				if (wave >= waveCount)
+					waveCount = wave + 1;
 #ifdef IBUG
-                printf("putting inst %p into taskmgr (bus_type %d, bus %d) [%s]\n", Iptr, bus_type, bus, Iptr->name());
+                printf("putting inst %p into wave %d (bus_type %d, bus %d) [%s]\n", Iptr, wave, bus_type, bus, Iptr->name());
 #endif
-				instruments.push_back(Iptr);
-				taskManager->addTask<Instrument, int, BusType, int, &Instrument::exec>(Iptr, bus_type, bus);
+				BusRun run = { Iptr, bus_type, (short) bus, (short) busq, qStatus };
+				waves[wave].push_back(run);
 			}
             else { // DT_PANIC_MOD ... just keep on incrementing endsamp
 				endsamp += chunksamps;
             }
 			rtQSize = rtQueue[busq].getSize();
+			if (rtQSize > 0)
+				rtQchunkStart = rtQueue[busq].nextChunk();
 		}	// while (rtQSize > 0 && rtQchunkStart < bufEndSamp)
+	}  // end while (!aux_pb_done) --------------------------------------------------
 
-		if (!instruments.empty()) {
+	// Run the waves in order.  Every instrument in a wave writes only to buses
+	// that no other instrument in the same wave reads, so each wave needs just
+	// one barrier and one mix, no matter how many buses it covers.
+	for (int wave = 0; wave < waveCount; ++wave) {
+		vector<BusRun> &runs = waves[wave];
+		if (runs.empty())
+			continue;
+		// Keep each instrument's buses together so that a single task runs them
+		// in turn; Instrument::exec() must not be entered concurrently.
+		std::sort(runs.begin(), runs.end(), busRunPrecedes);
+		const int runCount = (int) runs.size();
+		for (int first = 0; first < runCount;) {
+			int last = first + 1;
+			while (last < runCount && runs[last].inst == runs[first].inst)
+				++last;
+			instruments.push_back(runs[first].inst);
+			taskManager->addTask<BusRunner, int, BusRun *, int, &BusRunner::exec>(&sBusRunner, &runs[first], last - first);
+			first = last;
+		}
 #if defined(DBUG) || defined(IBUG)
-			printf("Done adding instruments for current slice. Waiting for %d instrument tasks...\n", (int) instruments.size());
+		printf("Done adding wave %d. Waiting for %d instrument tasks...\n", wave, (int) instruments.size());
 #endif
-			taskManager->waitForTasks(instruments);
+		taskManager->waitForTasks(instruments);
 #if defined(DBUG) || defined(IBUG)
-            printf("Done waiting... mixing all signals\n");
+		printf("Done waiting... mixing all signals\n");
 #endif
-        	RTcmix::mixToBus();
+		RTcmix::mixToBus();
 #if defined(IBUG)
-			printf("Re-queuing instruments\n");
+		printf("Re-queuing instruments\n");
 #endif
-		}
-        // Iterate instrument list, either pushing elements back onto rtQueues
-        // or destroying them.  rtQueue is unsorted until all pushes are complete.
-		for (vector<Instrument *>::iterator it = instruments.begin(); it != instruments.end(); ++it) {
-			Iptr = *it;
+        // Iterate the runs, either pushing instruments back onto their rtQueues
+        // or destroying them.  rtQueues are unsorted until all pushes are complete.
+		for (int first = 0; first < runCount;) {
+			Iptr = runs[first].inst;
 			int chunksamps = Iptr->framesToRun();
 			FRAMETYPE endsamp = Iptr->getendsamp();
-			int inst_chunk_finished = Iptr->needsToRun();
-
-			rtQchunkStart = Iptr->get_ichunkstart();    // We stored this value before placing into the vector
-            
+			rtQchunkStart = Iptr->get_ichunkstart();    // We stored this value before placing into the wave
+			int last = first;
 			// ReQueue or unref ++++++++++++++++++++++++++++++++++++++++++++++
-			if (endsamp > bufEndSamp && !panic) {
+			for (; last < runCount && runs[last].inst == Iptr; ++last) {
+				if (endsamp > bufEndSamp && !panic) {
 #ifdef IBUG
-                printf("re-queueing inst %p on rtQueue[%d] because its endsamp %lld > bufEndSamp %lld\n", Iptr, busq, endsamp, bufEndSamp);
+					printf("re-queueing inst %p on rtQueue[%d] because its endsamp %lld > bufEndSamp %lld\n", Iptr, runs[last].busq, endsamp, bufEndSamp);
 #endif
-				rtQueue[busq].pushUnsorted(Iptr,rtQchunkStart+chunksamps);   // put back onto queue
+					rtQueue[runs[last].busq].pushUnsorted(Iptr,rtQchunkStart+chunksamps);   // put back onto queue
+				}
 			}
-			else {
+			// All of this instrument's buses have played, so unref it just once.
+			if (endsamp <= bufEndSamp || panic) {
 				iBus = Iptr->getBusSlot();
-				// unref only after all buses have played -- i.e., if inst_chunk_finished.
-				// if not unref'd here, it means the inst still needs to run on another bus.
-				if (qStatus == iBus->Class() && inst_chunk_finished) {
+				if (runs[first].queueClass == iBus->Class() && Iptr->needsToRun()) {
 #ifdef IBUG
                     printf("unref'ing inst %p\n", Iptr);
 #endif
@@ -529,21 +611,23 @@ bool RTcmix::inTraverse(AudioDevice *device, void *arg)
 					Iptr = NULL;
 				}
 			}  // end rtQueue or unref ----------------------------------------
-			
-			rtQSize = rtQueue[busq].getSize();
-			if (rtQSize) {
-				allQSize += rtQSize;
-			}
-#ifdef DBUG
-            printf("rtQSize: %ld\n", (long)rtQSize);
-            printf("rtQchunkStart:  %ld\n", (long)rtQchunkStart);
-            printf("chunksamps:  %ld\n", (long)chunksamps);
-            printf("Iteration done==========\n\n");
-#endif
-		} // end while() [Play elements on queue (insert back in if needed)] -----------
-        rtQueue[busq].sort();
+			first = last;
+		}
+		runs.clear();
 		instruments.clear();
-	}  // end while (!aux_pb_done) --------------------------------------------------
+	}
+	for (vector<int>::iterator it = queues.begin(); it != queues.end(); ++it) {
+		rtQueue[*it].sort();
+		allQSize += rtQueue[*it].getSize();
+	}
+	queues.clear();
+
+	// Keep track of how many buffers caused the task pool to grow.  Once the
+	// pool has reached the score's peak density this should stop increasing.
+	if (taskManager->getAllocationCount() != sTaskAllocationCount) {
+		sTaskAllocationCount = taskManager->getAllocationCount();
+		++sAllocatingBufferCount;
+	}
 
 #else   // MULTI_THREAD
     // Play elements on queue (insert back in if needed) ++++++++++++++++++
@@ -761,10 +845,23 @@ bool RTcmix::doneTraverse(AudioDevice *device, void *arg)
 	RTPrintf("ENTERING doneTraverse()\n");
 #endif
     callStopCallbacks();
+#ifdef MULTI_THREAD
+	rtcmix_debug(NULL, "doneTraverse: task dispatch allocated %ld times, during %ld of %lld buffers",
+				 sTaskAllocationCount, sAllocatingBufferCount, (long long)(bufEndSamp / bufsamps()));
+	sTaskAllocationCount = sAllocatingBufferCount = 0;
+#endif
+	Reclaimer::reportStats("doneTraverse");
 #ifndef EMBEDDED
 	if (RTOption::print())
 		RTPrintf("\nclosing...\n");
 	RTPrintf("Output duration: %.2f seconds\n", bufEndSamp / sr());
+	if (rtfileit == 1 && !RTOption::play() && !RTOption::record()) {
+		// Offline render:  nothing paces us but the CPU and the disk.
+		const double renderTime = monotonicTime() - sRenderStartTime;
+		const double rendered = (bufEndSamp - sRenderStartFrame) / sr();
+		if (renderTime > 0.0)
+			RTPrintf("Render time: %.2f seconds (%.1f x realtime)\n", renderTime, rendered / renderTime);
+	}
 	rtreportstats(device);
 	if (RTOption::print())
 		RTPrintf("\n");
@@ -309,6 +309,23 @@ int RTcmix_setparams(float sr, int nchans, int vecsize, int recording, int bus_c
 	return status;
 }
 
+int RTcmix_setThreadCount(int count)
+{
+#ifdef MULTI_THREAD
+	if (count < 0)
+		return die("RTcmix_setThreadCount", "Thread count must be >= 0");
+	if (RTcmix::rtsetparams_was_called()) {
+		rtcmix_warn("RTcmix_setThreadCount", "Thread count must be set before RTcmix_setparams()");
+		return -1;
+	}
+	RTOption::threadCount(count);
+	return 0;
+#else
+	rtcmix_warn("RTcmix_setThreadCount", "This version of RTcmix was built without multi-thread support");
+	return -1;
+#endif
+}
+
 #ifdef EMBEDDEDAUDIO
 
 int RTcmix_setAudioBufferFormat(RTcmix_AudioFormat format, int nchans)
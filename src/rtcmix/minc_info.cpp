@@ -4,7 +4,7 @@
 #include <sndlibsupport.h>
 #include <sfheader.h>
 #include "rtdefs.h"
-#include "InputFile.h"
+#include "InputFileTable.h"
 #include "handle.h"
 #include <stdio.h>
 #include <sys/file.h>
@@ -9,6 +9,7 @@
 #include "tableutils.h"
 #include <PField.h>
 #include "handle.h"
+#include "TableCache.h"
 #include <ugens.h>		// for warn, die
 
 // Functions for modifying table PFields.   -JGG, 4/8/05
@@ -38,6 +39,20 @@ static PField *_get_pfield(const Arg& arg)
 	return pf;
 }
 
+// Return a new table holding the values of <table>, read the same way.
+
+static PField *_copy_table(PField *table)
+{
+	const int len = table->values();
+	double *array = new double[len];
+	table->copyValues(array);
+	TablePField *copy = new TablePField(array, len);
+	TablePField *tablepf = dynamic_cast<TablePField *>(table);
+	if (tablepf != NULL)
+		copy->setInterpFunction(tablepf->interpFunction());
+	return copy;
+}
+
 static PField *_modtable_usage(const char *msg)
 {
 	die(NULL, "Usage: %s", msg);
@@ -117,6 +132,12 @@ _draw_table(PField *intable, const Arg args[], const int nargs)
 	PField *valuepf = _get_pfield(args[argoffset + 1]);
 	PField *widthpf = (nargs > argoffset + 2) ? _get_pfield(args[argoffset + 2])
 	                                          : new ConstPField(0);
+	// Drawing rewrites the table's array in place.  A table from the cache
+	// may also have been handed to other maketable() calls, and a modified
+	// table may wrap one, so we draw on a copy of those.
+	if (TableCache::holds(intable)
+			|| (TableCache::enabled() && dynamic_cast<TablePField *>(intable) == NULL))
+		intable = _copy_table(intable);
 	return new DrawTablePField(intable, literalIndex, indexpf, valuepf, widthpf);
 }
 
@@ -11,10 +11,9 @@ struct rt_item {
 	const char *rt_name;
 };
 
-extern rt_item *rt_list;
-
 void heapify(Instrument *Iptr);
 int addrtInst(rt_item*);
+InstCreatorFunction findrtInst(const char *);
 
 extern "C" {
     void merror(const char*);
@@ -32,4 +31,11 @@ extern "C" {
 		  merror(flabel); \
 	}
 
+// For an instrument built into more than one DSO.  The first DSO loaded
+// registers it, and later ones leave that one in place.
+#define RT_INTRO_SHARED(flabel, func) \
+	{ if (findrtInst(flabel) == NULL) \
+		RT_INTRO(flabel, func) \
+	}
+
 #endif	// __RT_H__
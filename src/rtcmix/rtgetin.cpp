@@ -15,7 +15,8 @@
 #include "byte_routines.h"
 #include <Instrument.h>
 #include "BusSlot.h"
-#include "InputFile.h"
+#include "InputFileTable.h"
+#include "InputResampler.h"
 #include <ugens.h>
 #include <rtdefs.h>
 #include <assert.h>
@@ -50,6 +51,13 @@ Instrument::rtinrepos(Instrument *inst, int frames, int whence)
 	  return -1;
    }
 
+   // A converted file moves by frames at our rate, not the file's.
+   InputResampler *resampler = inst->_input.resampler;
+   if (resampler != NULL && (whence == SEEK_SET || whence == SEEK_CUR)) {
+      inst->_input.fileOffset = resampler->seek(inst->_input.fileOffset, frames, whence);
+      return 0;
+   }
+
    offset = RTcmix::seekInputFile(fdindex, frames, inst->_input.inputchans, whence);
 
    switch (whence) {
@@ -168,7 +176,8 @@ RTcmix::readFromInputFile(
       const short src_chan_list[],  /* list of in-bus chan numbers from inst */
       short       src_chans,        /* number of in-bus chans to copy */
       int		  fdIndex,			/* index into input file desc. array */
-	  off_t		  *pFileOffset)		/* ptr to inst's file offset (updated) */
+	  off_t		  *pFileOffset,		/* ptr to inst's file offset (updated) */
+	  InputResampler *resampler)	/* inst's rate converter, or NULL */
 {
     /* File opened by earlier call to rtinput. */
     InputFile &inputFile = inputFileTable[fdIndex];
@@ -178,7 +187,8 @@ RTcmix::readFromInputFile(
                                            dest_chans,
                                            dest_frames,
                                            src_chan_list,
-                                           src_chans);
+                                           src_chans,
+                                           resampler);
 
    /* Advance saved offset by the number of bytes read.
       Note that this includes samples in channels that were read but
@@ -270,7 +280,7 @@ int	Instrument::rtgetin(float *inarr, int nsamps)
 		assert(in_count > 0);
 		
 		RTcmix::readFromInputFile(inarr, inchans, frames, in, in_count,
-								  fdindex, &_input.fileOffset);
+								  fdindex, &_input.fileOffset, _input.resampler);
 	}
 	
 	return nsamps;   // this seems pointless, but no insts pay attention anyway
@@ -20,7 +20,7 @@
 #include <rtdefs.h>
 #include <RTOption.h>
 #include "audio_devices.h"
-#include "InputFile.h"
+#include "InputFileTable.h"
 #ifdef LINUX
    #include <fcntl.h>
 #endif /* LINUX */
@@ -145,30 +145,23 @@ int RTcmix::setInputBuffer(const char *inName, float *inBuffer, int inFrames, in
 			}
 		}
 		else {
-			int i;
-			for (i = 0; i < max_input_fds; i++) {
-				if (!inputFileTable[i].isOpen()) {
-					if (inputFileTable[i].init(inBuffer,
-										   inName,
-										   inFrames,
-										   44100.0f,	// DAS Allow SR to VARY
-										   inChans,
-                                           inGainScaling) == 0) {
-                        last_input_index = i;
-                        break;
-                   }
-                    else {
-                        return -1;
-                    }
-				}
-			}
-			
-			/* If this is true, we've used up all input descriptors in our array. */
-			if (i == max_input_fds) {
+			const int i = inputFileTable.allocate();
+			/* If this is true, we've used up all input descriptors in our table. */
+			if (i < 0) {
 				die("setInputBuffer", "You have exceeded the maximum number of input "
 					"files and buffers (%ld)!", max_input_fds);
 				return -1;
 			}
+			if (inputFileTable[i].init(inBuffer,
+									   inName,
+									   inFrames,
+									   44100.0f,	// DAS Allow SR to VARY
+									   inChans,
+									   inGainScaling) != 0) {
+				return -1;
+			}
+			inputFileTable.add(i, inName);
+			last_input_index = i;
 		}
 	}
 	else {
@@ -181,23 +174,19 @@ int RTcmix::setInputBuffer(const char *inName, float *inBuffer, int inFrames, in
 InputFile *
 RTcmix::findInput(const char *inName, int *pOutIndex)
 {
-	for (int i = 0; i < max_input_fds; i++) {
-		if (inputFileTable[i].isOpen()) {
-			if (inputFileTable[i].hasFile(inName)) {
-				if (pOutIndex != NULL)
-					*pOutIndex = i;
-				rtcmix_advise("rtinput",  "Using pre-loaded internal buffer %d: '%s'", i, inName);
-				return &inputFileTable[i];
-			}
-		}
-	}
-	return NULL;
+	const int i = inputFileTable.find(inName);
+	if (i < 0)
+		return NULL;
+	if (pOutIndex != NULL)
+		*pOutIndex = i;
+	rtcmix_advise("rtinput",  "Using pre-loaded internal buffer %d: '%s'", i, inName);
+	return &inputFileTable[i];
 }
 
 double
 RTcmix::rtinput(double p[], int n_args)
 {
-	int            audio_in = 0, in_memory = 0, p1_is_used = 0, fd;
+	int            audio_in = 0, in_memory = 0, in_mapped = 0, p1_is_used = 0, fd;
 	int            is_open = 0, header_type, data_format, data_location = 0, nchans;
 	bool		   set_record = false, in_buffer = false;
     int            status = 0;
@@ -272,6 +261,9 @@ RTcmix::rtinput(double p[], int n_args)
 			if (strcasestr(str, "mem") != NULL) {
 				in_memory = 1;
 			}
+			else if (strcasestr(str, "map") != NULL) {
+				in_mapped = 1;
+			}
 		}
 	}
 
@@ -430,13 +422,19 @@ RTcmix::rtinput(double p[], int n_args)
 			rtcmix_advise(NULL, "  duration:  %g", dur);
 			if (in_memory)
 				rtcmix_advise(NULL, "Loading file into memory");
+			else if (in_mapped)
+				rtcmix_advise(NULL, "Mapping file into memory");
 
 #ifdef INPUT_BUS_SUPPORT
 #endif /* INPUT_BUS_SUPPORT */
 
 			if (dsrate != sr()) {
-				rtcmix_warn("rtinput", "The input file sampling rate is %g, but "
-							"the output rate is currently %g.", dsrate, sr());
+				if (RTOption::inputResample() > 0)
+					rtcmix_advise("rtinput", "Converting the input file from %g "
+								  "to %g as it is read.", dsrate, sr());
+				else
+					rtcmix_warn("rtinput", "The input file sampling rate is %g, but "
+								"the output rate is currently %g.", dsrate, sr());
 			}
             srate = dsrate;
 		}
@@ -448,36 +446,31 @@ RTcmix::rtinput(double p[], int n_args)
 			last_input_index is the value that will be used by any instrument
 			created after this call to rtinput().
 		*/
-		for (i = 0; i < max_input_fds; i++) {
-			if (!inputFileTable[i].isOpen()) {
-                if ((status = inputFileTable[i].init(fd,
-									   sfname,
-									   audio_in ? InputFile::AudioDeviceType : in_memory ? InputFile::InMemoryType : InputFile::FileType,
-									   header_type,
-									   data_format,
-									   data_location,
-									   nsamps/nchans,	// passing this in as frames now, not samps
-									   srate,
-									   nchans,
-                                           dur)) == 0) {
-                    last_input_index = i;
-                    break;
-                }
-                else {
-                    last_input_index = -1;
-                    goto Error;
-                }
-			}
-		}
+		i = inputFileTable.allocate();
 
-		/* If this is true, we've used up all input descriptors in our array. */
-        if (i == max_input_fds) {
+		/* If this is true, we've used up all input descriptors in our table. */
+        if (i < 0) {
 			rterror("rtinput", "You have exceeded the maximum number of input "
                     "files (%ld)!", max_input_fds);
             last_input_index = -1;
             status = RESOURCE_ERROR;
             goto Error;
         }
+        if ((status = inputFileTable[i].init(fd,
+							   sfname,
+							   audio_in ? InputFile::AudioDeviceType : in_memory ? InputFile::InMemoryType : in_mapped ? InputFile::MappedType : InputFile::FileType,
+							   header_type,
+							   data_format,
+							   data_location,
+							   nsamps/nchans,	// passing this in as frames now, not samps
+							   srate,
+							   nchans,
+							   dur)) != 0) {
+            last_input_index = -1;
+            goto Error;
+        }
+        inputFileTable.add(i, sfname);
+        last_input_index = i;
 	}
 	
 Error:
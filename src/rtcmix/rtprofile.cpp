@@ -42,6 +42,7 @@ rtprofile()
 #ifndef USE_MMOVE
 	RT_INTRO("MOVE", makeMOVE);
 	RT_INTRO("PLACE", makePLACE);
+	RT_INTRO("ROOMRVB", makeROOMRVB);
 #else
 	RT_INTRO("DMOVE", makeDMOVE);
 	RT_INTRO("MMOVE", makeMMOVE);
@@ -14,7 +14,9 @@
 #include <sndlibsupport.h>
 #include "Instrument.h"
 #include "rtdefs.h"
-#include "InputFile.h"
+#include "InputFileTable.h"
+#include "InputResampler.h"
+#include <RTOption.h>
 
 
 #define INCHANS_DISCREPANCY_WARNING "\
@@ -132,6 +134,20 @@ RTcmix::attachInput(float start_time, InputState *input)
 		 input->inputNsamps = (int) (0.5 + inputFileTable[index].duration() * input->inputsr) - inskip_frames;
          if (start_time >= inputFileTable[index].duration())
 		    status = RT_INPUT_EOF;	// not fatal -- just produces warning
+
+         /* Files at another rate are converted to ours as they are read,
+            unless the user turned that off.  Buffers handed to us by an
+            application are already at our rate, whatever they claim.
+         */
+         delete input->resampler;
+         input->resampler = NULL;
+         if (input->inputsr != sr() && RTOption::inputResample() > 0
+                                    && inputFileTable[index].getFD() != USE_MM_BUF) {
+            input->resampler = new InputResampler(&inputFileTable[index], sr(),
+                                                  RTOption::inputResample());
+            input->inputNsamps = (int) (0.5 + (inputFileTable[index].duration()
+                                                - start_time) * sr());
+         }
       }
 
    /* Increment the reference count for this file. */
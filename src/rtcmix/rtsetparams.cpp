@@ -107,7 +107,7 @@ RTcmix::setparams(float sr, int nchans, int bufsamps, bool recording, int bus_co
 	}
 	
 #ifdef MULTI_THREAD
-	InputFile::createConversionBuffers(RTcmix::bufsamps());
+	InputFile::createConversionBuffers(RTcmix::bufsamps(), threadCount());
 #endif
 
 #ifdef EMBEDDED
@@ -176,7 +176,7 @@ int RTcmix::resetparams(float sr, int chans, int bufsamps, bool recording)
 		}
 	}
 #ifdef MULTI_THREAD
-	InputFile::createConversionBuffers(RTcmix::bufsamps());
+	InputFile::createConversionBuffers(RTcmix::bufsamps(), threadCount());
 #endif
 
 	/* inTraverse waits for this. Set it even if play_audio is false! */
@@ -38,6 +38,10 @@ enum ParamType {
     PRINT_SUPPRESS_UNDERBAR,
     BAIL_ON_UNDEFINED_FUNCTION,
     SEND_MIDI_RECORD_AUTOSTART,
+	THREAD_AFFINITY,
+	OUTPUT_WRITE_DROP,
+	TABLE_FLOAT,
+	DITHER,
 	BUFFER_FRAMES,
 	BUFFER_COUNT,
 	OSC_INPORT,
@@ -45,6 +49,13 @@ enum ParamType {
     PRINT_LIST_LIMIT,
     PARSER_WARNINGS,
     MUTE_THRESHOLD,
+	THREAD_COUNT,
+	THREAD_PRIORITY,
+	INPUT_READ_AHEAD,
+	OUTPUT_WRITE_QUEUE,
+	TABLE_CACHE,
+	INPUT_RESAMPLE,
+	SILENCE_BLOCKS,
 	DEVICE,
 	INDEVICE,
 	OUTDEVICE,
@@ -84,6 +95,10 @@ static Param _param_list[] = {
     { kOptionPrintSuppressUnderbar, PRINT_SUPPRESS_UNDERBAR, false },
     { kOptionBailOnUndefinedFunction, BAIL_ON_UNDEFINED_FUNCTION, false },
     { kOptionSendMIDIRecordAutoStart, SEND_MIDI_RECORD_AUTOSTART, false },
+	{ kOptionThreadAffinity, THREAD_AFFINITY, false },
+	{ kOptionOutputWriteDrop, OUTPUT_WRITE_DROP, false },
+	{ kOptionTableFloat, TABLE_FLOAT, false },
+	{ kOptionDither, DITHER, false },
 
 	// number options
 	{ kOptionBufferFrames, BUFFER_FRAMES, false},
@@ -93,6 +108,13 @@ static Param _param_list[] = {
     { kOptionPrintListLimit, PRINT_LIST_LIMIT, false},
     { kOptionParserWarnings, PARSER_WARNINGS, false},
 	{ kOptionMuteThreshold, MUTE_THRESHOLD, false},
+	{ kOptionThreadCount, THREAD_COUNT, false},
+	{ kOptionThreadPriority, THREAD_PRIORITY, false},
+	{ kOptionInputReadAhead, INPUT_READ_AHEAD, false},
+	{ kOptionOutputWriteQueue, OUTPUT_WRITE_QUEUE, false},
+	{ kOptionTableCache, TABLE_CACHE, false},
+	{ kOptionInputResample, INPUT_RESAMPLE, false},
+	{ kOptionSilenceBlocks, SILENCE_BLOCKS, false},
 
 	// string options
 	{ kOptionDevice, DEVICE, false},
@@ -282,6 +304,27 @@ static int _set_key_value_option(const char *key, const char *sval,
             status = _str_to_bool(sval, bval);
             RTOption::sendMIDIRecordAutoStart(bval);
             break;
+		case THREAD_AFFINITY:
+			status = _str_to_bool(sval, bval);
+			RTOption::threadAffinity(bval);
+#ifndef EMBEDDED
+			if (rtsetparams_called)
+				return die("set_option",
+							"Set \"%s\" BEFORE calling rtsetparams.", key);
+#endif
+			break;
+		case OUTPUT_WRITE_DROP:
+			status = _str_to_bool(sval, bval);
+			RTOption::outputWriteDrop(bval);
+			break;
+		case TABLE_FLOAT:
+			status = _str_to_bool(sval, bval);
+			RTOption::tableFloat(bval);
+			break;
+		case DITHER:
+			status = _str_to_bool(sval, bval);
+			RTOption::dither(bval);
+			break;
 
 		// number options
 
@@ -325,6 +368,72 @@ static int _set_key_value_option(const char *key, const char *sval,
 			status = _str_to_double(sval, dval);
 			RTOption::muteThreshold(dval);
 			break;
+		case THREAD_COUNT:
+			status = _str_to_int(sval, ival);
+			if (status == 0) {
+				if (ival < 0)
+					return die("set_option", "\"%s\" value must be >= 0", key);
+				RTOption::threadCount(ival);
+			}
+#ifndef EMBEDDED
+			if (rtsetparams_called)
+				return die("set_option",
+							"Set \"%s\" BEFORE calling rtsetparams.", key);
+#endif
+			break;
+		case THREAD_PRIORITY:
+			status = _str_to_int(sval, ival);
+			if (status == 0) {
+				if (ival < 0)
+					return die("set_option", "\"%s\" value must be >= 0", key);
+				RTOption::threadPriority(ival);
+			}
+#ifndef EMBEDDED
+			if (rtsetparams_called)
+				return die("set_option",
+							"Set \"%s\" BEFORE calling rtsetparams.", key);
+#endif
+			break;
+		case INPUT_READ_AHEAD:
+			status = _str_to_int(sval, ival);
+			if (status == 0) {
+				if (ival < 0)
+					return die("set_option", "\"%s\" value must be >= 0", key);
+				RTOption::inputReadAhead(ival);
+			}
+			break;
+		case OUTPUT_WRITE_QUEUE:
+			status = _str_to_int(sval, ival);
+			if (status == 0) {
+				if (ival < 0)
+					return die("set_option", "\"%s\" value must be >= 0", key);
+				RTOption::outputWriteQueue(ival);
+			}
+			break;
+		case TABLE_CACHE:
+			status = _str_to_int(sval, ival);
+			if (status == 0) {
+				if (ival < 0)
+					return die("set_option", "\"%s\" value must be >= 0", key);
+				RTOption::tableCache(ival);
+			}
+			break;
+		case INPUT_RESAMPLE:
+			status = _str_to_int(sval, ival);
+			if (status == 0) {
+				if (ival < 0 || ival > 2)
+					return die("set_option", "\"%s\" value must be 0, 1 or 2", key);
+				RTOption::inputResample(ival);
+			}
+			break;
+		case SILENCE_BLOCKS:
+			status = _str_to_int(sval, ival);
+			if (status == 0) {
+				if (ival < 0)
+					return die("set_option", "\"%s\" value must be >= 0", key);
+				RTOption::silenceBlocks(ival);
+			}
+			break;
 
 		// string options
 
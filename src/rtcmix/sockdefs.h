@@ -19,4 +19,36 @@ typedef struct sockdata {
   int n_args;		/* number of p-fields used */
 } RTsockstr;
 
+/* Binary protocol.  A client that starts its connection with the 4 bytes of
+   RTBIN_MAGIC speaks this instead of sending struct sockdata.  After the
+   magic, everything is a message:
+
+      uint32   length of what follows (type byte and body)
+      uint8    message type
+      ...      body
+
+   All integers and doubles are little-endian.  Message bodies:
+
+      RTBIN_DEFINE   uint16 id, then the command name (rest of the message).
+                     Binds <id> to a command for the rest of the connection.
+      RTBIN_NOTES    uint16 count, then <count> events, each
+                        uint16 id, uint16 nargs, nargs x float64 p-fields
+                     Each event is dispatched as if it were a score line;
+                     p0 is its start time, so a batch can carry notes for
+                     many different times.
+      RTBIN_TEXT     uint16 id, uint16 nargs, then nargs x (uint16 length,
+                     bytes):  a command with string arguments, such as
+                     rtinput, load or set_option.
+      RTBIN_SCORE    score text (rest of the message), to be parsed.
+
+   RTcmix_off and RTcmix_panic are sent as ordinary commands.  See the
+   RTbin*() functions in RTsockfuncs.c for a client implementation.
+*/
+#define RTBIN_MAGIC        "RTcB"
+#define RTBIN_DEFINE       1
+#define RTBIN_NOTES        2
+#define RTBIN_TEXT         3
+#define RTBIN_SCORE        4
+#define RTBIN_MAX_MESSAGE  (16 * 1024 * 1024)
+
 #endif
@@ -20,6 +20,8 @@
 #include <PField.h>
 #include <Random.h>
 #include "handle.h"
+#include "TableCache.h"
+#include <RTOption.h>
 #include <ugens.h>		// for warn, die
 #include <maxdispargs.h>
 #include <limits.h>
@@ -1625,6 +1627,58 @@ typedef enum {
 	kInterp2ndOrder
 } InterpType;
 
+// Build the table cache key for a maketable() call from everything that
+// determines the table's contents.  Returns false for tables that must not
+// be shared:  random ones, and ones made from handles or missing files.
+
+static bool
+_table_cache_key(const Arg args[], const int nargs, const int lenindex,
+	const int len, const bool normalize, const InterpType interp,
+	const bool useFloat, TableCache::Key &key)
+{
+	TableKind tablekind;
+	if (args[0].isType(DoubleType))
+		tablekind = (TableKind) (int) args[0];
+	else if (args[0].isType(StringType))
+		tablekind = _string_to_tablekind((const char *) args[0]);
+	else
+		return false;
+	if (tablekind == InvalidTable || tablekind == RandomTable)
+		return false;
+
+	key.add((double) tablekind);
+	key.add(normalize ? 1.0 : 0.0);
+	key.add((double) interp);
+	key.add(useFloat ? 1.0 : 0.0);
+	key.add((double) len);
+
+	bool needFile = (tablekind == TextfileTable || tablekind == SoundFileTable
+										|| tablekind == DatafileTable);
+	for (int i = lenindex + 1; i < nargs; i++) {
+		if (args[i].isType(DoubleType))
+			key.add((double) args[i]);
+		else if (args[i].isType(StringType)) {
+			if (needFile) {
+				if (!key.addFile((const char *) args[i]))
+					return false;
+				needFile = false;
+			}
+			else
+				key.add((const char *) args[i]);
+		}
+		else if (args[i].isType(ArrayType)) {
+			// Flattened by _dispatch_table, so only the elements matter.
+			Array *a = args[i];
+			const int alen = a->len;
+			for (int j = 0; j < alen; j++)
+				key.add(a->data[j]);
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
 Handle
 maketable(const Arg args[], const int nargs)
 {
@@ -1678,6 +1732,21 @@ maketable(const Arg args[], const int nargs)
 		len = MAX_ARRAY_LEN;
 	}
 
+	// Identical tables are shared.  Dynamic ones are rebuilt by each user.
+
+	const bool useFloat = RTOption::tableFloat() && !dynamic;
+	TableCache::Key key("maketable");
+	const bool cacheable = !dynamic && TableCache::enabled()
+		&& _table_cache_key(args, nargs, lenindex, len, normalize, interp, useFloat, key);
+	if (cacheable) {
+		TablePField *table = TableCache::find(key);
+		if (table) {
+			Handle handle = createPFieldHandle(table);
+			table->unref();			// drop the reference find() added
+			return handle;
+		}
+	}
+
 	// Allocate table array.  TablePField will own and delete this.
 	
 	double *data = NULL;
@@ -1729,15 +1798,31 @@ maketable(const Arg args[], const int nargs)
 	if (normalize)
 		_normalize_table(data, len, 1.0);
 
-	TablePField *table;
+	TablePField::InterpFunction ifun;
 	if (interp == kInterp1stOrder)
-		table = new TablePField(data, len);
+		ifun = TablePField::Interpolate1stOrder;
 	else if (interp == kTruncate)
-		table = new TablePField(data, len, TablePField::Truncate);
+		ifun = TablePField::Truncate;
 	else // interp == kInterp2ndOrder
-		table = new TablePField(data, len, TablePField::Interpolate2ndOrder);
+		ifun = TablePField::Interpolate2ndOrder;
 
-	return createPFieldHandle(table);
+	TablePField *table;
+	if (useFloat) {
+		float *fdata = new float[len];
+		for (int i = 0; i < len; i++)
+			fdata[i] = (float) data[i];
+		delete [] data;
+		table = new TablePField(fdata, len, ifun);
+	}
+	else
+		table = new TablePField(data, len, ifun);
+
+	// Make the handle first, so that the table is referenced when the cache
+	// decides what to drop.
+	Handle handle = createPFieldHandle(table);
+	if (cacheable)
+		TableCache::add(key, table);
+	return handle;
 }
 
 
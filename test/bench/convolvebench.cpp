@@ -0,0 +1,206 @@
+// convolvebench.cpp -- single-FFT vs. partitioned convolution for CONVOLVE1.
+//
+// Runs noise through a decaying-noise "reverb" impulse response a buffer at
+// a time, the way CONVOLVE1::run() does, first with the engine CONVOLVE1 used
+// to have (one FFT the size of the whole impulse response, overlap-add,
+// driven by an Obucket) and then with Oconvolve (uniformly partitioned
+// overlap-save).  Reports latency, mean and worst time per buffer, and checks
+// that the two engines produce the same signal once their latencies are
+// lined up.
+//
+// usage: convolvebench [buffer frames [input seconds]]
+
+#include <Ougens.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const float kSR = 44100.0f;
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static float noise(unsigned &seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return ((seed >> 8) & 0xffff) / 32768.0f - 1.0f;
+}
+
+// The old CONVOLVE1 engine:  the input is cut into impulse-length chunks, and
+// each chunk costs one FFT pair of twice the (power-of-two) impulse length.
+
+class SingleFFT {
+public:
+	SingleFFT(const float *impulse, int impframes) : _impframes(impframes), _outIndex(0)
+	{
+		int half = 128;
+		while (half < impframes)
+			half *= 2;
+		_fftlen = half * 2;
+		_fft = new Offt(_fftlen);
+		_fftbuf = _fft->getbuf();
+		for (int i = 0; i < _fftlen; i++)
+			_fftbuf[i] = (i < impframes) ? impulse[i] * _fftlen : 0.0f;
+		_fft->r2c();
+		_imp = new float [_fftlen];
+		memcpy(_imp, _fftbuf, sizeof(float) * _fftlen);
+		_ovadd = new float [impframes];
+		_out = new float [impframes];
+		memset(_ovadd, 0, sizeof(float) * impframes);
+		memset(_out, 0, sizeof(float) * impframes);
+		_bucket = new Obucket(impframes, processWrapper, this);
+	}
+	~SingleFFT()
+	{
+		delete _bucket;
+		delete [] _out;
+		delete [] _ovadd;
+		delete [] _imp;
+		delete _fft;
+	}
+	int latency() const { return _impframes; }
+	float tick(float in)
+	{
+		// Read the slot before the bucket may refill it.
+		const float out = _out[_outIndex];
+		if (++_outIndex == _impframes)
+			_outIndex = 0;
+		_bucket->drop(in);
+		return out;
+	}
+
+private:
+	static void processWrapper(const float buf[], const int len, void *obj)
+	{
+		((SingleFFT *) obj)->process(buf, len);
+	}
+	void process(const float *buf, const int len)
+	{
+		memcpy(_fftbuf, buf, sizeof(float) * len);
+		memset(&_fftbuf[len], 0, sizeof(float) * (_fftlen - len));
+		_fft->r2c();
+		_fftbuf[0] *= _imp[0];
+		_fftbuf[1] *= _imp[1];
+		for (int i = 2; i < _fftlen; i += 2) {
+			const float a = (_fftbuf[i] * _imp[i]) - (_fftbuf[i + 1] * _imp[i + 1]);
+			const float b = (_fftbuf[i] * _imp[i + 1]) + (_fftbuf[i + 1] * _imp[i]);
+			_fftbuf[i] = a;
+			_fftbuf[i + 1] = b;
+		}
+		_fft->c2r();
+		for (int i = 0; i < len; i++) {
+			_out[i] = _ovadd[i] + _fftbuf[i];
+			_ovadd[i] = _fftbuf[len + i];
+		}
+	}
+
+	int _impframes, _fftlen, _outIndex;
+	Offt *_fft;
+	float *_fftbuf, *_imp, *_ovadd, *_out;
+	Obucket *_bucket;
+};
+
+// CONVOLVE1 now:  the block is the buffer size rounded up to a power of two.
+
+class Partitioned {
+public:
+	Partitioned(const float *impulse, int impframes, int bufsamps) : _index(0)
+	{
+		int blocklen = 32;
+		while (blocklen < bufsamps)
+			blocklen *= 2;
+		_conv = new Oconvolve(impulse, impframes, blocklen);
+		_in = new float [blocklen];
+		_out = new float [blocklen];
+		memset(_out, 0, sizeof(float) * blocklen);
+	}
+	~Partitioned() { delete [] _out; delete [] _in; delete _conv; }
+	int latency() const { return _conv->blocklen(); }
+	float tick(float in)
+	{
+		const float out = _out[_index];
+		_in[_index] = in;
+		if (++_index == _conv->blocklen()) {
+			_conv->process(_in, _out);
+			_index = 0;
+		}
+		return out;
+	}
+
+private:
+	Oconvolve *_conv;
+	float *_in, *_out;
+	int _index;
+};
+
+template <class Engine>
+static void run(const char *name, Engine &engine, const float *in, float *out,
+				int frames, int bufsamps)
+{
+	double total = 0.0, worst = 0.0;
+	int buffers = 0;
+	for (int start = 0; start < frames; start += bufsamps, ++buffers) {
+		const int end = (start + bufsamps < frames) ? start + bufsamps : frames;
+		const double t0 = seconds();
+		for (int i = start; i < end; i++)
+			out[i] = engine.tick(in[i]);
+		const double t = seconds() - t0;
+		total += t;
+		if (t > worst)
+			worst = t;
+	}
+	const double budget = bufsamps / kSR;
+	printf("  %-12s latency %6d frames (%6.1f ms)   mean %7.1f us   worst %9.1f us (%5.1f%% of buffer)\n",
+		   name, engine.latency(), engine.latency() * 1000.0 / kSR,
+		   total * 1e6 / buffers, worst * 1e6, worst * 100.0 / budget);
+}
+
+int main(int argc, char **argv)
+{
+	const int bufsamps = argc > 1 ? atoi(argv[1]) : 512;
+	const float inseconds = argc > 2 ? atof(argv[2]) : 20.0f;
+	const int impulseLengths[] = { int(kSR), 262144 };	// 1s, and CONVOLVE1's ~6s limit
+	bool ok = true;
+
+	for (int n = 0; n < 2; n++) {
+		const int impframes = impulseLengths[n];
+		unsigned seed = 1;
+		float *impulse = new float [impframes];
+		for (int i = 0; i < impframes; i++)
+			impulse[i] = noise(seed) * expf(-6.9f * i / impframes) * 0.01f;
+		printf("impulse response %d frames (%.2f s), buffer %d\n", impframes, impframes / kSR, bufsamps);
+
+		SingleFFT single(impulse, impframes);
+		Partitioned partitioned(impulse, impframes, bufsamps);
+		const int frames = int(inseconds * kSR) + single.latency() + impframes;
+		float *in = new float [frames];
+		float *out1 = new float [frames];
+		float *out2 = new float [frames];
+		for (int i = 0; i < frames; i++)
+			in[i] = (i < int(inseconds * kSR)) ? noise(seed) : 0.0f;
+
+		run("single FFT", single, in, out1, frames, bufsamps);
+		run("partitioned", partitioned, in, out2, frames, bufsamps);
+
+		double maxError = 0.0, peak = 0.0;
+		const int d1 = single.latency(), d2 = partitioned.latency();
+		for (int i = 0; i + d1 < frames; i++) {
+			maxError = fmax(maxError, fabs(out1[i + d1] - out2[i + d2]));
+			peak = fmax(peak, fabs(out1[i + d1]));
+		}
+		printf("  max difference %g (peak %g)\n", maxError, peak);
+		if (maxError > peak * 1e-4)
+			ok = false;
+		delete [] out2;
+		delete [] out1;
+		delete [] in;
+		delete [] impulse;
+	}
+	if (!ok)
+		printf("MISMATCH between engines\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// freeverbbench.cpp -- FREEVERB's revmodel, sample at a time vs. block.
+//
+// Runs a number of reverb instances, as on a set of bus effects, over the
+// same stereo noise bursts and the silent tails after them, once through
+// revmodel::processreplace() and once through revmodel::processblock().
+// Reports the time per second of audio for each pass, and the largest
+// difference between the two outputs, which must be within tolerance.
+//
+// usage: freeverbbench [instances [seconds [frames per buffer]]]
+
+#include <revmodel.hpp>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const int kSampleRate = 44100;
+static const float kTolerance = 1e-4f;	// relative to the output peak
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Half a second of noise, then a second and a half of nothing, repeating.
+static void makeInput(float *buf, long frames)
+{
+	unsigned seed = 12345;
+	for (long n = 0; n < frames; ++n) {
+		const bool burst = (n % (2 * kSampleRate)) < kSampleRate / 2;
+		for (int c = 0; c < 2; ++c) {
+			seed = seed * 1664525 + 1013904223;
+			buf[2 * n + c] = burst ? (float) (seed >> 8) / (float) (1 << 24) - 0.5f : 0.0f;
+		}
+	}
+}
+
+static revmodel *makeReverb(int which)
+{
+	revmodel *rvb = new revmodel();
+	rvb->setroomsize(0.5f + 0.05f * (which % 10));
+	rvb->setdamp(0.3f);
+	rvb->setwet(0.3f);
+	rvb->setdry(0.7f);
+	rvb->setwidth(1.0f);
+	rvb->setpredelay(which % 2 ? 441 : 0);
+	return rvb;
+}
+
+static double run(revmodel **reverbs, int instances, bool block, const float *in,
+				  float *out, long frames, int bufframes)
+{
+	const double t0 = seconds();
+	for (long n = 0; n < frames; n += bufframes) {
+		const int count = (frames - n < bufframes) ? (int) (frames - n) : bufframes;
+		for (int i = 0; i < instances; ++i) {
+			float *inbuf = (float *) in + 2 * n;
+			float *outbuf = out + 2 * (i * frames + n);
+			if (block)
+				reverbs[i]->processblock(inbuf, inbuf + 1, outbuf, outbuf + 1, count, 2, 2);
+			else
+				reverbs[i]->processreplace(inbuf, inbuf + 1, outbuf, outbuf + 1, count, 2, 2);
+		}
+	}
+	return seconds() - t0;
+}
+
+int main(int argc, char **argv)
+{
+	const int instances = argc > 1 ? atoi(argv[1]) : 24;
+	const double duration = argc > 2 ? atof(argv[2]) : 4.0;
+	const int bufframes = argc > 3 ? atoi(argv[3]) : 512;
+	const long frames = (long) (duration * kSampleRate);
+
+	float *in = new float[2 * frames];
+	makeInput(in, frames);
+	float *scalarOut = new float[2 * frames * instances];
+	float *blockOut = new float[2 * frames * instances];
+
+	revmodel **scalar = new revmodel *[instances];
+	revmodel **block = new revmodel *[instances];
+	for (int i = 0; i < instances; ++i) {
+		scalar[i] = makeReverb(i);
+		block[i] = makeReverb(i);
+	}
+
+	const double scalarTime = run(scalar, instances, false, in, scalarOut, frames, bufframes);
+	const double blockTime = run(block, instances, true, in, blockOut, frames, bufframes);
+
+	float peak = 0.0f, maxdiff = 0.0f;
+	for (long n = 0; n < 2 * frames * instances; ++n) {
+		peak = fmaxf(peak, fabsf(scalarOut[n]));
+		maxdiff = fmaxf(maxdiff, fabsf(scalarOut[n] - blockOut[n]));
+	}
+
+	printf("%d instances, %.1f seconds, %d frames per buffer\n", instances, duration, bufframes);
+	printf("  %-14s %8.2f ms per second of audio\n", "processreplace", 1000.0 * scalarTime / duration);
+	printf("  %-14s %8.2f ms per second of audio   (%.2fx)\n", "processblock",
+		   1000.0 * blockTime / duration, scalarTime / blockTime);
+	printf("  max difference %.3g (peak %.3g)\n", maxdiff, peak);
+
+	if (maxdiff > kTolerance * peak) {
+		printf("MISMATCH: outputs differ by more than %g of the peak\n", kTolerance);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,68 @@
+// heapbench.cpp -- schedule 1M notes through the scheduler heap.
+//
+// Producer threads insert notes with random start times while the "audio"
+// thread pulls them out a buffer at a time, the way inTraverse() does.
+// Reports insert and deleteMin cost per note and checks the ordering.
+//
+// usage: heapbench [notes [producers]]
+
+#include <heap/heap.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const int kBufSamps = 512;
+static const FRAMETYPE kScoreFrames = 44100LL * 60 * 60;	// an hour of score
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void produce(heap *rtHeap, int first, int count, unsigned seed)
+{
+	for (int n = 0; n < count; ++n) {
+		seed = seed * 1103515245 + 12345;
+		const FRAMETYPE start = (FRAMETYPE) ((seed >> 8) % kScoreFrames);
+		// The instrument pointer is never dereferenced; use it to carry the note number.
+		rtHeap->insert((Instrument *) (size_t) (first + n + 1), start);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const int notes = argc > 1 ? atoi(argv[1]) : 1000000;
+	int producers = argc > 2 ? atoi(argv[2]) : 2;
+	if (producers < 1)
+		producers = 1;
+	heap rtHeap;
+
+	// Schedule the whole score up front, as a non-interactive run does.
+	double start = seconds();
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producers; ++p)
+		threads.push_back(std::thread(produce, &rtHeap, p * (notes / producers), notes / producers, 17 + p));
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+	const double insertTime = seconds() - start;
+	const long scheduled = rtHeap.getSize();
+
+	start = seconds();
+	long popped = 0, disorders = 0;
+	FRAMETYPE last = -1, chunkStart;
+	for (FRAMETYPE bufEnd = kBufSamps; rtHeap.getSize() > 0; bufEnd += kBufSamps) {
+		while (rtHeap.deleteMin(bufEnd, &chunkStart) != NULL) {
+			if (chunkStart < last)
+				++disorders;
+			last = chunkStart;
+			++popped;
+		}
+	}
+	const double popTime = seconds() - start;
+
+	printf("%ld notes from %d threads: insert %.1f ns/note, deleteMin %.1f ns/note (incl. drain), %ld out of order\n",
+		   scheduled, producers, 1e9 * insertTime / scheduled, 1e9 * popTime / popped, disorders);
+	return (popped == scheduled && disorders == 0) ? 0 : 1;
+}
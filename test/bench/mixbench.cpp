@@ -0,0 +1,141 @@
+// mixbench.cpp -- time the bus mixdown done after each scheduler wave.
+//
+// Compares the old path (serial, scalar strided add for every mix) with the
+// new one (SIMD kernels for mono and stereo, mixes partitioned by destination
+// bus across worker threads) at 8, 32 and 128 output channels.  Each output
+// pair gets one stereo instrument and one mono instrument per bus.
+//
+// usage: mixbench [threads [iterations]]
+
+#include <MixKernels.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static const int kFrames = 512;
+
+struct Mix {
+	BufPtr	src;
+	BufPtr	dest;
+	int		frames;
+	int		chans;
+	int		destBus;
+};
+
+// A minimal stand-in for the TaskManager: persistent threads that each take
+// one partition of the mixes when the generation count changes.
+class Mixer {
+public:
+	Mixer(int threads, const std::vector<Mix> &mixes)
+		: mThreadCount(threads), mMixes(mixes), mGeneration(0), mDone(0), mQuit(false) {
+		for (int t = 1; t < mThreadCount; ++t)
+			mThreads.push_back(std::thread(&Mixer::worker, this, t));
+	}
+	~Mixer() {
+		mQuit = true;
+		mGeneration.fetch_add(1);
+		for (size_t t = 0; t < mThreads.size(); ++t)
+			mThreads[t].join();
+	}
+	void run() {
+		mDone.store(0);
+		mGeneration.fetch_add(1, std::memory_order_release);
+		mixPartition(0);
+		while (mDone.load(std::memory_order_acquire) < mThreadCount - 1)
+			std::this_thread::yield();
+	}
+private:
+	void worker(int partition) {
+		unsigned seen = 0;
+		for (;;) {
+			unsigned gen;
+			while ((gen = mGeneration.load(std::memory_order_acquire)) == seen)
+				std::this_thread::yield();
+			seen = gen;
+			if (mQuit)
+				return;
+			mixPartition(partition);
+			mDone.fetch_add(1, std::memory_order_release);
+		}
+	}
+	void mixPartition(int partition) {
+		for (size_t n = 0; n < mMixes.size(); ++n) {
+			const Mix &m = mMixes[n];
+			if (m.destBus % mThreadCount == partition)
+				mixFrames(m.dest, m.src, m.frames, m.chans);
+		}
+	}
+	int							mThreadCount;
+	const std::vector<Mix> &	mMixes;
+	std::vector<std::thread>	mThreads;
+	std::atomic<unsigned>		mGeneration;
+	std::atomic<int>			mDone;
+	volatile bool				mQuit;
+};
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void bench(int buses, int threads, int iterations)
+{
+	std::vector<float> stereo(buses / 2 * kFrames * 2), mono(buses * kFrames);
+	std::vector<float> oldOut(buses * kFrames, 0.0f), newOut(buses * kFrames, 0.0f);
+	for (size_t n = 0; n < stereo.size(); ++n)
+		stereo[n] = sinf(n * 0.01f);
+	for (size_t n = 0; n < mono.size(); ++n)
+		mono[n] = cosf(n * 0.02f);
+
+	std::vector<Mix> oldMixes, newMixes;
+	for (int b = 0; b < buses; ++b) {
+		float *pair = &stereo[(b / 2) * kFrames * 2];
+		Mix s = { pair + (b & 1), &oldOut[b * kFrames], kFrames, 2, b };
+		Mix m = { &mono[b * kFrames], &oldOut[b * kFrames], kFrames, 1, b };
+		oldMixes.push_back(s);
+		oldMixes.push_back(m);
+		s.dest = m.dest = &newOut[b * kFrames];
+		newMixes.push_back(s);
+		newMixes.push_back(m);
+	}
+
+	double start = seconds();
+	for (int i = 0; i < iterations; ++i)
+		for (size_t n = 0; n < oldMixes.size(); ++n)
+			mixStrided(oldMixes[n].dest, oldMixes[n].src, oldMixes[n].frames, oldMixes[n].chans);
+	const double oldTime = seconds() - start;
+
+	double newTime;
+	{
+		Mixer mixer(threads, newMixes);
+		start = seconds();
+		for (int i = 0; i < iterations; ++i)
+			mixer.run();
+		newTime = seconds() - start;
+	}
+
+	float maxDiff = 0.0f;
+	for (size_t n = 0; n < oldOut.size(); ++n)
+		maxDiff = fmaxf(maxDiff, fabsf(oldOut[n] - newOut[n]));
+
+	printf("%4d chans, %3d mixes: old %8.2f us  new %8.2f us  (%.2fx)  max diff %g\n",
+		   buses, (int) oldMixes.size(), 1e6 * oldTime / iterations, 1e6 * newTime / iterations,
+		   oldTime / newTime, maxDiff);
+}
+
+int main(int argc, char **argv)
+{
+	int threads = argc > 1 ? atoi(argv[1]) : (int) std::thread::hardware_concurrency();
+	const int iterations = argc > 2 ? atoi(argv[2]) : 2000;
+	if (threads < 1)
+		threads = 1;
+	printf("%d frames per mix, %d threads, %d iterations\n", kFrames, threads, iterations);
+	const int chans[] = { 8, 32, 128 };
+	for (int n = 0; n < 3; ++n)
+		bench(chans[n], threads, iterations);
+	return 0;
+}
@@ -0,0 +1,77 @@
+// offtbench.cpp -- Offt construction cost and concurrent use of shared plans.
+//
+// Times constructing an Offt the first time a size is seen (which builds the
+// shared plan) and every time after (which only allocates buffers), the way
+// a run of PVOC or SPECTACLE2 notes would.  Then runs forward/inverse round
+// trips on separate Offts of one size from several threads at once and
+// checks that every thread gets its own input back.
+//
+// usage: offtbench [fft size [notes [threads]]]
+
+#include <Ougens.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void roundTrips(int fftsize, int count, unsigned seed, double *maxError)
+{
+	Offt fft(fftsize);
+	float *buf = fft.getbuf();
+	std::vector<float> input(fftsize);
+	*maxError = 0.0;
+	for (int n = 0; n < count; n++) {
+		for (int i = 0; i < fftsize; i++) {
+			seed = seed * 1103515245 + 12345;
+			input[i] = buf[i] = ((seed >> 8) & 0xffff) / 32768.0f - 1.0f;
+		}
+		fft.r2c();
+		fft.c2r();
+		for (int i = 0; i < fftsize; i++)
+			*maxError = fmax(*maxError, fabs(buf[i] - input[i]));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const int fftsize = argc > 1 ? atoi(argv[1]) : 4096;
+	const int notes = argc > 2 ? atoi(argv[2]) : 1000;
+	const int threads = argc > 3 ? atoi(argv[3]) : 4;
+
+	double t0 = seconds();
+	Offt *first = new Offt(fftsize);
+	const double firstTime = seconds() - t0;
+	t0 = seconds();
+	for (int n = 0; n < notes; n++)
+		delete new Offt(fftsize);
+	const double laterTime = (seconds() - t0) / notes;
+	delete first;
+	printf("Offt(%d):  first %8.1f us   after that %8.1f us each\n",
+		   fftsize, firstTime * 1e6, laterTime * 1e6);
+
+	std::vector<std::thread> workers;
+	std::vector<double> errors(threads);
+	t0 = seconds();
+	for (int t = 0; t < threads; t++)
+		workers.push_back(std::thread(roundTrips, fftsize, notes, t + 1, &errors[t]));
+	for (int t = 0; t < threads; t++)
+		workers[t].join();
+	const double elapsed = seconds() - t0;
+	double maxError = 0.0;
+	for (int t = 0; t < threads; t++)
+		maxError = fmax(maxError, errors[t]);
+	printf("%d threads x %d round trips:  %.1f us per round trip, max error %g\n",
+		   threads, notes, elapsed * 1e6 / (threads * notes), maxError);
+	if (maxError > 1e-4) {
+		printf("MISMATCH: round trip did not return the input\n");
+		return 1;
+	}
+	return 0;
+}
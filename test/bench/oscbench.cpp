@@ -0,0 +1,127 @@
+// oscbench.cpp -- Ooscili a sample at a time vs. Ooscili::process() vs. Ooscilbank.
+//
+// Runs a number of partials over a shared wavetable, as MULTIWAVE does,
+// three ways:  calling Ooscili::next() for each partial and sample, calling
+// Ooscili::process() for each partial a block at a time, and running them
+// all in one Ooscilbank.  Reports the time per second of audio for each,
+// and the largest difference between their outputs, which must be within
+// tolerance.  The default table has more samples than the old 16.16 fixed
+// point phase allowed.
+//
+// usage: oscbench [partials [seconds [table length]]]
+
+#include <Ooscili.h>
+#include <Ooscilbank.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Ooscili's table-slot constructor uses these.
+extern "C" {
+double *floc(int) { return NULL; }
+int fsize(int) { return 0; }
+}
+
+static const float kSampleRate = 44100;
+static const int kFrames = 512;
+static const float kTolerance = 1e-5f;	// relative to the output peak
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static float freqFor(int partial) { return 55.0f * (partial + 1) * (1.0f + 0.001f * partial); }
+static float ampFor(int partial) { return 1.0f / (partial + 1); }
+static float panFor(int partial) { return (partial % 7) / 6.0f; }
+
+int main(int argc, char **argv)
+{
+	const int partials = argc > 1 ? atoi(argv[1]) : 64;
+	const double duration = argc > 2 ? atof(argv[2]) : 4.0;
+	const int tablelen = argc > 3 ? atoi(argv[3]) : 65536;
+	const int blocks = (int) (duration * kSampleRate / kFrames);
+
+	double *table = new double[tablelen];
+	for (int i = 0; i < tablelen; i++)
+		table[i] = sin(2.0 * M_PI * i / tablelen) + 0.3 * sin(6.0 * M_PI * i / tablelen);
+
+	Ooscili **single = new Ooscili *[partials];
+	Ooscili **block = new Ooscili *[partials];
+	Ooscilbank bank(kSampleRate, partials, table, tablelen);
+	for (int j = 0; j < partials; j++) {
+		single[j] = new Ooscili(kSampleRate, freqFor(j), table, tablelen);
+		block[j] = new Ooscili(kSampleRate, freqFor(j), table, tablelen);
+		bank.setfreq(j, freqFor(j));
+		bank.setgains(j, ampFor(j) * panFor(j), ampFor(j) * (1.0f - panFor(j)));
+	}
+
+	float *singleOut = new float[2 * kFrames * blocks];
+	float *blockOut = new float[2 * kFrames * blocks];
+	float *bankOut = new float[2 * kFrames * blocks];
+	float sig[kFrames];
+	// Touch the output pages now, so that no pass pays for faulting them in.
+	memset(singleOut, 0, 2 * kFrames * blocks * sizeof(float));
+	memset(blockOut, 0, 2 * kFrames * blocks * sizeof(float));
+	memset(bankOut, 0, 2 * kFrames * blocks * sizeof(float));
+
+	double t0 = seconds();
+	for (int b = 0; b < blocks; b++) {
+		float *out = &singleOut[2 * kFrames * b];
+		for (int n = 0; n < kFrames; n++) {
+			float left = 0.0f, right = 0.0f;
+			for (int j = 0; j < partials; j++) {
+				const float s = single[j]->next() * ampFor(j);
+				left += s * panFor(j);
+				right += s * (1.0f - panFor(j));
+			}
+			out[2 * n] = left;
+			out[2 * n + 1] = right;
+		}
+	}
+	const double singleTime = seconds() - t0;
+
+	t0 = seconds();
+	for (int b = 0; b < blocks; b++) {
+		float *out = &blockOut[2 * kFrames * b];
+		memset(out, 0, 2 * kFrames * sizeof(float));
+		for (int j = 0; j < partials; j++) {
+			block[j]->process(sig, kFrames);
+			const float left = ampFor(j) * panFor(j), right = ampFor(j) * (1.0f - panFor(j));
+			for (int n = 0; n < kFrames; n++) {
+				out[2 * n] += sig[n] * left;
+				out[2 * n + 1] += sig[n] * right;
+			}
+		}
+	}
+	const double blockTime = seconds() - t0;
+
+	t0 = seconds();
+	for (int b = 0; b < blocks; b++)
+		bank.process(&bankOut[2 * kFrames * b], kFrames, 2);
+	const double bankTime = seconds() - t0;
+
+	float peak = 0.0f, blockDiff = 0.0f, bankDiff = 0.0f;
+	for (long n = 0; n < 2L * kFrames * blocks; n++) {
+		peak = fmaxf(peak, fabsf(singleOut[n]));
+		blockDiff = fmaxf(blockDiff, fabsf(singleOut[n] - blockOut[n]));
+		bankDiff = fmaxf(bankDiff, fabsf(singleOut[n] - bankOut[n]));
+	}
+
+	const double scale = 1000.0 / (blocks * kFrames / kSampleRate);
+	printf("%d partials, %.1f seconds, %d-sample table\n", partials, duration, tablelen);
+	printf("  %-18s %8.2f ms per second of audio\n", "Ooscili::next", singleTime * scale);
+	printf("  %-18s %8.2f ms per second of audio   (%.2fx)\n", "Ooscili::process",
+		   blockTime * scale, singleTime / blockTime);
+	printf("  %-18s %8.2f ms per second of audio   (%.2fx)\n", "Ooscilbank",
+		   bankTime * scale, singleTime / bankTime);
+	printf("  max difference %.3g, %.3g (peak %.3g)\n", blockDiff, bankDiff, peak);
+
+	if (blockDiff > kTolerance * peak || bankDiff > kTolerance * peak) {
+		printf("MISMATCH: outputs differ by more than %g of the peak\n", kTolerance);
+		return 1;
+	}
+	return 0;
+}
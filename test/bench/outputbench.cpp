@@ -0,0 +1,291 @@
+// outputbench.cpp -- the playback output stage, two passes vs. one.
+//
+// Runs many channels of full-range float frames, some of them clipping,
+// through a copy of AudioDeviceImpl's limitFrame() followed by the templated
+// convert(), and through outputChannel() from OutputKernels.h, for
+// non-interleaved and interleaved frames and for 16-bit, 24-bit and float
+// device buffers.  Reports the time per second of audio for each, and
+// checks that the two agree on the peaks, their locations and the number of
+// clipped samples, and that the converted samples are within one LSB (the
+// old path truncates where the new one rounds).  A last pass turns on dither
+// to time it.
+//
+// usage: outputbench [channels [frames per buffer [seconds]]]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include "audiostream.h"
+#include "OutputKernels.h"
+
+static const float kSampleRate = 44100;
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The old path, as in AudioDeviceImpl.cpp.
+
+struct OldState {
+	float peaks[256];
+	long peakLocs[256];
+	int numClipped;
+};
+
+static void limitFrame(float **chanPtrs, int incr, int chans, int frames, long start, OldState &st)
+{
+	for (int c = 0; c < chans; ++c) {
+		float *fp = chanPtrs[c];
+		for (int n = 0; n < frames; ++n, fp += incr) {
+			const float samp = *fp;
+			if (samp < -32768.0f) {
+				*fp = -32768.0f;
+				++st.numClipped;
+			}
+			else if (samp > 32767.0f) {
+				*fp = 32767.0f;
+				++st.numClipped;
+			}
+			const double fabsamp = fabs((double) *fp);
+			if (fabsamp > (double) st.peaks[c]) {
+				st.peaks[c] = (float) fabsamp;
+				st.peakLocs[c] = start + n;
+			}
+		}
+	}
+}
+
+template< class InStream, class OutStream >
+static void convert(void *_in, void *_out, int inchans, int outchans, int frames)
+{
+	typedef typename InStream::StreamType InType;
+	typedef typename OutStream::StreamType OutType;
+	InType *in = (InType *)_in;
+	OutType *out = (OutType *)_out;
+	typedef typename InStream::ChannelType InChanType;
+	typedef typename OutStream::ChannelType OutChanType;
+	const int inIncr = InStream::channelIncrement(inchans);
+	const int outIncr = OutStream::channelIncrement(outchans);
+	for (int ch = 0; ch < inchans; ++ch) {
+		InChanType *inbuffer = InStream::innerFromOuter(in, ch);
+		OutChanType *outbuffer = OutStream::innerFromOuter(out, ch);
+		for (int fr = 0; fr < frames; ++fr, inbuffer += inIncr, outbuffer += outIncr) {
+			const OutChanType intermediate =
+				::deNormalize<InChanType, OutChanType>(InStream::normalized,
+						::swap(InStream::endian != kMachineEndian, *inbuffer));
+			*outbuffer = ::swap(OutStream::endian != kMachineEndian,
+								::normalize(OutStream::normalized, intermediate));
+		}
+	}
+}
+
+static void convert24(float **chanPtrs, int incr, unsigned char *out, int chans, int frames)
+{
+	for (int ch = 0; ch < chans; ++ch) {
+		const float *fp = chanPtrs[ch];
+		unsigned char *cout = out + ch * 3;
+		for (int fr = 0; fr < frames; ++fr, fp += incr, cout += chans * 3) {
+			const int samp = (int) (*fp * (1 << 8));
+			cout[2] = (samp >> 16);
+			cout[1] = (samp >> 8);
+			cout[0] = (samp & 0xFF);
+		}
+	}
+}
+
+// A partial per channel, loud enough to clip now and then.
+static void makeFrames(float *buf, int chans, long frames)
+{
+	for (int c = 0; c < chans; ++c)
+		for (long n = 0; n < frames; ++n)
+			buf[c * frames + n] = 34000.0f * sinf(2.0f * (float) M_PI * (110.0f + 7.0f * c) * n / kSampleRate)
+								  * (0.5f + 0.5f * sinf(0.5f * n / kSampleRate + c));
+}
+
+static int deviceSample(const unsigned char *dev, int format, long index)
+{
+	if (format == OutputShort)
+		return (short) (dev[2 * index] | (dev[2 * index + 1] << 8));
+	else if (format == Output24Bit)
+		return ((dev[3 * index] << 8) | (dev[3 * index + 1] << 16) | (dev[3 * index + 2] << 24)) >> 8;
+	float f;
+	memcpy(&f, &dev[4 * index], 4);
+	return (int) lrintf(f * 65536.0f);
+}
+
+static const char *formatName(int format)
+{
+	return format == OutputShort ? "16-bit" : format == Output24Bit ? "24-bit" : "float";
+}
+
+struct Config {
+	int chans, bufframes, format, bytes;
+	bool interleaved, dither;
+};
+
+// <frames> and <dev> hold <total> frames, in buffers of cfg.bufframes.
+
+static void oldPass(const Config &cfg, float *frames, unsigned char *dev, long total,
+					long first, long count, OldState &st)
+{
+	const int chans = cfg.chans;
+	float *ptrs[256];
+	for (long start = first; start < first + count; start += cfg.bufframes) {
+		const int n = (total - start < cfg.bufframes) ? (int) (total - start) : cfg.bufframes;
+		const int incr = cfg.interleaved ? chans : 1;
+		for (int c = 0; c < chans; ++c)
+			ptrs[c] = cfg.interleaved ? &frames[start * chans + c] : &frames[c * total + start];
+		limitFrame(ptrs, incr, chans, n, start, st);
+		void *out = &dev[start * chans * cfg.bytes];
+		if (cfg.format == Output24Bit)
+			convert24(ptrs, incr, (unsigned char *) out, chans, n);
+		else if (cfg.interleaved) {
+			if (cfg.format == OutputShort)
+				convert< InterleavedStream<float, kMachineEndian>, InterleavedStream<short, Little> >(&frames[start * chans], out, chans, chans, n);
+			else
+				convert< InterleavedStream<float, kMachineEndian>, InterleavedStream<float, Little> >(&frames[start * chans], out, chans, chans, n);
+		}
+		else {
+			if (cfg.format == OutputShort)
+				convert< NonInterleavedStream<float, kMachineEndian>, InterleavedStream<short, Little> >(ptrs, out, chans, chans, n);
+			else
+				convert< NonInterleavedStream<float, kMachineEndian>, InterleavedStream<float, Little> >(ptrs, out, chans, chans, n);
+		}
+	}
+}
+
+static void newPass(const Config &cfg, float *frames, unsigned char *dev, long total,
+					long first, long count, float *peaks, long *peakLocs,
+					OutputClipStats &stats, uint32_t ditherState[4])
+{
+	const int chans = cfg.chans;
+	OutputParams params;
+	params.clip = true;
+	params.checkPeaks = true;
+	params.dither = cfg.dither;
+	params.floatScale = 1.0f;
+	for (long start = first; start < first + count; start += cfg.bufframes) {
+		const int n = (total - start < cfg.bufframes) ? (int) (total - start) : cfg.bufframes;
+		const int incr = cfg.interleaved ? chans : 1;
+		params.startFrame = start;
+		unsigned char *out = &dev[start * chans * cfg.bytes];
+		for (int c = 0; c < chans; ++c) {
+			float *fp = cfg.interleaved ? &frames[start * chans + c] : &frames[c * total + start];
+			unsigned char *cp = &out[c * cfg.bytes];
+			if (cfg.format == OutputShort)
+				outputChannel<OutputShort>(fp, incr, cp, chans, n, params, ditherState, &peaks[c], &peakLocs[c], &stats);
+			else if (cfg.format == Output24Bit)
+				outputChannel<Output24Bit>(fp, incr, cp, chans, n, params, ditherState, &peaks[c], &peakLocs[c], &stats);
+			else
+				outputChannel<OutputFloat>(fp, incr, cp, chans, n, params, ditherState, &peaks[c], &peakLocs[c], &stats);
+		}
+	}
+}
+
+// Runs one configuration both ways over all of <source>, comparing the
+// results, then times each over the first few buffers again and again, so
+// that the frames stay in cache as a device's do.  Returns false on mismatch.
+
+static bool run(const float *source, long frames, double duration, const Config &cfg)
+{
+	const int chans = cfg.chans, bytes = cfg.bytes;
+	float *oldFrames = new float[chans * frames];
+	float *newFrames = new float[chans * frames];
+	unsigned char *oldDev = new unsigned char[chans * frames * bytes];
+	unsigned char *newDev = new unsigned char[chans * frames * bytes];
+	memset(oldDev, 0, chans * frames * bytes);
+	memset(newDev, 0, chans * frames * bytes);
+	// Non-interleaved buffers are one per channel; interleaved ones are a
+	// block of <bufframes> frames at a time.
+	for (int c = 0; c < chans; ++c)
+		for (long n = 0; n < frames; ++n) {
+			const long index = cfg.interleaved ? n * chans + c : c * frames + n;
+			oldFrames[index] = newFrames[index] = source[c * frames + n];
+		}
+
+	OldState st;
+	memset(&st, 0, sizeof(st));
+	oldPass(cfg, oldFrames, oldDev, frames, 0, frames, st);
+
+	float peaks[256];
+	long peakLocs[256];
+	memset(peaks, 0, sizeof(peaks));
+	memset(peakLocs, 0, sizeof(peakLocs));
+	OutputClipStats stats = { 0, 0.0f };
+	uint32_t ditherState[4];
+	outputSeedDither(ditherState);
+	newPass(cfg, newFrames, newDev, frames, 0, frames, peaks, peakLocs, stats, ditherState);
+
+	bool ok = (stats.numClipped == st.numClipped);
+	for (int c = 0; c < chans; ++c)
+		ok = ok && peaks[c] == st.peaks[c] && peakLocs[c] == st.peakLocs[c];
+	int maxdiff = 0;
+	for (long n = 0; n < chans * frames; ++n) {
+		const int diff = abs(deviceSample(oldDev, cfg.format, n) - deviceSample(newDev, cfg.format, n));
+		maxdiff = (diff > maxdiff) ? diff : maxdiff;
+		ok = ok && oldFrames[n] == newFrames[n];
+	}
+	if (!cfg.dither)
+		ok = ok && maxdiff <= 1;
+
+	const long ring = 4L * cfg.bufframes;
+	const long reps = (long) (duration * kSampleRate) / ring;
+	double t0 = seconds();
+	for (long r = 0; r < reps; ++r)
+		oldPass(cfg, oldFrames, oldDev, frames, 0, ring, st);
+	const double oldTime = seconds() - t0;
+	t0 = seconds();
+	for (long r = 0; r < reps; ++r)
+		newPass(cfg, newFrames, newDev, frames, 0, ring, peaks, peakLocs, stats, ditherState);
+	const double newTime = seconds() - t0;
+
+	const double scale = 1000.0 / (reps * ring / kSampleRate);
+	printf("  %-15s %-7s %s  %7.3f ms  %7.3f ms   (%.2fx)   max diff %d%s\n",
+		   cfg.interleaved ? "interleaved" : "non-interleaved", formatName(cfg.format),
+		   cfg.dither ? "dither" : "      ", oldTime * scale, newTime * scale, oldTime / newTime,
+		   maxdiff, ok ? "" : "   MISMATCH");
+
+	delete [] newDev;
+	delete [] oldDev;
+	delete [] newFrames;
+	delete [] oldFrames;
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	const int chans = argc > 1 ? atoi(argv[1]) : 64;
+	const int bufframes = argc > 2 ? atoi(argv[2]) : 128;
+	const double duration = argc > 3 ? atof(argv[3]) : 4.0;
+	if (chans < 1 || chans > 256) {
+		fprintf(stderr, "channels must be 1 to 256\n");
+		return 1;
+	}
+
+	// One second of frames to check; the timing loops reuse the start of it.
+	const long frames = (long) kSampleRate;
+	float *source = new float[chans * frames];
+	makeFrames(source, chans, frames);
+
+	printf("%d channels, %d frames per buffer, %.1f seconds\n", chans, bufframes, duration);
+	printf("  %-15s %-7s %6s  %10s  %10s   per second of audio\n", "frames", "device", "", "two-pass", "fused");
+	bool ok = true;
+	const int formats[] = { OutputShort, Output24Bit, OutputFloat };
+	const int bytes[] = { 2, 3, 4 };
+	for (int i = 0; i < 2; ++i)
+		for (int f = 0; f < 3; ++f) {
+			const Config cfg = { chans, bufframes, formats[f], bytes[f], i == 1, false };
+			ok = run(source, frames, duration, cfg) && ok;
+		}
+	const Config dithered = { chans, bufframes, OutputShort, 2, false, true };
+	ok = run(source, frames, duration, dithered) && ok;
+
+	if (!ok) {
+		printf("MISMATCH: the fused stage disagrees with limitFrame() and convert()\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,96 @@
+// pfieldbench.cpp -- per-value doubleValue() vs. block fill() for PFields.
+//
+// Builds the kinds of PField chains a score typically hands an instrument --
+// a table envelope, an envelope times a constant amplitude, and a table
+// scaled into a range by two more tables -- and evaluates each one for a
+// note's worth of frames, first a value at a time the way update() does and
+// then a block at a time the way updateBlock() does.  Checks that the two
+// agree and reports ns per value.
+//
+// usage: pfieldbench [frames [block]]
+
+#include <PField.h>
+#include <ugens.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// PField.cpp reports through these; nothing here should trigger them.
+void rtcmix_debug(const char *, const char *, ...) {}
+void rtcmix_advise(const char *, const char *, ...) {}
+void rtcmix_warn(const char *, const char *, ...) {}
+void rterror(const char *, const char *, ...) {}
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double *makeTable(int len, double phase)
+{
+	double *table = new double[len];
+	for (int n = 0; n < len; ++n)
+		table[n] = 0.5 + 0.5 * sin(phase + 2.0 * M_PI * n / len);
+	return table;
+}
+
+static bool run(const char *name, PField *pf, int frames, int block, double *perValue, double *blocked)
+{
+	const double t0 = seconds();
+	for (int n = 0; n < frames; ++n)
+		perValue[n] = pf->doubleValue((double) n / frames);
+	const double t1 = seconds();
+	for (int n = 0; n < frames; n += block) {
+		const int count = (frames - n < block) ? frames - n : block;
+		pf->fill(&blocked[n], count, (double) n / frames, (double) (n + count) / frames);
+	}
+	const double t2 = seconds();
+
+	double maxError = 0.0;
+	for (int n = 0; n < frames; ++n) {
+		const double error = fabs(perValue[n] - blocked[n]);
+		if (error > maxError)
+			maxError = error;
+	}
+	printf("%-24s doubleValue %6.2f ns   fill %6.2f ns   speedup %5.2fx   max error %g\n",
+		   name, (t1 - t0) * 1e9 / frames, (t2 - t1) * 1e9 / frames,
+		   (t1 - t0) / (t2 - t1), maxError);
+	return maxError < 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+	const int frames = argc > 1 ? atoi(argv[1]) : 44100 * 60;
+	const int block = argc > 2 ? atoi(argv[2]) : 512;
+	const int tableLen = 1000;
+	double *perValue = new double[frames];
+	double *blocked = new double[frames];
+
+	PField *env = new TablePField(makeTable(tableLen, 0.0), tableLen);
+	PField *amp = new MultPField(env, new ConstPField(10000.0));
+	PField *range = new RangePField(new TablePField(makeTable(tableLen, 1.0), tableLen),
+									new TablePField(makeTable(tableLen, 2.0), tableLen),
+									new TablePField(makeTable(tableLen, 3.0), tableLen));
+	PField *chain = new AddPField(new MultPField(amp, range), new ConstPField(1.0));
+	env->ref();
+	amp->ref();
+	range->ref();
+	chain->ref();
+
+	bool ok = true;
+	ok &= run("table", env, frames, block, perValue, blocked);
+	ok &= run("table * const", amp, frames, block, perValue, blocked);
+	ok &= run("range(table, table, table)", range, frames, block, perValue, blocked);
+	ok &= run("(env * range) + const", chain, frames, block, perValue, blocked);
+
+	RefCounted::unref(chain);
+	RefCounted::unref(range);
+	RefCounted::unref(amp);
+	RefCounted::unref(env);
+	delete [] perValue;
+	delete [] blocked;
+	if (!ok)
+		printf("MISMATCH between doubleValue() and fill()\n");
+	return ok ? 0 : 1;
+}
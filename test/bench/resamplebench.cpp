@@ -0,0 +1,208 @@
+// resamplebench.cpp -- InputResampler accuracy, rejection and speed.
+//
+// Feeds an InputResampler from a stand-in InputFile that synthesizes a stereo
+// file of sine tones (the right channel at twice the left's frequency), and
+// reads it back in buffers of varying size, the way rtgetin() does.  For
+// several rate pairs and both filter qualities it reports the gain and phase
+// of each channel against the ideal tone at the output rate, the error
+// relative to that tone, and whether the reader's file offset ended where it
+// should.  It then checks that a tone above the new Nyquist is rejected,
+// that seek() lands on the same samples as reading, and times one stereo
+// reader.  Build resamplebench_scalar too to compare against the plain C
+// inner loops.
+//
+// usage: resamplebench [tone Hz [seconds]]
+
+#include "InputResampler.h"
+#include "InputFile.h"
+#include "RTcmix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+
+static const int kChans = 2;
+static const int kHeaderBytes = 44;
+static const int kSampleBytes = 4;
+
+// Enough of RTcmix and sndlib for InputResampler.cpp.
+
+int RTcmix::sBufferFrameCount = 512;
+extern "C" int mus_data_format_to_bytes_per_sample(int) { return kSampleBytes; }
+
+// The tone being synthesized, at the source rate.
+
+static double sSourceRate, sFreq;
+static long sSourceFrames;
+
+static inline double tone(int chan, double frame, double rate)
+{
+	const double freq = sFreq * (chan + 1);
+	return sin(2.0 * M_PI * freq * frame / rate);
+}
+
+InputFile::InputFile() {}
+InputFile::~InputFile() {}
+
+int InputFile::init(BufPtr, const char *, long, float inSampleRate, int inChannels, float)
+{
+	_srate = inSampleRate;
+	_chans = inChannels;
+	_data_format = 0;
+	_data_location = kHeaderBytes;
+	return 0;
+}
+
+off_t InputFile::readFrames(off_t cur_offset, BufPtr dest, int dest_chans, int dest_frames,
+							const short *, short)
+{
+	const long first = (cur_offset - kHeaderBytes) / (kSampleBytes * _chans);
+	for (int i = 0; i < dest_frames; ++i) {
+		const long frame = first + i;
+		for (int c = 0; c < dest_chans; ++c)
+			dest[i * dest_chans + c] = (frame >= 0 && frame < sSourceFrames)
+									   ? tone(c, frame, sSourceRate) : 0.0;
+	}
+	return (off_t) dest_frames * _chans * kSampleBytes;
+}
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Reads <frames> output frames in buffers of 1 to 512 frames.  Returns the
+// final file offset.
+
+static off_t readAll(InputResampler &resampler, std::vector<float> &out, long frames)
+{
+	out.resize(frames * kChans);
+	off_t offset = kHeaderBytes;
+	int pass = 1;
+	for (long done = 0; done < frames; ) {
+		int count = (pass++ * 37) % 512 + 1;
+		if (count > frames - done)
+			count = (int) (frames - done);
+		offset += resampler.read(offset, &out[done * kChans], kChans, count);
+		done += count;
+	}
+	return offset;
+}
+
+// Gain and phase of channel <chan> at its tone frequency, and the error
+// against the ideal tone, skipping the first 100 ms.
+
+static void analyze(const std::vector<float> &out, long frames, double rate, int chan,
+					double *gainDB, double *phase, double *errorDB)
+{
+	const long start = (long) (rate * 0.1);
+	const double freq = sFreq * (chan + 1);
+	double si = 0.0, co = 0.0, err = 0.0, sig = 0.0;
+	for (long i = start; i < frames; ++i) {
+		const double w = 2.0 * M_PI * freq * i / rate;
+		const double x = out[i * kChans + chan];
+		si += x * sin(w);
+		co += x * cos(w);
+		const double ideal = (freq < rate / 2) ? sin(w) : 0.0;
+		err += (x - ideal) * (x - ideal);
+		sig += ideal * ideal;
+	}
+	const double n = frames - start;
+	*gainDB = 20.0 * log10(2.0 * sqrt(si * si + co * co) / n);
+	*phase = atan2(co, si);
+	*errorDB = 10.0 * log10(err / (sig + 1e-30) + 1e-30);
+}
+
+static double levelDB(const std::vector<float> &out, long frames, double rate)
+{
+	const long start = (long) (rate * 0.1);
+	double sum = 0.0;
+	for (long i = start; i < frames; ++i)
+		sum += out[i * kChans] * out[i * kChans];
+	// Relative to a full-scale sine.
+	return 10.0 * log10(2.0 * sum / (frames - start) + 1e-30);
+}
+
+static void setSource(double rate, double freq, double secs)
+{
+	sSourceRate = rate;
+	sFreq = freq;
+	sSourceFrames = (long) (rate * (secs + 1.0));
+}
+
+int main(int argc, char **argv)
+{
+	const double freq = (argc > 1) ? atof(argv[1]) : 1000.0;
+	const double secs = (argc > 2) ? atof(argv[2]) : 3.0;
+	static const double rates[][2] = {
+		{ 44100, 48000 }, { 48000, 44100 }, { 96000, 44100 }, { 22050, 44100 }, { 44100, 44100.5 }
+	};
+	std::vector<float> out;
+
+	printf("%g Hz and %g Hz tones, %g seconds\n", freq, 2 * freq, secs);
+	for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+		for (int quality = 1; quality <= 2; ++quality) {
+			const double src = rates[r][0], dst = rates[r][1];
+			setSource(src, freq, secs);
+			InputFile file;
+			file.init(NULL, "tone", 0, src, kChans, 1.0);
+			InputResampler resampler(&file, dst, quality);
+			const long frames = (long) (dst * secs);
+			const off_t offset = readAll(resampler, out, frames);
+			printf("  %6g -> %-7g q%d:", src, dst, quality);
+			for (int c = 0; c < kChans; ++c) {
+				double gain, phase, error;
+				analyze(out, frames, dst, c, &gain, &phase, &error);
+				printf("  ch%d %+.4f dB %+.2e rad err %6.1f dB", c, gain, phase, error);
+			}
+			const double ended = (double) (offset - kHeaderBytes) / (kSampleBytes * kChans);
+			printf("  at frame %.0f of %.1f\n", ended, frames * src / dst);
+		}
+	}
+
+	printf("rejection of a 30 kHz tone, 96000 -> 44100:\n");
+	for (int quality = 1; quality <= 2; ++quality) {
+		setSource(96000, 30000, secs);
+		InputFile file;
+		file.init(NULL, "tone", 0, 96000, kChans, 1.0);
+		InputResampler resampler(&file, 44100, quality);
+		const long frames = (long) (44100 * secs);
+		readAll(resampler, out, frames);
+		printf("  q%d: %.1f dB\n", quality, levelDB(out, frames, 44100));
+	}
+
+	setSource(48000, freq, secs);
+	InputFile file;
+	file.init(NULL, "tone", 0, 48000, kChans, 1.0);
+	{
+		InputResampler resampler(&file, 44100, 1);
+		const long frames = (long) (44100 * secs);
+		off_t offset = readAll(resampler, out, frames);
+		double worst = 0.0;
+		for (long target = 1000; target < frames - 1; target += 7919) {
+			offset = resampler.seek(offset, (int) target, SEEK_SET);
+			float frame[kChans];
+			offset += resampler.read(offset, frame, kChans, 1);
+			for (int c = 0; c < kChans; ++c)
+				worst = fmax(worst, fabs(frame[c] - out[target * kChans + c]));
+		}
+		printf("seek then read vs. reading straight through: worst difference %.2e\n", worst);
+	}
+
+	printf("one stereo reader, 512-frame buffers, 48000 -> 44100:\n");
+	for (int quality = 1; quality <= 2; ++quality) {
+		InputResampler resampler(&file, 44100, quality);
+		out.resize(512 * kChans);
+		const long frames = (long) (44100 * secs);
+		off_t offset = kHeaderBytes;
+		const double start = seconds();
+		for (long done = 0; done < frames; done += 512)
+			offset += resampler.read(offset, &out[0], kChans, 512);
+		const double elapsed = seconds() - start;
+		printf("  q%d: %.0f x realtime\n", quality, secs / elapsed);
+	}
+	InputResampler::clearFilters();
+	return 0;
+}
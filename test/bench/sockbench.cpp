@@ -0,0 +1,154 @@
+// sockbench.cpp -- legacy sockdata vs. binary batched notes over the socket.
+//
+// Runs a SocketServer on a thread with a handler that only counts and checks
+// what arrives, and sends it the same notes first one struct sockdata at a
+// time, the way RTsendsock() does, and then in RTbinbatch batches.  Finishes
+// with several binary clients connected at once.  Reports notes per second
+// and bytes per note, and checks that every note arrived intact.
+//
+// usage: sockbench [notes [batch [clients [port offset]]]]
+
+#include <SocketServer.h>
+#include <sockdefs.h>
+#include <ugens.h>
+extern "C" {
+#include <RTsockfuncs.h>
+}
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// SocketServer.cpp reports through these.
+void rtcmix_debug(const char *, const char *, ...) {}
+void rtcmix_warn(const char *, const char *fmt, ...) { printf("warning: %s\n", fmt); }
+
+static const int kArgs = 4;
+static char sHost[] = "localhost";
+
+static double seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class CountingHandler : public SocketServer::Handler {
+public:
+	CountingHandler() : notes(0), errors(0) {}
+	virtual bool command(const char *name, double *p, int n_args)
+	{
+		if (strcmp(name, "RTcmix_off") == 0)
+			return false;
+		// p0 is the time, p1 the note number, p2 and p3 derived from it.
+		if (strcmp(name, "NOTE") != 0 || n_args != kArgs || p[2] != p[1] * 0.5 || p[3] != -p[1])
+			++errors;
+		notes.fetch_add(1, std::memory_order_release);
+		return true;
+	}
+	virtual void score(char *, int) {}
+	std::atomic<long> notes;
+	long errors;
+};
+
+static void fields(double *p, long n)
+{
+	p[0] = n * 0.001;
+	p[1] = (double) n;
+	p[2] = n * 0.5;
+	p[3] = -(double) n;
+}
+
+static void waitFor(CountingHandler &handler, long total)
+{
+	while (handler.notes.load(std::memory_order_acquire) < total)
+		usleep(100);
+}
+
+static void sendLegacy(int sock, long first, long count)
+{
+	double p[kArgs];
+	for (long n = first; n < first + count; ++n) {
+		fields(p, n);
+		RTsendsock("NOTE", sock, kArgs, p[0], p[1], p[2], p[3]);
+	}
+}
+
+static void sendBinary(int sock, long first, long count, int batchSize)
+{
+	RTbinopen(sock);
+	RTbindefine(sock, 1, "NOTE");
+	RTbinbatch *batch = RTnewbinbatch();
+	double p[kArgs];
+	for (long n = first; n < first + count; ++n) {
+		fields(p, n);
+		RTbinbatchadd(batch, 1, kArgs, p);
+		if ((n - first + 1) % batchSize == 0)
+			RTsendbinbatch(sock, batch);
+	}
+	RTsendbinbatch(sock, batch);
+	RTfreebinbatch(batch);
+}
+
+static void report(const char *name, long notes, double elapsed, double bytesPerNote)
+{
+	printf("  %-22s %9.0f notes/s   %7.1f bytes/note\n", name, notes / elapsed, bytesPerNote);
+}
+
+int main(int argc, char **argv)
+{
+	const long notes = argc > 1 ? atol(argv[1]) : 100000;
+	const int batchSize = argc > 2 ? atoi(argv[2]) : 256;
+	const int clients = argc > 3 ? atoi(argv[3]) : 4;
+	const int offset = argc > 4 ? atoi(argv[4]) : 50;
+
+	SocketServer server;
+	if (server.open(MYPORT + offset) < 0)
+		return 1;
+	CountingHandler handler;
+	std::thread serverThread(&SocketServer::serve, &server, std::ref(handler));
+	long expected = 0;
+
+	int sock = RTsock(sHost, offset);
+	double t0 = seconds();
+	sendLegacy(sock, 0, notes);
+	waitFor(handler, expected += notes);
+	report("legacy sockdata", notes, seconds() - t0, sizeof(struct sockdata));
+	close(sock);
+
+	sock = RTsock(sHost, offset);
+	t0 = seconds();
+	sendBinary(sock, 0, notes, batchSize);
+	waitFor(handler, expected += notes);
+	report("binary batches", notes, seconds() - t0, 4.0 + kArgs * 8 + 7.0 / batchSize);
+	close(sock);
+
+	std::vector<std::thread> senders;
+	t0 = seconds();
+	for (int c = 0; c < clients; ++c)
+		senders.push_back(std::thread([=]() {
+			int s = RTsock(sHost, offset);
+			sendBinary(s, c * notes, notes, batchSize);
+			close(s);
+		}));
+	for (int c = 0; c < clients; ++c)
+		senders[c].join();
+	waitFor(handler, expected += clients * notes);
+	char name[64];
+	snprintf(name, sizeof(name), "binary, %d clients", clients);
+	report(name, clients * notes, seconds() - t0, 4.0 + kArgs * 8 + 7.0 / batchSize);
+
+	sock = RTsock(sHost, offset);
+	RTsendsock("RTcmix_off", sock, 0);
+	serverThread.join();
+	close(sock);
+
+	if (handler.errors > 0 || handler.notes.load() != expected) {
+		printf("MISMATCH: %ld of %ld notes arrived, %ld damaged\n",
+			   handler.notes.load(), expected, handler.errors);
+		return 1;
+	}
+	return 0;
+}